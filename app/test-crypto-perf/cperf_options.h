@@ -12,6 +12,7 @@
 #define CPERF_BURST_SIZE	("burst-sz")
 #define CPERF_BUFFER_SIZE	("buffer-sz")
 #define CPERF_SEGMENTS_NB	("segments-nb")
+#define CPERF_REKEY_INTERVAL	("rekey-interval")
 
 #define CPERF_DEVTYPE		("devtype")
 #define CPERF_OPTYPE		("optype")
@@ -60,6 +61,7 @@ struct cperf_options {
 	uint32_t total_ops;
 	uint32_t segments_nb;
 	uint32_t test_buffer_size;
+	uint32_t rekey_interval;
 
 	uint32_t sessionless:1;
 	uint32_t out_of_place:1;
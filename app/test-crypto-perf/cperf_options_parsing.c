@@ -339,6 +339,19 @@ parse_segments_nb(struct cperf_options *opts, const char *arg)
 	return 0;
 }
 
+static int
+parse_rekey_interval(struct cperf_options *opts, const char *arg)
+{
+	int ret = parse_uint32_t(&opts->rekey_interval, arg);
+
+	if (ret) {
+		RTE_LOG(ERR, USER1, "failed to parse rekey interval\n");
+		return -1;
+	}
+
+	return 0;
+}
+
 static int
 parse_device_type(struct cperf_options *opts, const char *arg)
 {
@@ -580,6 +593,7 @@ static struct option lgopts[] = {
 	{ CPERF_BURST_SIZE, required_argument, 0, 0 },
 	{ CPERF_BUFFER_SIZE, required_argument, 0, 0 },
 	{ CPERF_SEGMENTS_NB, required_argument, 0, 0 },
+	{ CPERF_REKEY_INTERVAL, required_argument, 0, 0 },
 
 	{ CPERF_DEVTYPE, required_argument, 0, 0 },
 	{ CPERF_OPTYPE, required_argument, 0, 0 },
@@ -628,6 +642,7 @@ cperf_options_default(struct cperf_options *opts)
 	opts->inc_burst_size = 0;
 
 	opts->segments_nb = 1;
+	opts->rekey_interval = 0;
 
 	strncpy(opts->device_type, "crypto_aesni_mb",
 			sizeof(opts->device_type));
@@ -665,6 +680,7 @@ cperf_opts_parse_long(int opt_idx, struct cperf_options *opts)
 		{ CPERF_BURST_SIZE,	parse_burst_sz },
 		{ CPERF_BUFFER_SIZE,	parse_buffer_sz },
 		{ CPERF_SEGMENTS_NB,	parse_segments_nb },
+		{ CPERF_REKEY_INTERVAL,	parse_rekey_interval },
 		{ CPERF_DEVTYPE,	parse_device_type },
 		{ CPERF_OPTYPE,		parse_op_type },
 		{ CPERF_SESSIONLESS,	parse_sessionless },
@@ -728,6 +744,14 @@ cperf_options_check(struct cperf_options *options)
 		return -EINVAL;
 	}
 
+	if (options->rekey_interval != 0 &&
+			(options->test != CPERF_TEST_TYPE_LATENCY ||
+			options->sessionless)) {
+		RTE_LOG(ERR, USER1, "Rekey interval can be used only with"
+				" the latency test and sessions.\n");
+		return -EINVAL;
+	}
+
 	if (options->test == CPERF_TEST_TYPE_VERIFY &&
 			options->test_file == NULL) {
 		RTE_LOG(ERR, USER1, "Define path to the file with test"
@@ -896,6 +920,8 @@ cperf_options_dump(struct cperf_options *opts)
 		printf("\n");
 	}
 	printf("\n# segments per buffer: %u\n", opts->segments_nb);
+	if (opts->rekey_interval != 0)
+		printf("# rekey interval: %u bursts\n", opts->rekey_interval);
 	printf("#\n");
 	printf("# cryptodev type: %s\n", opts->device_type);
 	printf("#\n");
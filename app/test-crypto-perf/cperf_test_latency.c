@@ -59,6 +59,7 @@ struct cperf_latency_ctx {
 
 	struct rte_cryptodev_sym_session *sess;
 
+	cperf_sessions_create_t sess_create;
 	cperf_populate_ops_t populate_ops;
 
 	const struct cperf_options *options;
@@ -203,6 +204,7 @@ cperf_latency_test_constructor(uint8_t dev_id, uint16_t qp_id,
 	ctx->dev_id = dev_id;
 	ctx->qp_id = qp_id;
 
+	ctx->sess_create = op_fns->sess_create;
 	ctx->populate_ops = op_fns->populate_ops;
 	ctx->options = options;
 	ctx->test_vector = test_vector;
@@ -295,6 +297,39 @@ cperf_latency_test_constructor(uint8_t dev_id, uint16_t qp_id,
 	return NULL;
 }
 
+/*
+ * Dequeue a burst of processed ops, recording their completion time.
+ * Returns the number of dequeued ops.
+ */
+static uint16_t
+cperf_latency_test_flush(struct cperf_latency_ctx *ctx,
+		struct rte_crypto_op **ops_processed, uint16_t burst_size)
+{
+	struct cperf_op_result *pres;
+	uint64_t tsc_end;
+	uint16_t ops_deqd, i;
+
+	/* Sending 0 length burst to flush sw crypto device */
+	rte_cryptodev_enqueue_burst(ctx->dev_id, ctx->qp_id, NULL, 0);
+
+	/* dequeue burst */
+	ops_deqd = rte_cryptodev_dequeue_burst(ctx->dev_id, ctx->qp_id,
+			ops_processed, burst_size);
+
+	tsc_end = rte_rdtsc_precise();
+
+	for (i = 0; i < ops_deqd; i++) {
+		pres = (struct cperf_op_result *)
+				(ops_processed[i]->opaque_data);
+		pres->status = ops_processed[i]->status;
+		pres->tsc_end = tsc_end;
+
+		rte_crypto_op_free(ops_processed[i]);
+	}
+
+	return ops_deqd;
+}
+
 int
 cperf_latency_test_runner(void *arg)
 {
@@ -341,7 +376,7 @@ cperf_latency_test_runner(void *arg)
 
 	while (test_burst_size <= ctx->options->max_burst_size) {
 		uint64_t ops_enqd = 0, ops_deqd = 0;
-		uint64_t m_idx = 0, b_idx = 0;
+		uint64_t m_idx = 0, b_idx = 0, rekeys = 0;
 
 		uint64_t tsc_val, tsc_end, tsc_start;
 		uint64_t tsc_max = 0, tsc_min = ~0UL, tsc_tot = 0, tsc_idx = 0;
@@ -356,6 +391,34 @@ cperf_latency_test_runner(void *arg)
 							ctx->options->total_ops -
 							enqd_tot;
 
+			/*
+			 * Replace the session every rekey interval bursts.
+			 * Session creation itself is not timed, only its
+			 * impact on the following bursts is.
+			 */
+			if (ctx->options->rekey_interval != 0 && b_idx != 0 &&
+					b_idx % ctx->options->rekey_interval == 0) {
+				/* Old session must not be used by any op. */
+				while (deqd_tot < enqd_tot) {
+					ops_deqd = cperf_latency_test_flush(ctx,
+							ops_processed,
+							test_burst_size);
+					if (ops_deqd != 0) {
+						deqd_tot += ops_deqd;
+						deqd_max = max(ops_deqd, deqd_max);
+						deqd_min = min(ops_deqd, deqd_min);
+					}
+				}
+
+				rte_cryptodev_sym_session_free(ctx->dev_id,
+						ctx->sess);
+				ctx->sess = ctx->sess_create(ctx->dev_id,
+						ctx->options, ctx->test_vector);
+				if (ctx->sess == NULL)
+					return -1;
+				rekeys++;
+			}
+
 			/* Allocate crypto ops from pool */
 			if (burst_size != rte_crypto_op_bulk_alloc(
 					ctx->crypto_op_pool,
@@ -435,25 +498,9 @@ cperf_latency_test_runner(void *arg)
 
 		/* Dequeue any operations still in the crypto device */
 		while (deqd_tot < ctx->options->total_ops) {
-			/* Sending 0 length burst to flush sw crypto device */
-			rte_cryptodev_enqueue_burst(ctx->dev_id, ctx->qp_id, NULL, 0);
-
-			/* dequeue burst */
-			ops_deqd = rte_cryptodev_dequeue_burst(ctx->dev_id, ctx->qp_id,
-					ops_processed, test_burst_size);
-
-			tsc_end = rte_rdtsc_precise();
-
+			ops_deqd = cperf_latency_test_flush(ctx, ops_processed,
+					test_burst_size);
 			if (ops_deqd != 0) {
-				for (i = 0; i < ops_deqd; i++) {
-					pres = (struct cperf_op_result *)
-							(ops_processed[i]->opaque_data);
-					pres->status = ops_processed[i]->status;
-					pres->tsc_end = tsc_end;
-
-					rte_crypto_op_free(ops_processed[i]);
-				}
-
 				deqd_tot += ops_deqd;
 				deqd_max = max(ops_deqd, deqd_max);
 				deqd_min = min(ops_deqd, deqd_min);
@@ -506,6 +553,9 @@ cperf_latency_test_runner(void *arg)
 			printf("\n# Burst size: %u", test_burst_size);
 			printf("\n#     Number of bursts: %"PRIu64,
 					b_idx);
+			if (ctx->options->rekey_interval != 0)
+				printf("\n#     Number of rekeys: %"PRIu64,
+						rekeys);
 
 			printf("\n#");
 			printf("\n#          \t       Total\t   Average\t   "
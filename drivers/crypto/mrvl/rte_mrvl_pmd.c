@@ -38,7 +38,9 @@
 #include <rte_cryptodev_pmd.h>
 #include <rte_vdev.h>
 #include <rte_malloc.h>
+#include <rte_memcpy.h>
 #include <rte_cpuflags.h>
+#include <rte_cycles.h>
 
 #include "rte_mrvl_pmd_private.h"
 
@@ -407,6 +409,167 @@ mrvl_crypto_prepare_session_parameters(struct rte_cryptodev *dev,
 	return 0;
 }
 
+/**
+ * Check if cached SAM session matches given session parameters.
+ *
+ * @param sa Pointer to SAM session cache entry.
+ * @param params Pointer to SAM session parameters.
+ * @returns true if SAM session can be shared, false otherwise.
+ */
+static bool
+mrvl_crypto_sa_match(const struct mrvl_crypto_sa *sa,
+		const struct sam_session_params *params)
+{
+	const struct sam_session_params *cached = &sa->params;
+
+	if (cached->dir != params->dir ||
+	    cached->cipher_alg != params->cipher_alg ||
+	    cached->cipher_mode != params->cipher_mode ||
+	    cached->cipher_key_len != params->cipher_key_len ||
+	    cached->auth_alg != params->auth_alg ||
+	    cached->auth_key_len != params->auth_key_len ||
+	    cached->u.basic.auth_icv_len != params->u.basic.auth_icv_len ||
+	    cached->u.basic.auth_aad_len != params->u.basic.auth_aad_len)
+		return false;
+
+	if (params->cipher_key_len &&
+	    memcmp(sa->cipher_key, params->cipher_key, params->cipher_key_len))
+		return false;
+
+	if (params->auth_key_len &&
+	    memcmp(sa->auth_key, params->auth_key, params->auth_key_len))
+		return false;
+
+	return true;
+}
+
+/**
+ * Create SAM session for the crypto session.
+ *
+ * Called from the control path when the session is configured, so the
+ * data path never has to wait for the (slow) SAM session creation.
+ * If the device already has a SAM session with identical parameters,
+ * it is shared instead of creating a new one.
+ *
+ * @param dev Pointer to crypto device.
+ * @param sess Pointer to configured crypto session.
+ * @returns 0 in case of success, negative value otherwise.
+ */
+int
+mrvl_crypto_session_start(struct rte_cryptodev *dev,
+		struct mrvl_crypto_session *sess)
+{
+	struct mrvl_crypto_private *internals = dev->data->dev_private;
+	struct sam_session_params *params = &sess->sam_sess_params;
+	struct mrvl_crypto_sa *sa, *free_sa = NULL;
+	unsigned int i;
+	int ret = 0;
+
+	if (sess->state != MRVL_SESSION_CONFIGURED)
+		return -EINVAL;
+
+	rte_spinlock_lock(&internals->sa_cache_lock);
+
+	for (i = 0; i < internals->max_nb_sessions; i++) {
+		sa = &internals->sa_cache[i];
+
+		if (sa->refcnt == 0) {
+			if (free_sa == NULL)
+				free_sa = sa;
+			continue;
+		}
+
+		if (mrvl_crypto_sa_match(sa, params)) {
+			internals->sess_shared++;
+			sa->refcnt++;
+			sess->sa = sa;
+			sess->sam_sess = sa->sam_sess;
+			goto out;
+		}
+	}
+
+	if (free_sa == NULL ||
+	    params->cipher_key_len > sizeof(free_sa->cipher_key) ||
+	    params->auth_key_len > sizeof(free_sa->auth_key)) {
+		/* Cannot be cached, use private SAM session. */
+		if (sam_session_create(params, &sess->sam_sess))
+			ret = -EIO;
+		goto out;
+	}
+
+	/* Keep copies of the keys, application may free the xform. */
+	free_sa->params = *params;
+	if (params->cipher_key_len) {
+		memcpy(free_sa->cipher_key, params->cipher_key,
+		       params->cipher_key_len);
+		free_sa->params.cipher_key = free_sa->cipher_key;
+	}
+	if (params->auth_key_len) {
+		memcpy(free_sa->auth_key, params->auth_key,
+		       params->auth_key_len);
+		free_sa->params.auth_key = free_sa->auth_key;
+	}
+
+	if (sam_session_create(&free_sa->params, &free_sa->sam_sess)) {
+		memset(free_sa, 0, sizeof(*free_sa));
+		ret = -EIO;
+		goto out;
+	}
+
+	free_sa->refcnt = 1;
+	sess->sa = free_sa;
+	sess->sam_sess = free_sa->sam_sess;
+out:
+	if (ret == 0)
+		internals->sess_started++;
+
+	rte_spinlock_unlock(&internals->sa_cache_lock);
+
+	if (ret == 0)
+		sess->state = MRVL_SESSION_STARTED;
+
+	return ret;
+}
+
+/**
+ * Release SAM session of the crypto session.
+ *
+ * Shared SAM session is destroyed when its last user is gone.
+ *
+ * @param dev Pointer to crypto device.
+ * @param sess Pointer to crypto session.
+ */
+void
+mrvl_crypto_session_stop(struct rte_cryptodev *dev,
+		struct mrvl_crypto_session *sess)
+{
+	struct mrvl_crypto_private *internals = dev->data->dev_private;
+	struct mrvl_crypto_sa *sa = sess->sa;
+
+	if (sess->state != MRVL_SESSION_STARTED)
+		return;
+
+	rte_spinlock_lock(&internals->sa_cache_lock);
+
+	if (sa == NULL) {
+		if (sam_session_destroy(sess->sam_sess) < 0) {
+			MRVL_CRYPTO_LOG_INFO("Error while destroying session!");
+		}
+	} else if (--sa->refcnt == 0) {
+		if (sam_session_destroy(sa->sam_sess) < 0) {
+			MRVL_CRYPTO_LOG_INFO("Error while destroying session!");
+		}
+		/* Zero out the entry so it doesn't leave key material behind. */
+		memset(sa, 0, sizeof(*sa));
+	}
+
+	rte_spinlock_unlock(&internals->sa_cache_lock);
+
+	sess->sa = NULL;
+	sess->sam_sess = NULL;
+	sess->state = MRVL_SESSION_CONFIGURED;
+}
+
 /*
  *-----------------------------------------------------------------------------
  * Process Operations
@@ -416,8 +579,8 @@ mrvl_crypto_prepare_session_parameters(struct rte_cryptodev *dev,
 /**
  * Make sure the session is started.
  *
- * The function makes sure the session state is correct and session itself
- * is started. If session is not started yet, it tries to start it.
+ * SAM sessions are created when crypto sessions are configured, so here
+ * the session state is only verified.
  * @param op Pointer to DPDK crypto operation struct.
  * @returns 0 in case of success, negative value otherwise.
  */
@@ -427,19 +590,7 @@ mrvl_make_sure_session_started(struct rte_crypto_op *op)
 	struct mrvl_crypto_session *session =
 		(struct mrvl_crypto_session *)op->sym->session->_private;
 
-	if (session->state == MRVL_SESSION_CONFIGURED) {
-		/* Need to start session first */
-		if (sam_session_create(&session->sam_sess_params,
-				&session->sam_sess)) {
-			/*
-			 * We're using Dbg here to make sure
-			 * the function is inlined.
-			 */
-			MRVL_CRYPTO_LOG_DBG("Failed to start session!");
-			return -EIO;
-		}
-		session->state = MRVL_SESSION_STARTED;
-	} else if (session->state != MRVL_SESSION_STARTED) {
+	if (unlikely(session->state != MRVL_SESSION_STARTED)) {
 		MRVL_CRYPTO_LOG_DBG(
 			"Invalid session state (%d)!", session->state);
 		return -EINVAL;
@@ -447,71 +598,292 @@ mrvl_make_sure_session_started(struct rte_crypto_op *op)
 	return 0;
 }
 
+/**
+ * Get pointer to data at given offset in (possibly segmented) mbuf.
+ *
+ * @param m Pointer to the first mbuf segment.
+ * @param offset Offset of the data from the beginning of packet data.
+ * @returns Pointer to the data or NULL if offset is beyond mbuf data.
+ */
+static inline uint8_t *
+mrvl_mbuf_offset_ptr(struct rte_mbuf *m, uint32_t offset)
+{
+	while (m != NULL && offset >= rte_pktmbuf_data_len(m)) {
+		/* The very end of the last segment is still a valid place. */
+		if (m->next == NULL && offset == rte_pktmbuf_data_len(m))
+			break;
+		offset -= rte_pktmbuf_data_len(m);
+		m = m->next;
+	}
+
+	if (m == NULL)
+		return NULL;
+
+	return rte_pktmbuf_mtod_offset(m, uint8_t *, offset);
+}
+
+/**
+ * Copy data between (possibly segmented) mbuf and flat buffer.
+ *
+ * Tailroom of the last segment can be accessed as well.
+ *
+ * @param m Pointer to the first mbuf segment.
+ * @param offset Offset of the data from the beginning of packet data.
+ * @param buf Pointer to the flat buffer.
+ * @param len Number of bytes to copy.
+ * @param to_mbuf Copy direction, true means buf -> mbuf.
+ * @returns 0 in case of success, negative value otherwise.
+ */
+static inline int
+mrvl_mbuf_copy(struct rte_mbuf *m, uint32_t offset, uint8_t *buf,
+		uint32_t len, bool to_mbuf)
+{
+	uint32_t room, chunk;
+	uint8_t *data;
+
+	while (m->next != NULL && offset >= rte_pktmbuf_data_len(m)) {
+		offset -= rte_pktmbuf_data_len(m);
+		m = m->next;
+	}
+
+	while (len > 0) {
+		if (m == NULL)
+			return -1;
+
+		room = m->next != NULL ? rte_pktmbuf_data_len(m) :
+			m->buf_len - rte_pktmbuf_headroom(m);
+		if (offset >= room)
+			return -1;
+
+		chunk = RTE_MIN(len, room - offset);
+		data = rte_pktmbuf_mtod_offset(m, uint8_t *, offset);
+		if (to_mbuf)
+			rte_memcpy(data, buf, chunk);
+		else
+			rte_memcpy(buf, data, chunk);
+
+		buf += chunk;
+		len -= chunk;
+		offset = 0;
+		m = m->next;
+	}
+
+	return 0;
+}
+
+/**
+ * Finish the op with staged ICV and release its ICV slot data.
+ *
+ * For encryption, the ICV generated by EIP is copied to its final place.
+ * In both directions data overwritten by the ICV is restored. Digest buffer
+ * may overlap ICV location, so the ICV is written only after the restore.
+ *
+ * @param icv Pointer to ICV staging slot.
+ * @param processed Whether the op has been processed by EIP.
+ * @returns Pointer to the crypto op using the slot.
+ */
+static inline struct rte_crypto_op *
+mrvl_crypto_icv_unstage(struct mrvl_crypto_icv *icv, bool processed)
+{
+	struct rte_crypto_op *op = icv->op;
+	struct mrvl_crypto_session *session =
+		(struct mrvl_crypto_session *) op->sym->session->_private;
+	uint32_t auth_data_len =
+		op->sym->auth.data.length + op->sym->auth.data.offset;
+	uint32_t icv_len = session->sam_sess_params.u.basic.auth_icv_len;
+	uint8_t digest[ICV_MAX];
+	struct rte_mbuf *m;
+
+	if (session->sam_sess_params.dir == SAM_DIR_ENCRYPT) {
+		/* Nothing has been touched yet. */
+		if (!processed)
+			return op;
+
+		m = op->sym->m_dst ? op->sym->m_dst : op->sym->m_src;
+		mrvl_mbuf_copy(m, auth_data_len, digest, icv_len, false);
+		mrvl_mbuf_copy(m, auth_data_len, icv->data, icv_len, true);
+		rte_memcpy(op->sym->auth.digest.data, digest, icv_len);
+	} else {
+		m = op->sym->m_src;
+		mrvl_mbuf_copy(m, auth_data_len, icv->data, icv_len, true);
+	}
+
+	return op;
+}
+
+/**
+ * Stage the ICV of the op in the place EIP expects it.
+ *
+ * Data at auth offset + length is saved in the ICV slot. For decryption
+ * the digest is copied there, for encryption EIP will write it there.
+ * Digest buffer may overlap that place, hence it is copied via a bounce
+ * buffer.
+ *
+ * @param qp Pointer to queue pair.
+ * @param request Pointer to prepared request.
+ * @param src_bd Pointer to source descriptors of the request.
+ * @param op Pointer to DPDK crypto operation struct.
+ * @returns 0 in case of success, -ENOSPC if there is no free ICV slot,
+ *   -1 on any other error.
+ */
+static inline int
+mrvl_crypto_icv_stage(struct mrvl_crypto_qp *qp,
+		struct sam_cio_op_params *request,
+		struct sam_buf_info *src_bd,
+		struct rte_crypto_op *op)
+{
+	struct mrvl_crypto_session *session =
+		(struct mrvl_crypto_session *) op->sym->session->_private;
+	uint32_t auth_data_len =
+		op->sym->auth.data.length + op->sym->auth.data.offset;
+	uint32_t icv_len = session->sam_sess_params.u.basic.auth_icv_len;
+	uint8_t digest[ICV_MAX];
+	struct rte_mbuf *m;
+	struct mrvl_crypto_icv *icv;
+
+	if (icv_len > ICV_MAX) {
+		MRVL_CRYPTO_LOG_ERR("ICV too long to be staged!");
+		return -1;
+	}
+
+	if (qp->icv_head - qp->icv_tail == qp->nb_desc)
+		return -ENOSPC;
+
+	icv = &qp->icv[qp->icv_head % qp->nb_desc];
+
+	if (session->sam_sess_params.dir == SAM_DIR_ENCRYPT) {
+		m = op->sym->m_dst ? op->sym->m_dst : op->sym->m_src;
+		if (mrvl_mbuf_copy(m, auth_data_len, icv->data,
+				   icv_len, false) < 0)
+			goto no_room;
+	} else {
+		m = op->sym->m_src;
+		rte_memcpy(digest, op->sym->auth.digest.data, icv_len);
+		if ((mrvl_mbuf_copy(m, auth_data_len, icv->data,
+				    icv_len, false) < 0) ||
+		    (mrvl_mbuf_copy(m, auth_data_len, digest,
+				    icv_len, true) < 0))
+			goto no_room;
+
+		/* ICV may land in the tailroom of the last segment. */
+		if (auth_data_len + icv_len > rte_pktmbuf_pkt_len(m))
+			src_bd[m->nb_segs - 1].len += auth_data_len + icv_len -
+				rte_pktmbuf_pkt_len(m);
+	}
+
+	icv->op = op;
+	qp->icv_head++;
+	request->cookie = (void *)((uintptr_t)icv | MRVL_CRYPTO_COOKIE_ICV);
+
+	return 0;
+
+no_room:
+	MRVL_CRYPTO_LOG_ERR("No room for ICV at auth offset + length!");
+	return -1;
+}
+
 /**
  * Prepare a single request.
  *
  * This function basically translates DPDK crypto request into one
- * understandable by MUDSK's SAM. If this is a first request in a session,
- * it starts the session.
+ * understandable by MUDSK's SAM.
  *
+ * Every mbuf segment is described by a separate buffer descriptor, taken
+ * from the pre-allocated pools passed in src_bd and dst_bd.
+ *
+ * @param qp Pointer to queue pair.
  * @param request Pointer to pre-allocated && reset request buffer [Out].
- * @param src_bd Pointer to pre-allocated source descriptor [Out].
- * @param dst_bd Pointer to pre-allocated destination descriptor [Out].
+ * @param src_bd Pointer to pre-allocated source descriptors [Out].
+ * @param dst_bd Pointer to pre-allocated destination descriptors [Out].
+ * @param nb_bd Number of descriptors available in src_bd and dst_bd.
  * @param op Pointer to DPDK crypto operation struct [In].
+ * @returns Number of descriptors used, -ENOSPC if there are not enough
+ *   descriptors or ICV slots available, -1 on any other error.
  */
 static inline int
-mrvl_request_prepare(struct sam_cio_op_params *request,
+mrvl_request_prepare(struct mrvl_crypto_qp *qp,
+		struct sam_cio_op_params *request,
 		struct sam_buf_info *src_bd,
 		struct sam_buf_info *dst_bd,
+		uint16_t nb_bd,
 		struct rte_crypto_op *op)
 {
 	struct mrvl_crypto_session *session =
 		(struct mrvl_crypto_session *) op->sym->session->_private;
 	int auth_data_len;
+	struct rte_mbuf *src_mbuf = op->sym->m_src;
 	struct rte_mbuf *dst_mbuf;
+	struct rte_mbuf *seg;
+	uint8_t *digest;
+	uint16_t nb_segs = src_mbuf->nb_segs;
+	uint16_t i;
+	int ret;
 
 	/*
 	 * If application delivered us null dst buffer, it means it expects
 	 * us to deliver the result in src buffer.
 	 */
-	dst_mbuf = op->sym->m_dst ? op->sym->m_dst : op->sym->m_src;
+	dst_mbuf = op->sym->m_dst ? op->sym->m_dst : src_mbuf;
 
-	request->sa = session->sam_sess;
-	request->cookie = op;
+	if (nb_segs > MRVL_CRYPTO_MAX_SEGS) {
+		MRVL_CRYPTO_LOG_ERR("Too many segments (%u)!", nb_segs);
+		return -1;
+	}
 
-	/* Single buffers only, sorry. */
-	request->num_bufs = 1;
-	request->src = src_bd;
-	src_bd->vaddr = rte_pktmbuf_mtod(op->sym->m_src, void *);
-	src_bd->paddr = rte_pktmbuf_mtophys(op->sym->m_src);
-	src_bd->len = rte_pktmbuf_data_len(op->sym->m_src);
+	if (nb_segs > nb_bd)
+		return -ENOSPC;
 
 	/* Empty source. */
-	if (rte_pktmbuf_data_len(op->sym->m_src) == 0) {
+	if (rte_pktmbuf_pkt_len(src_mbuf) == 0) {
 		/* EIP does not support 0 length buffers. */
 		MRVL_CRYPTO_LOG_ERR("Buffer length == 0 not supported!");
 		return -1;
 	}
 
 	/* Empty destination. */
-	if (rte_pktmbuf_data_len(dst_mbuf) == 0) {
+	if (rte_pktmbuf_pkt_len(dst_mbuf) == 0) {
 		/* Make dst buffer fit at least source data. */
 		if (rte_pktmbuf_append(dst_mbuf,
-			rte_pktmbuf_data_len(op->sym->m_src)) == NULL) {
+			rte_pktmbuf_pkt_len(src_mbuf)) == NULL) {
 			MRVL_CRYPTO_LOG_ERR("Unable to set big enough dst buffer!");
 			return -1;
 		}
 	}
 
+	/* SAM uses a single number of buffers for both directions. */
+	if (dst_mbuf->nb_segs != nb_segs) {
+		MRVL_CRYPTO_LOG_ERR("Src and dst segment counts differ!");
+		return -1;
+	}
+
+	request->sa = session->sam_sess;
+	request->cookie = op;
+	request->num_bufs = nb_segs;
+
+	request->src = src_bd;
+	for (i = 0, seg = src_mbuf; i < nb_segs; ++i, seg = seg->next) {
+		if (rte_pktmbuf_data_len(seg) == 0) {
+			MRVL_CRYPTO_LOG_ERR("Segment length == 0 not supported!");
+			return -1;
+		}
+		src_bd[i].vaddr = rte_pktmbuf_mtod(seg, void *);
+		src_bd[i].paddr = rte_pktmbuf_mtophys(seg);
+		src_bd[i].len = rte_pktmbuf_data_len(seg);
+	}
+
 	request->dst = dst_bd;
-	dst_bd->vaddr = rte_pktmbuf_mtod(dst_mbuf, void *);
-	dst_bd->paddr = rte_pktmbuf_mtophys(dst_mbuf);
+	for (i = 0, seg = dst_mbuf; i < nb_segs; ++i, seg = seg->next) {
+		dst_bd[i].vaddr = rte_pktmbuf_mtod(seg, void *);
+		dst_bd[i].paddr = rte_pktmbuf_mtophys(seg);
+		dst_bd[i].len = rte_pktmbuf_data_len(seg);
+	}
 
 	/*
-	 * We can use all available space in dst_mbuf,
+	 * We can use all available space in the last dst segment,
 	 * not only what's used currently.
 	 */
-	dst_bd->len = dst_mbuf->buf_len - rte_pktmbuf_headroom(dst_mbuf);
+	seg = rte_pktmbuf_lastseg(dst_mbuf);
+	dst_bd[nb_segs - 1].len = seg->buf_len - rte_pktmbuf_headroom(seg);
 
 	request->cipher_len = op->sym->cipher.data.length;
 	request->cipher_offset = op->sym->cipher.data.offset;
@@ -525,7 +897,7 @@ mrvl_request_prepare(struct sam_cio_op_params *request,
 
 	if (op->sym->auth.digest.data == NULL) {
 		/* No auth - no worry. */
-		return 0;
+		return nb_segs;
 	}
 
 	auth_data_len = op->sym->auth.data.length + op->sym->auth.data.offset;
@@ -533,35 +905,34 @@ mrvl_request_prepare(struct sam_cio_op_params *request,
 	/*
 	 * EIP supports only scenarios where ICV(digest buffer) is placed at
 	 * auth.data.offset + auth.data.length.
-	 * Any other placement means risking errors.
 	 */
 	if (session->sam_sess_params.dir == SAM_DIR_ENCRYPT) {
 		/*
 		 * This should be the most common case anyway,
 		 * EIP will overwrite DST buffer at auth_data_len offset.
 		 */
-		if (rte_pktmbuf_mtod_offset(
-				dst_mbuf, uint8_t *, auth_data_len) ==
-			op->sym->auth.digest.data) {
-			return 0;
-		}
+		digest = mrvl_mbuf_offset_ptr(dst_mbuf, auth_data_len);
 	} else {/* session->sam_sess_params.dir == SAM_DIR_DECRYPT */
 		/*
 		 * EIP will look for digest at auth_data_len offset in SRC buffer.
 		 */
-		if (rte_pktmbuf_mtod_offset(
-				op->sym->m_src, uint8_t *, auth_data_len) ==
-			op->sym->auth.digest.data) {
-			return 0;
-		}
+		digest = mrvl_mbuf_offset_ptr(src_mbuf, auth_data_len);
 	}
 
+	if (digest == op->sym->auth.digest.data)
+		return nb_segs;
+
 	/*
 	 * If we landed here it means that digest pointer is
-	 * at different than expected place.
+	 * at different than expected place, so it has to be staged.
 	 */
-	return -1;
+	ret = mrvl_crypto_icv_stage(qp, request, src_bd, op);
+	if (ret < 0)
+		return ret;
+
+	return nb_segs;
 }
+
 /*
  *-----------------------------------------------------------------------------
  * PMD Framework handlers
@@ -582,33 +953,49 @@ mrvl_crypto_pmd_enqueue_burst(void *queue_pair,
 		uint16_t nb_ops)
 {
 	uint16_t iter_ops = 0;
-	uint16_t to_enq = nb_ops;
+	uint16_t to_enq;
 	uint16_t consumed = 0;
 	uint16_t iter_req = 0;
+	uint16_t bd_used = 0;
+	uint16_t prepared;
+	uintptr_t cookie;
+	uint64_t tsc;
 	int ret;
-	struct sam_cio_op_params requests[nb_ops];
-	/*
-	 * DPDK uses single fragment buffers, so we can KISS descriptors.
-	 * SAM does not store bd pointers, so on-stack scope will be enough.
-	 */
-	struct sam_buf_info src_bd[nb_ops];
-	struct sam_buf_info dst_bd[nb_ops];
 	struct mrvl_crypto_qp *qp = (struct mrvl_crypto_qp *) queue_pair;
+	struct sam_cio_op_params *requests = qp->requests;
 
 	if (nb_ops == 0)
 		return 0;
 
+	/* Requests and descriptors are limited by the qp pools. */
+	if (nb_ops > MRVL_CRYPTO_MAX_BURST_SIZE)
+		nb_ops = MRVL_CRYPTO_MAX_BURST_SIZE;
+	to_enq = nb_ops;
+
 	/* Prepare the burst. */
-	memset(&requests, 0, sizeof(requests));
+	memset(requests, 0, sizeof(*requests) * nb_ops);
 
 	/* Iterate through */
 	for (; iter_ops < nb_ops; ++iter_ops, ++iter_req) {
-		if ((mrvl_make_sure_session_started(ops[iter_ops]) < 0) ||
-			(mrvl_request_prepare(
-				&requests[iter_req],
-				&src_bd[iter_req],
-				&dst_bd[iter_req],
-				ops[iter_ops]) < 0)) {
+		ret = mrvl_make_sure_session_started(ops[iter_ops]);
+		if (ret == 0)
+			ret = mrvl_request_prepare(qp, &requests[iter_req],
+				&qp->src_bd[bd_used],
+				&qp->dst_bd[bd_used],
+				MRVL_CRYPTO_BD_POOL_SIZE - bd_used,
+				ops[iter_ops]);
+
+		if (ret == -ENOSPC) {
+			/*
+			 * Out of descriptors - leave this and the following
+			 * ops for the next enqueue call.
+			 */
+			to_enq -= nb_ops - iter_ops;
+			nb_ops = iter_ops;
+			break;
+		}
+
+		if (ret < 0) {
 			MRVL_CRYPTO_LOG_ERR(
 				"Error while parameters preparation!");
 			qp->stats.enqueue_err_count++;
@@ -625,12 +1012,15 @@ mrvl_crypto_pmd_enqueue_burst(void *queue_pair,
 			 */
 			++consumed;
 		} else {
+			bd_used += ret;
 			/* Assume enqueue will succeed. */
 			ops[iter_ops]->status = RTE_CRYPTO_OP_STATUS_ENQUEUED;
 		}
 	} /* for (; iter_ops < nb_ops;... */
 
 	if (to_enq > 0) {
+		prepared = to_enq;
+
 		/* Send the burst */
 		ret = sam_cio_enq(qp->cio, requests, &to_enq);
 		consumed += to_enq;
@@ -642,6 +1032,25 @@ mrvl_crypto_pmd_enqueue_burst(void *queue_pair,
 			qp->stats.enqueue_err_count += to_enq;
 			for (iter_ops = 0; iter_ops < to_enq; ++iter_ops)
 				ops[iter_ops]->status = RTE_CRYPTO_OP_STATUS_ERROR;
+			to_enq = 0;
+		}
+
+		/* Stamp enqueued requests for latency histogram. */
+		if (to_enq > 0) {
+			tsc = rte_rdtsc();
+			for (iter_req = 0; iter_req < to_enq; ++iter_req)
+				qp->enq_tsc[qp->enq_tsc_head++ % qp->nb_desc] =
+					tsc;
+		}
+
+		/* Unstage ICVs of requests that have not been enqueued. */
+		for (iter_req = prepared; iter_req > to_enq; --iter_req) {
+			cookie = (uintptr_t)requests[iter_req - 1].cookie;
+			if (cookie & MRVL_CRYPTO_COOKIE_ICV) {
+				mrvl_crypto_icv_unstage((struct mrvl_crypto_icv *)
+					(cookie & ~MRVL_CRYPTO_COOKIE_ICV), false);
+				qp->icv_head--;
+			}
 		}
 	}
 
@@ -680,6 +1089,9 @@ mrvl_crypto_pmd_dequeue_burst(void *queue_pair,
 	struct mrvl_crypto_qp *qp = queue_pair;
 	struct sam_cio *cio = qp->cio;
 	struct sam_cio_op_result results[nb_ops];
+	uintptr_t cookie;
+	uint64_t tsc, lat;
+	unsigned int bucket;
 	uint16_t i;
 
 	ret = sam_cio_deq(cio, results, &nb_ops);
@@ -693,9 +1105,25 @@ mrvl_crypto_pmd_dequeue_burst(void *queue_pair,
 		return 0;
 	}
 
+	tsc = rte_rdtsc();
+
 	/* Unpack and check results. */
 	for (i = 0; i < nb_ops; ++i) {
-		ops[i] = results[i].cookie;
+		lat = (tsc - qp->enq_tsc[qp->enq_tsc_tail++ % qp->nb_desc]) >>
+			MRVL_CRYPTO_LAT_SHIFT;
+		bucket = lat ? 64 - __builtin_clzll(lat) : 0;
+		if (bucket >= MRVL_CRYPTO_LAT_BUCKETS)
+			bucket = MRVL_CRYPTO_LAT_BUCKETS - 1;
+		qp->xstats.lat[bucket]++;
+
+		cookie = (uintptr_t)results[i].cookie;
+		if (unlikely(cookie & MRVL_CRYPTO_COOKIE_ICV)) {
+			ops[i] = mrvl_crypto_icv_unstage((struct mrvl_crypto_icv *)
+				(cookie & ~MRVL_CRYPTO_COOKIE_ICV), true);
+			qp->icv_tail++;
+		} else {
+			ops[i] = results[i].cookie;
+		}
 
 		switch (results[i].status) {
 		case SAM_CIO_OK:
@@ -704,6 +1132,7 @@ mrvl_crypto_pmd_dequeue_burst(void *queue_pair,
 		case SAM_CIO_ERR_ICV:
 			MRVL_CRYPTO_LOG_DBG("CIO returned SAM_CIO_ERR_ICV.");
 			ops[i]->status = RTE_CRYPTO_OP_STATUS_AUTH_FAILED;
+			qp->xstats.icv_fail_count++;
 			break;
 		default:
 			MRVL_CRYPTO_LOG_DBG(
@@ -733,6 +1162,7 @@ cryptodev_mrvl_crypto_create(const char *name,
 	struct rte_cryptodev *dev;
 	struct mrvl_crypto_private *internals;
 	struct sam_init_params	sam_params;
+	unsigned int i;
 	int ret;
 
 	if (init_params->name[0] == '\0') {
@@ -762,7 +1192,8 @@ cryptodev_mrvl_crypto_create(const char *name,
 
 	dev->feature_flags = RTE_CRYPTODEV_FF_SYMMETRIC_CRYPTO |
 			RTE_CRYPTODEV_FF_SYM_OPERATION_CHAINING |
-			RTE_CRYPTODEV_FF_HW_ACCELERATED;
+			RTE_CRYPTODEV_FF_HW_ACCELERATED |
+			RTE_CRYPTODEV_FF_MBUF_SCATTER_GATHER;
 
 	/* Set vector instructions mode supported */
 	internals = dev->data->dev_private;
@@ -770,6 +1201,28 @@ cryptodev_mrvl_crypto_create(const char *name,
 	internals->max_nb_qpairs = init_params->max_nb_queue_pairs;
 	internals->max_nb_sessions = init_params->max_nb_sessions;
 
+	rte_spinlock_init(&internals->sa_cache_lock);
+	internals->sa_cache = rte_zmalloc_socket("mrvl_crypto_sa_cache",
+			sizeof(*internals->sa_cache) * internals->max_nb_sessions,
+			0, init_params->socket_id);
+	if (internals->sa_cache == NULL) {
+		MRVL_CRYPTO_LOG_ERR("failed to allocate session cache");
+		goto init_error;
+	}
+
+	/* Metrics are registered on first use. */
+	rte_spinlock_init(&internals->metrics_lock);
+	internals->metrics_qp_keys = rte_malloc_socket("mrvl_crypto_metrics",
+			sizeof(*internals->metrics_qp_keys) *
+			internals->max_nb_qpairs, 0, init_params->socket_id);
+	if (internals->metrics_qp_keys == NULL) {
+		MRVL_CRYPTO_LOG_ERR("failed to allocate metrics keys");
+		goto init_error;
+	}
+	for (i = 0; i < internals->max_nb_qpairs; i++)
+		internals->metrics_qp_keys[i] = -1;
+	internals->metrics_dev_key = -1;
+
 	/*
 	 * ret == -EEXIST is correct, it means DMA
 	 * has been already initialized.
@@ -847,6 +1300,8 @@ static int
 cryptodev_mrvl_crypto_uninit(struct rte_vdev_device *vdev)
 {
 	const char *name = rte_vdev_device_name(vdev);
+	struct rte_cryptodev *dev;
+	struct mrvl_crypto_private *internals;
 
 	if (name == NULL)
 		return -EINVAL;
@@ -855,6 +1310,15 @@ cryptodev_mrvl_crypto_uninit(struct rte_vdev_device *vdev)
 		"Closing Marvell crypto device %s on numa socket %u\n",
 		name, rte_socket_id());
 
+	dev = rte_cryptodev_pmd_get_named_dev(name);
+	if (dev != NULL) {
+		internals = dev->data->dev_private;
+		rte_free(internals->sa_cache);
+		internals->sa_cache = NULL;
+		rte_free(internals->metrics_qp_keys);
+		internals->metrics_qp_keys = NULL;
+	}
+
 	return 0;
 }
 
@@ -31,11 +31,14 @@
  *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <stdio.h>
 #include <string.h>
 
 #include <rte_common.h>
 #include <rte_malloc.h>
 #include <rte_cryptodev_pmd.h>
+#include <rte_alarm.h>
+#include <rte_metrics.h>
 
 #include "rte_mrvl_pmd_private.h"
 
@@ -468,26 +471,169 @@ mrvl_crypto_pmd_config(__rte_unused struct rte_cryptodev *dev,
 }
 
 /**
- * Start device (PMD ops callback).
+ * Register queue pair metrics.
+ *
+ * Metrics are global ones, named after the device and the queue pair
+ * (the device name is truncated to fit the name length limit).
  *
  * @param dev Pointer to the device structure.
- * @returns 0. Always.
+ * @param qp_id Queue pair id.
+ * @returns 0 in case of success, negative value otherwise.
+ */
+static int
+mrvl_crypto_metrics_qp_register(struct rte_cryptodev *dev, uint16_t qp_id)
+{
+	struct mrvl_crypto_private *internals = dev->data->dev_private;
+	char names[2 + MRVL_CRYPTO_LAT_BUCKETS][RTE_METRICS_MAX_NAME_LEN];
+	const char *name_ptrs[RTE_DIM(names)];
+	unsigned int i, n = 0;
+	int ret;
+
+	for (i = 0; i < RTE_DIM(names); i++)
+		name_ptrs[i] = names[i];
+
+	snprintf(names[n++], sizeof(names[0]), "%.24s_qp%u_inflight",
+		 dev->data->name, qp_id);
+	snprintf(names[n++], sizeof(names[0]), "%.24s_qp%u_icv_fail",
+		 dev->data->name, qp_id);
+	for (i = 0; i < MRVL_CRYPTO_LAT_BUCKETS - 1; i++)
+		snprintf(names[n++], sizeof(names[0]),
+			 "%.24s_qp%u_lat_lt_%llu_cycles", dev->data->name,
+			 qp_id, 1ULL << (MRVL_CRYPTO_LAT_SHIFT + i));
+	snprintf(names[n++], sizeof(names[0]), "%.24s_qp%u_lat_ge_%llu_cycles",
+		 dev->data->name, qp_id, 1ULL << (MRVL_CRYPTO_LAT_SHIFT + i));
+
+	ret = rte_metrics_reg_names(name_ptrs, n);
+	if (ret < 0)
+		return ret;
+	internals->metrics_qp_keys[qp_id] = ret;
+
+	return 0;
+}
+
+/**
+ * Register device metrics.
+ *
+ * @param dev Pointer to the device structure.
+ * @returns 0 in case of success, negative value otherwise.
  */
 static int
-mrvl_crypto_pmd_start(__rte_unused struct rte_cryptodev *dev)
+mrvl_crypto_metrics_dev_register(struct rte_cryptodev *dev)
 {
+	struct mrvl_crypto_private *internals = dev->data->dev_private;
+	char names[2][RTE_METRICS_MAX_NAME_LEN];
+	const char *name_ptrs[RTE_DIM(names)];
+	int ret;
+
+	snprintf(names[0], sizeof(names[0]), "%.32s_sessions_started",
+		 dev->data->name);
+	snprintf(names[1], sizeof(names[1]), "%.32s_sessions_shared",
+		 dev->data->name);
+	name_ptrs[0] = names[0];
+	name_ptrs[1] = names[1];
+
+	ret = rte_metrics_reg_names(name_ptrs, RTE_DIM(names));
+	if (ret < 0)
+		return ret;
+	internals->metrics_dev_key = ret;
+
 	return 0;
 }
 
+/**
+ * Update device metrics.
+ *
+ * Metrics are registered on the first call, if the metrics library has
+ * been initialized by the application. Queue pair metrics are registered
+ * once per queue pair id and kept when queue pairs are set up again.
+ *
+ * @param dev Pointer to the device structure.
+ */
+static void
+mrvl_crypto_metrics_update(struct rte_cryptodev *dev)
+{
+	struct mrvl_crypto_private *internals = dev->data->dev_private;
+	struct mrvl_crypto_qp_xstats xstats;
+	uint64_t values[2];
+	uint16_t qp_id;
+
+	rte_spinlock_lock(&internals->metrics_lock);
+
+	if (internals->metrics_dev_key < 0 &&
+	    mrvl_crypto_metrics_dev_register(dev) < 0)
+		goto out;
+
+	for (qp_id = 0; qp_id < dev->data->nb_queue_pairs; qp_id++) {
+		struct mrvl_crypto_qp *qp = dev->data->queue_pairs[qp_id];
+
+		if (qp == NULL)
+			continue;
+
+		if (internals->metrics_qp_keys[qp_id] < 0 &&
+		    mrvl_crypto_metrics_qp_register(dev, qp_id) < 0)
+			continue;
+
+		xstats = qp->xstats;
+		xstats.inflight = qp->enq_tsc_head - qp->enq_tsc_tail;
+		rte_metrics_update_values(RTE_METRICS_GLOBAL,
+				internals->metrics_qp_keys[qp_id],
+				(const uint64_t *)&xstats,
+				sizeof(xstats) / sizeof(uint64_t));
+	}
+
+	values[0] = internals->sess_started;
+	values[1] = internals->sess_shared;
+	rte_metrics_update_values(RTE_METRICS_GLOBAL,
+			internals->metrics_dev_key, values, RTE_DIM(values));
+
+out:
+	rte_spinlock_unlock(&internals->metrics_lock);
+}
+
+/**
+ * Update device metrics periodically while the device is started.
+ *
+ * @param arg Pointer to the device structure.
+ */
+static void
+mrvl_crypto_metrics_alarm(void *arg)
+{
+	struct rte_cryptodev *dev = arg;
+
+	mrvl_crypto_metrics_update(dev);
+
+	if (rte_eal_alarm_set(MRVL_CRYPTO_METRICS_PERIOD_US,
+			      mrvl_crypto_metrics_alarm, dev) < 0)
+		MRVL_CRYPTO_LOG_ERR("Failed to rearm metrics update");
+}
+
+/**
+ * Start device (PMD ops callback).
+ *
+ * Starts the periodic metrics update.
+ *
+ * @param dev Pointer to the device structure.
+ * @returns 0 in case of success, negative value otherwise.
+ */
+static int
+mrvl_crypto_pmd_start(struct rte_cryptodev *dev)
+{
+	return rte_eal_alarm_set(MRVL_CRYPTO_METRICS_PERIOD_US,
+				 mrvl_crypto_metrics_alarm, dev);
+}
+
 /**
  * Stop device (PMD ops callback).
  *
+ * Stops the periodic metrics update and updates metrics a last time.
+ *
  * @param dev Pointer to the device structure.
- * @returns 0. Always.
  */
 static void
-mrvl_crypto_pmd_stop(__rte_unused struct rte_cryptodev *dev)
+mrvl_crypto_pmd_stop(struct rte_cryptodev *dev)
 {
+	rte_eal_alarm_cancel(mrvl_crypto_metrics_alarm, dev);
+	mrvl_crypto_metrics_update(dev);
 }
 
 /**
@@ -506,6 +652,8 @@ mrvl_crypto_pmd_close(__rte_unused struct rte_cryptodev *dev)
 /**
  * Get device statistics (PMD ops callback).
  *
+ * Device metrics are updated as well.
+ *
  * @param dev Pointer to the device structure.
  * @param stats Pointer to statistics structure [out].
  */
@@ -524,6 +672,8 @@ mrvl_crypto_pmd_stats_get(struct rte_cryptodev *dev,
 		stats->enqueue_err_count += qp->stats.enqueue_err_count;
 		stats->dequeue_err_count += qp->stats.dequeue_err_count;
 	}
+
+	mrvl_crypto_metrics_update(dev);
 }
 
 /**
@@ -540,6 +690,8 @@ mrvl_crypto_pmd_stats_reset(struct rte_cryptodev *dev)
 		struct mrvl_crypto_qp *qp = dev->data->queue_pairs[qp_id];
 
 		memset(&qp->stats, 0, sizeof(qp->stats));
+		memset(qp->xstats.lat, 0, sizeof(qp->xstats.lat));
+		qp->xstats.icv_fail_count = 0;
 	}
 }
 
@@ -580,6 +732,8 @@ mrvl_crypto_pmd_qp_release(struct rte_cryptodev *dev, uint16_t qp_id)
 
 	if (dev->data->queue_pairs[qp_id] != NULL) {
 		sam_cio_deinit(qp->cio);
+		rte_free(qp->enq_tsc);
+		rte_free(qp->icv);
 		rte_free(dev->data->queue_pairs[qp_id]);
 		dev->data->queue_pairs[qp_id] = NULL;
 	}
@@ -636,16 +790,33 @@ mrvl_crypto_pmd_qp_setup(struct rte_cryptodev *dev, uint16_t qp_id,
 		qp->cio_params.match = qp->name;
 		qp->cio_params.size = descriptors;
 
+		qp->nb_desc = descriptors;
+
+		qp->icv = rte_zmalloc_socket("MRVL Crypto PMD ICV slots",
+				sizeof(*qp->icv) * descriptors,
+				RTE_CACHE_LINE_SIZE, socket_id);
+		if (qp->icv == NULL)
+			break;
+
+		qp->enq_tsc = rte_zmalloc_socket("MRVL Crypto PMD timestamps",
+				sizeof(*qp->enq_tsc) * descriptors,
+				RTE_CACHE_LINE_SIZE, socket_id);
+		if (qp->enq_tsc == NULL)
+			break;
+
 		if (sam_cio_init(&qp->cio_params, &qp->cio) < 0)
 			break;
 
 		qp->sess_mp = dev->data->session_pool;
 
 		memset(&qp->stats, 0, sizeof(qp->stats));
+		memset(&qp->xstats, 0, sizeof(qp->xstats));
 		dev->data->queue_pairs[qp_id] = qp;
 		return 0;
 	} while (0);
 
+	rte_free(qp->enq_tsc);
+	rte_free(qp->icv);
 	rte_free(qp);
 	return -1;
 }
@@ -719,10 +890,16 @@ mrvl_crypto_pmd_session_configure(struct rte_cryptodev *dev,
 		MRVL_CRYPTO_LOG_ERR("Failed to configure session parameters.");
 		return NULL;
 	}
+
 	/*
-	 * Session initialization can be done only later,
-	 * when first packet arrives for correct qpair, so we know cio.
+	 * SAM session does not depend on cio, so create it now
+	 * to keep it out of the data path.
 	 */
+	if (mrvl_crypto_session_start(dev, sess) < 0) {
+		MRVL_CRYPTO_LOG_ERR("Failed to start session.");
+		return NULL;
+	}
+
 	return sess;
 }
 
@@ -733,19 +910,13 @@ mrvl_crypto_pmd_session_configure(struct rte_cryptodev *dev,
  * @returns 0. Always.
  */
 static void
-mrvl_crypto_pmd_session_clear(struct rte_cryptodev *dev __rte_unused,
-				void *sess)
+mrvl_crypto_pmd_session_clear(struct rte_cryptodev *dev, void *sess)
 {
-	struct mrvl_crypto_session *mrvl_sess =
-			(struct mrvl_crypto_session *)sess;
-
 	if (!sess)
 		return;
 
-	if (mrvl_sess->sam_sess &&
-			sam_session_destroy(mrvl_sess->sam_sess) < 0) {
-		MRVL_CRYPTO_LOG_INFO("Error while destroying session!");
-	}
+	mrvl_crypto_session_stop(dev, sess);
+
 	/* Zero out the whole structure */
 	memset(sess, 0, sizeof(struct mrvl_crypto_session));
 
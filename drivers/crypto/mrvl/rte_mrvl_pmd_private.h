@@ -33,6 +33,8 @@
 #ifndef _RTE_MRVL_PMD_PRIVATE_H_
 #define _RTE_MRVL_PMD_PRIVATE_H_
 
+#include <rte_spinlock.h>
+
 #include "rte_mrvl_compat.h"
 #include "rte_cryptodev.h"
 
@@ -90,6 +92,44 @@ do {								\
 /** The longest block length - currently the winner is again SHA512.*/
 #define SHA_BLOCK_MAX				SHA512_BLOCK_SIZE
 
+/** The longest digest (ICV) length - SHA512.*/
+#define ICV_MAX					BITS2BYTES(512)
+
+/** The longest cipher key length - AES-256.*/
+#define CIPHER_KEY_MAX				BITS2BYTES(256)
+
+/** Maximum number of crypto ops handled in a single enqueue call. */
+#define MRVL_CRYPTO_MAX_BURST_SIZE	64
+
+/** Maximum number of mbuf segments in a single crypto op. */
+#define MRVL_CRYPTO_MAX_SEGS		16
+
+/**
+ * Number of buffer descriptors (per direction) available to a single
+ * enqueue call.
+ *
+ * Single segment ops use one descriptor each, so a full burst of these
+ * always fits, while long chains consume the pool faster.
+ */
+#define MRVL_CRYPTO_BD_POOL_SIZE	(MRVL_CRYPTO_MAX_BURST_SIZE * 4)
+
+/** Number of enqueue-to-dequeue latency histogram buckets. */
+#define MRVL_CRYPTO_LAT_BUCKETS		12
+
+/**
+ * Log2 of the first latency bucket upper bound (in TSC cycles).
+ *
+ * Bucket n counts latencies lower than 2^(MRVL_CRYPTO_LAT_SHIFT + n)
+ * cycles, the last one counts everything else.
+ */
+#define MRVL_CRYPTO_LAT_SHIFT		10
+
+/** Period of the metrics update while the device is started (in us). */
+#define MRVL_CRYPTO_METRICS_PERIOD_US	1000000
+
+/** Request cookie flag marking ops with staged ICV. */
+#define MRVL_CRYPTO_COOKIE_ICV		0x1UL
+
 /** The operation order mode enumerator. */
 enum mrvl_crypto_chain_order {
 	MRVL_CRYPTO_CHAIN_CIPHER_ONLY,
@@ -120,10 +160,66 @@ enum mrvl_session_state {
 typedef int (*mv_hmac_gen_f)(unsigned char key[], int key_len,
 		     unsigned char inner[], unsigned char outer[]);
 
+/**
+ * SAM session cache entry.
+ *
+ * Sessions with identical parameters (including keys) share a single
+ * SAM session, i.e. a single hardware context.
+ */
+struct mrvl_crypto_sa {
+	/** Number of sessions using the entry, 0 means it is free. */
+	uint32_t refcnt;
+
+	/** SAM session parameters, key pointers refer to copies below. */
+	struct sam_session_params params;
+
+	/** Copy of the cipher key. */
+	uint8_t cipher_key[CIPHER_KEY_MAX];
+
+	/** Copy of the auth key. */
+	uint8_t auth_key[SHA_BLOCK_MAX];
+
+	/** SAM session pointer. */
+	struct sam_sa *sam_sess;
+};
+
 /** Private data structure for each crypto device. */
 struct mrvl_crypto_private {
 	unsigned int max_nb_qpairs;	/**< Max number of queue pairs */
 	unsigned int max_nb_sessions;	/**< Max number of sessions */
+	rte_spinlock_t sa_cache_lock;	/**< Protects SAM session cache */
+	struct mrvl_crypto_sa *sa_cache; /**< SAM session cache */
+	uint64_t sess_started;		/**< Number of sessions started */
+	uint64_t sess_shared;		/**< Number of sessions sharing SAM one */
+	rte_spinlock_t metrics_lock;	/**< Serializes metrics updates */
+	int *metrics_qp_keys;		/**< Queue pair metrics keys (or -1) */
+	int metrics_dev_key;		/**< Device metrics key (or -1) */
+};
+
+/**
+ * ICV staging slot.
+ *
+ * Used by ops whose digest is not where EIP expects it. EIP then works on
+ * the ICV placed at auth offset + length and the data it overwrites is
+ * kept here until the op is dequeued.
+ */
+struct mrvl_crypto_icv {
+	/** Crypto op using the slot. */
+	struct rte_crypto_op *op;
+
+	/** Original data at the ICV location. */
+	uint8_t data[ICV_MAX];
+};
+
+/**
+ * Extended queue pair statistics.
+ *
+ * Reported through the metrics library in this order.
+ */
+struct mrvl_crypto_qp_xstats {
+	uint64_t inflight;		/**< Ops currently in SAM */
+	uint64_t icv_fail_count;	/**< Ops failed ICV verification */
+	uint64_t lat[MRVL_CRYPTO_LAT_BUCKETS]; /**< Latency histogram */
 };
 
 /** Private crypto queue pair structure. */
@@ -140,9 +236,41 @@ struct mrvl_crypto_qp {
 	/** Queue pair statistics. */
 	struct rte_cryptodev_stats stats;
 
+	/** Extended queue pair statistics. */
+	struct mrvl_crypto_qp_xstats xstats;
+
 	/** CIO initialization parameters.*/
 	struct sam_cio_params cio_params;
 
+	/** Requests prepared during the enqueue call. */
+	struct sam_cio_op_params requests[MRVL_CRYPTO_MAX_BURST_SIZE];
+
+	/**
+	 * Source and destination buffer descriptors.
+	 *
+	 * SAM does not store bd pointers past sam_cio_enq(), so the pools
+	 * are reused by every enqueue call.
+	 */
+	struct sam_buf_info src_bd[MRVL_CRYPTO_BD_POOL_SIZE];
+	struct sam_buf_info dst_bd[MRVL_CRYPTO_BD_POOL_SIZE];
+
+	/** Number of CIO descriptors. */
+	uint32_t nb_desc;
+
+	/**
+	 * ICV staging slots, one per CIO descriptor.
+	 *
+	 * SAM completes requests in order, so slots are used as a FIFO.
+	 */
+	struct mrvl_crypto_icv *icv;
+	uint32_t icv_head;	/**< Index of the next slot to use */
+	uint32_t icv_tail;	/**< Index of the oldest slot in use */
+
+	/** Enqueue timestamps of requests in SAM, used as a FIFO as well. */
+	uint64_t *enq_tsc;
+	uint32_t enq_tsc_head;	/**< Index of the next timestamp */
+	uint32_t enq_tsc_tail;	/**< Index of the oldest timestamp */
+
 	/** Unique Queue Pair name. */
 	char name[RTE_CRYPTODEV_NAME_LEN];
 } __rte_cache_aligned;
@@ -158,6 +286,9 @@ struct mrvl_crypto_session {
 	/** SAM session pointer. */
 	struct sam_sa *sam_sess;
 
+	/** SAM session cache entry, NULL if SAM session is not shared. */
+	struct mrvl_crypto_sa *sa;
+
 	/** DPDK crypto device pointer.*/
 	struct rte_cryptodev *dev;
 
@@ -168,6 +299,15 @@ extern int mrvl_crypto_prepare_session_parameters(
 		struct rte_cryptodev *dev,
 		struct mrvl_crypto_session *sess,
 		const struct rte_crypto_sym_xform *xform);
+
+/** Create (or take from the cache) SAM session for the crypto session */
+extern int mrvl_crypto_session_start(struct rte_cryptodev *dev,
+		struct mrvl_crypto_session *sess);
+
+/** Release SAM session of the crypto session */
+extern void mrvl_crypto_session_stop(struct rte_cryptodev *dev,
+		struct mrvl_crypto_session *sess);
+
 /** device specific operations function pointer structure */
 
 extern struct rte_cryptodev_ops mrvl_crypto_pmd_ops;
@@ -0,0 +1,629 @@
+/*
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Semihalf. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Semihalf nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_errno.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_mempool.h>
+#include <rte_ring.h>
+
+/*
+ * The objects are grouped in buckets: areas of RTE_DRIVER_MEMPOOL_BUCKET_SIZE
+ * bytes, aligned on their size, starting with a bucket header followed by
+ * the objects. The header of an object's bucket is found by masking its
+ * address.
+ *
+ * A bucket is owned by the lcore which took it from the pool. Only the
+ * owner counts the objects returned to a bucket; objects freed on another
+ * lcore are passed to the owner through its adoption ring. Once all its
+ * objects are back, the bucket is full and goes to the owner's stack, and
+ * from there to the shared ring of full buckets when the stack grows too
+ * big. Requests which are not a multiple of the bucket size are served
+ * from the orphan ring of loose objects, which is refilled by splitting a
+ * full bucket.
+ */
+
+#define RTE_DRIVER_MEMPOOL_BUCKET_SIZE \
+	(RTE_DRIVER_MEMPOOL_BUCKET_SIZE_KB * 1024)
+
+/* owner of the buckets being populated, counted by whoever adds objects */
+#define BUCKET_OWNER_POPULATE (LCORE_ID_ANY - 1)
+/* owner of the buckets whose objects are kept in the orphan ring */
+#define BUCKET_OWNER_NONE LCORE_ID_ANY
+
+/* number of objects taken at once from an adoption ring */
+#define BUCKET_ADOPT_BURST 32
+
+struct bucket_header {
+	unsigned int lcore_id;  /**< Owner of the bucket. */
+	unsigned int fill_cnt;  /**< Objects returned to the bucket. */
+};
+
+struct bucket_stack {
+	unsigned int top;
+	unsigned int limit;
+	void *objects[];
+};
+
+struct bucket_data {
+	unsigned int header_size;    /**< Bucket start to first object. */
+	unsigned int total_elt_size; /**< Object stride. */
+	unsigned int obj_per_bucket;
+	unsigned int bucket_stack_thresh;
+	uintptr_t bucket_page_mask;
+	struct rte_ring *shared_bucket_ring;
+	struct rte_ring *shared_orphan_ring;
+	struct bucket_stack *buckets[RTE_MAX_LCORE];
+	/* Objects returned to a bucket owned by another lcore. */
+	struct rte_ring *adoption_buffer_rings[RTE_MAX_LCORE];
+};
+
+/* size of the bucket header, before the objects */
+static inline unsigned int
+bucket_header_size(const struct rte_mempool *mp)
+{
+	if (mp->flags & MEMPOOL_F_NO_CACHE_ALIGN)
+		return RTE_ALIGN_CEIL(sizeof(struct bucket_header), 8);
+	return RTE_CACHE_LINE_ROUNDUP(sizeof(struct bucket_header));
+}
+
+static unsigned int
+bucket_obj_per_bucket(const struct rte_mempool *mp)
+{
+	unsigned int total_elt_sz;
+
+	total_elt_sz = mp->header_size + mp->elt_size + mp->trailer_size;
+	return (RTE_DRIVER_MEMPOOL_BUCKET_SIZE - bucket_header_size(mp)) /
+		total_elt_sz;
+}
+
+static struct bucket_stack *
+bucket_stack_create(const struct rte_mempool *mp, unsigned int n_elts)
+{
+	struct bucket_stack *stack;
+
+	stack = rte_zmalloc_socket("bucket_stack",
+				   sizeof(struct bucket_stack) +
+				   n_elts * sizeof(void *),
+				   RTE_CACHE_LINE_SIZE,
+				   mp->socket_id);
+	if (stack == NULL)
+		return NULL;
+	stack->limit = n_elts;
+	stack->top = 0;
+
+	return stack;
+}
+
+static inline void
+bucket_stack_push(struct bucket_stack *stack, void *obj)
+{
+	RTE_ASSERT(stack->top < stack->limit);
+	stack->objects[stack->top++] = obj;
+}
+
+static inline void *
+bucket_stack_pop(struct bucket_stack *stack)
+{
+	if (stack->top == 0)
+		return NULL;
+	return stack->objects[--stack->top];
+}
+
+/* store the n objects of a bucket starting at hdr in obj_table */
+static inline void **
+bucket_fill_obj_table(const struct bucket_data *bd, struct bucket_header *hdr,
+		      void **obj_table, unsigned int n)
+{
+	uint8_t *objptr = (uint8_t *)hdr + bd->header_size;
+	unsigned int i;
+
+	for (i = 0; i < n; i++, objptr += bd->total_elt_size)
+		*obj_table++ = objptr;
+
+	return obj_table;
+}
+
+/*
+ * Count an object back in its bucket if this lcore owns it. Otherwise,
+ * return the ring where the object goes.
+ */
+static inline struct rte_ring *
+bucket_put_local(struct bucket_data *bd, void *obj, unsigned int lcore_id)
+{
+	struct bucket_header *hdr;
+	unsigned int owner;
+	int rc;
+
+	hdr = (struct bucket_header *)((uintptr_t)obj & bd->bucket_page_mask);
+	owner = hdr->lcore_id;
+
+	if (likely(owner == lcore_id && owner < RTE_MAX_LCORE)) {
+		if (++hdr->fill_cnt == bd->obj_per_bucket) {
+			hdr->fill_cnt = 0;
+			/* the stack is big enough for all buckets */
+			bucket_stack_push(bd->buckets[lcore_id], hdr);
+		}
+		return NULL;
+	}
+
+	if (owner < RTE_MAX_LCORE)
+		return bd->adoption_buffer_rings[owner];
+
+	if (owner == BUCKET_OWNER_POPULATE) {
+		if (++hdr->fill_cnt == bd->obj_per_bucket) {
+			hdr->fill_cnt = 0;
+			rc = rte_ring_mp_enqueue(bd->shared_bucket_ring, hdr);
+			RTE_ASSERT(rc == 0);
+			RTE_SET_USED(rc);
+		}
+		return NULL;
+	}
+
+	return bd->shared_orphan_ring;
+}
+
+/*
+ * Put objects back in their buckets. Runs of objects going to the same
+ * ring are enqueued at once; the rings are big enough for all objects.
+ */
+static inline void
+bucket_put_objs(struct bucket_data *bd, void * const *obj_table,
+		unsigned int n, unsigned int lcore_id)
+{
+	struct rte_ring *r, *run_ring = NULL;
+	unsigned int i, run_start = 0;
+
+	for (i = 0; i < n; i++) {
+		r = bucket_put_local(bd, obj_table[i], lcore_id);
+		if (r == run_ring)
+			continue;
+		if (run_ring != NULL)
+			rte_ring_mp_enqueue_bulk(run_ring, &obj_table[run_start],
+						 i - run_start, NULL);
+		run_ring = r;
+		run_start = i;
+	}
+	if (run_ring != NULL)
+		rte_ring_mp_enqueue_bulk(run_ring, &obj_table[run_start],
+					 n - run_start, NULL);
+}
+
+/* take back the objects of our buckets freed on other lcores */
+static inline void
+bucket_adopt_orphans(struct bucket_data *bd, unsigned int lcore_id)
+{
+	struct rte_ring *adopt_ring = bd->adoption_buffer_rings[lcore_id];
+	void *orphans[BUCKET_ADOPT_BURST];
+	unsigned int n;
+
+	if (likely(rte_ring_empty(adopt_ring)))
+		return;
+
+	do {
+		n = rte_ring_sc_dequeue_burst(adopt_ring, orphans,
+					      BUCKET_ADOPT_BURST, NULL);
+		bucket_put_objs(bd, orphans, n, lcore_id);
+	} while (n == BUCKET_ADOPT_BURST);
+}
+
+/* take a full bucket, from the local stack first */
+static inline struct bucket_header *
+bucket_take(struct bucket_data *bd, unsigned int lcore_id)
+{
+	struct bucket_header *hdr = NULL;
+
+	if (lcore_id < RTE_MAX_LCORE)
+		hdr = bucket_stack_pop(bd->buckets[lcore_id]);
+	if (hdr == NULL) {
+		if (rte_ring_mc_dequeue(bd->shared_bucket_ring,
+					(void **)&hdr) != 0)
+			return NULL;
+		/* buckets taken by non-EAL threads are not reassembled */
+		hdr->lcore_id = lcore_id < RTE_MAX_LCORE ?
+			lcore_id : BUCKET_OWNER_NONE;
+	}
+
+	return hdr;
+}
+
+/* give back a full bucket taken by bucket_take() */
+static inline void
+bucket_untake(struct bucket_data *bd, struct bucket_header *hdr,
+	      unsigned int lcore_id)
+{
+	if (lcore_id < RTE_MAX_LCORE)
+		bucket_stack_push(bd->buckets[lcore_id], hdr);
+	else
+		rte_ring_mp_enqueue(bd->shared_bucket_ring, hdr);
+}
+
+static int
+bucket_enqueue(struct rte_mempool *mp, void * const *obj_table,
+	       unsigned int n)
+{
+	struct bucket_data *bd = mp->pool_data;
+	unsigned int lcore_id = rte_lcore_id();
+	struct bucket_stack *local_stack;
+
+	bucket_put_objs(bd, obj_table, n, lcore_id);
+
+	if (lcore_id >= RTE_MAX_LCORE)
+		return 0;
+
+	/* share the full buckets above the threshold */
+	local_stack = bd->buckets[lcore_id];
+	if (local_stack->top > bd->bucket_stack_thresh) {
+		rte_ring_mp_enqueue_bulk(bd->shared_bucket_ring,
+			&local_stack->objects[bd->bucket_stack_thresh],
+			local_stack->top - bd->bucket_stack_thresh, NULL);
+		local_stack->top = bd->bucket_stack_thresh;
+	}
+
+	return 0;
+}
+
+/* get less than a bucket of objects */
+static int
+bucket_dequeue_orphans(struct bucket_data *bd, void **obj_table,
+		       unsigned int n_orphans, unsigned int lcore_id)
+{
+	struct bucket_header *hdr;
+	uint8_t *objptr;
+	unsigned int i;
+
+	if (rte_ring_mc_dequeue_bulk(bd->shared_orphan_ring, obj_table,
+				     n_orphans, NULL) == n_orphans)
+		return 0;
+
+	/* split a bucket, the objects not returned become orphans */
+	hdr = bucket_take(bd, lcore_id);
+	if (hdr == NULL)
+		return -ENOBUFS;
+
+	bucket_fill_obj_table(bd, hdr, obj_table, n_orphans);
+	objptr = (uint8_t *)hdr + bd->header_size +
+		n_orphans * bd->total_elt_size;
+	for (i = n_orphans; i < bd->obj_per_bucket;
+	     i++, objptr += bd->total_elt_size)
+		rte_ring_mp_enqueue(bd->shared_orphan_ring, objptr);
+
+	return 0;
+}
+
+static int
+bucket_dequeue(struct rte_mempool *mp, void **obj_table, unsigned int n)
+{
+	struct bucket_data *bd = mp->pool_data;
+	unsigned int lcore_id = rte_lcore_id();
+	unsigned int n_buckets = n / bd->obj_per_bucket;
+	unsigned int n_orphans = n - n_buckets * bd->obj_per_bucket;
+	void **orphans = obj_table + n_buckets * bd->obj_per_bucket;
+	struct bucket_header *hdr;
+	unsigned int i;
+
+	if (lcore_id < RTE_MAX_LCORE)
+		bucket_adopt_orphans(bd, lcore_id);
+
+	if (n_orphans > 0 &&
+	    bucket_dequeue_orphans(bd, orphans, n_orphans, lcore_id) != 0)
+		return -ENOBUFS;
+
+	for (i = 0; i < n_buckets; i++) {
+		hdr = bucket_take(bd, lcore_id);
+		if (unlikely(hdr == NULL))
+			goto fail;
+		bucket_fill_obj_table(bd, hdr,
+			obj_table + i * bd->obj_per_bucket, bd->obj_per_bucket);
+	}
+
+	return 0;
+
+fail:
+	while (i-- > 0) {
+		hdr = (struct bucket_header *)
+			((uintptr_t)obj_table[i * bd->obj_per_bucket] &
+			 bd->bucket_page_mask);
+		bucket_untake(bd, hdr, lcore_id);
+	}
+	if (n_orphans > 0)
+		rte_ring_mp_enqueue_bulk(bd->shared_orphan_ring, orphans,
+					 n_orphans, NULL);
+	return -ENOBUFS;
+}
+
+static int
+bucket_dequeue_contig_blocks(struct rte_mempool *mp, void **first_obj_table,
+			     unsigned int n)
+{
+	struct bucket_data *bd = mp->pool_data;
+	unsigned int lcore_id = rte_lcore_id();
+	struct bucket_header *hdr;
+	unsigned int i;
+
+	if (lcore_id < RTE_MAX_LCORE)
+		bucket_adopt_orphans(bd, lcore_id);
+
+	for (i = 0; i < n; i++) {
+		hdr = bucket_take(bd, lcore_id);
+		if (unlikely(hdr == NULL))
+			goto fail;
+		first_obj_table[i] = (uint8_t *)hdr + bd->header_size;
+	}
+
+	return 0;
+
+fail:
+	while (i-- > 0)
+		bucket_untake(bd, (struct bucket_header *)
+			((uint8_t *)first_obj_table[i] - bd->header_size),
+			lcore_id);
+	return -ENOBUFS;
+}
+
+/* add the objects counted in the buckets which are not full */
+static void
+count_underfilled_buckets(__rte_unused struct rte_mempool *mp, void *opaque,
+			  struct rte_mempool_memhdr *memhdr,
+			  __rte_unused unsigned int mem_idx)
+{
+	unsigned int *pcount = opaque;
+	uint8_t *iter, *end;
+	const struct bucket_header *hdr;
+
+	iter = RTE_PTR_ALIGN_CEIL(memhdr->addr, RTE_DRIVER_MEMPOOL_BUCKET_SIZE);
+	end = (uint8_t *)memhdr->addr + memhdr->len;
+	for (; iter + RTE_DRIVER_MEMPOOL_BUCKET_SIZE <= end;
+	     iter += RTE_DRIVER_MEMPOOL_BUCKET_SIZE) {
+		hdr = (const struct bucket_header *)iter;
+		if (hdr->lcore_id < RTE_MAX_LCORE)
+			*pcount += hdr->fill_cnt;
+	}
+}
+
+static unsigned int
+bucket_get_count(const struct rte_mempool *mp)
+{
+	const struct bucket_data *bd = mp->pool_data;
+	unsigned int count;
+	unsigned int i;
+
+	count = bd->obj_per_bucket * rte_ring_count(bd->shared_bucket_ring) +
+		rte_ring_count(bd->shared_orphan_ring);
+
+	RTE_LCORE_FOREACH(i) {
+		count += bd->obj_per_bucket * bd->buckets[i]->top +
+			rte_ring_count(bd->adoption_buffer_rings[i]);
+	}
+
+	rte_mempool_mem_iter((struct rte_mempool *)(uintptr_t)mp,
+			     count_underfilled_buckets, &count);
+
+	return count;
+}
+
+static int
+bucket_get_info(const struct rte_mempool *mp, struct rte_mempool_info *info)
+{
+	info->contig_block_size = bucket_obj_per_bucket(mp);
+	return 0;
+}
+
+static size_t
+bucket_calc_mem_size(const struct rte_mempool *mp, uint32_t obj_num,
+		     uint32_t pg_shift)
+{
+	unsigned int obj_per_bucket = bucket_obj_per_bucket(mp);
+	size_t n_buckets, size;
+
+	if (obj_per_bucket == 0)
+		return 0;
+
+	/* one more bucket to align the first one */
+	n_buckets = (obj_num + obj_per_bucket - 1) / obj_per_bucket + 1;
+	size = n_buckets * RTE_DRIVER_MEMPOOL_BUCKET_SIZE;
+	if (pg_shift != 0)
+		size = RTE_ALIGN_CEIL(size, (size_t)1 << pg_shift);
+
+	return size;
+}
+
+static int
+bucket_populate(struct rte_mempool *mp, unsigned int max_objs,
+		char *vaddr, phys_addr_t paddr, size_t len)
+{
+	struct bucket_data *bd = mp->pool_data;
+	const size_t bucket_sz = RTE_DRIVER_MEMPOOL_BUCKET_SIZE;
+	unsigned int hdr_sz = bucket_header_size(mp);
+	struct bucket_header *hdr;
+	unsigned int n = 0, n_objs;
+	size_t off;
+	int ret;
+
+	off = RTE_PTR_ALIGN_CEIL(vaddr, bucket_sz) - vaddr;
+
+	/* headers of unused buckets are initialized too, for get_count */
+	for (; off + bucket_sz <= len; off += bucket_sz) {
+		hdr = (struct bucket_header *)(vaddr + off);
+		hdr->fill_cnt = 0;
+		n_objs = RTE_MIN(bd->obj_per_bucket, max_objs - n);
+		if (n_objs == 0) {
+			hdr->lcore_id = BUCKET_OWNER_NONE;
+			continue;
+		}
+
+		/* a bucket which is not full is never assembled */
+		hdr->lcore_id = n_objs == bd->obj_per_bucket ?
+			BUCKET_OWNER_POPULATE : BUCKET_OWNER_NONE;
+		ret = rte_mempool_op_populate_default(mp, n_objs,
+			vaddr + off + hdr_sz,
+			paddr == RTE_BAD_PHYS_ADDR ?
+			RTE_BAD_PHYS_ADDR : paddr + off + hdr_sz,
+			bucket_sz - hdr_sz);
+		if (ret < 0)
+			return ret;
+		n += ret;
+	}
+
+	return n;
+}
+
+static void
+bucket_free(struct rte_mempool *mp)
+{
+	struct bucket_data *bd = mp->pool_data;
+	unsigned int i;
+
+	if (bd == NULL)
+		return;
+
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		rte_free(bd->buckets[i]);
+		rte_ring_free(bd->adoption_buffer_rings[i]);
+	}
+	rte_ring_free(bd->shared_orphan_ring);
+	rte_ring_free(bd->shared_bucket_ring);
+	rte_free(bd);
+	mp->pool_data = NULL;
+}
+
+static int
+bucket_alloc(struct rte_mempool *mp)
+{
+	char rg_name[RTE_RING_NAMESIZE];
+	struct bucket_data *bd;
+	unsigned int n_buckets;
+	unsigned int i;
+	int ret;
+
+	RTE_BUILD_BUG_ON((RTE_DRIVER_MEMPOOL_BUCKET_SIZE &
+			  (RTE_DRIVER_MEMPOOL_BUCKET_SIZE - 1)) != 0);
+
+	if (bucket_obj_per_bucket(mp) == 0) {
+		RTE_LOG(ERR, MEMPOOL,
+			"Objects of %s do not fit in a %u kB bucket\n",
+			mp->name, RTE_DRIVER_MEMPOOL_BUCKET_SIZE_KB);
+		return -EINVAL;
+	}
+
+	bd = rte_zmalloc_socket("bucket_pool", sizeof(*bd),
+				RTE_CACHE_LINE_SIZE, mp->socket_id);
+	if (bd == NULL) {
+		RTE_LOG(ERR, MEMPOOL, "Cannot allocate bucket data\n");
+		return -ENOMEM;
+	}
+	mp->pool_data = bd;
+
+	bd->header_size = bucket_header_size(mp) + mp->header_size;
+	bd->total_elt_size = mp->header_size + mp->elt_size +
+		mp->trailer_size;
+	bd->obj_per_bucket = bucket_obj_per_bucket(mp);
+	bd->bucket_page_mask = ~(uintptr_t)(RTE_DRIVER_MEMPOOL_BUCKET_SIZE - 1);
+	n_buckets = (mp->size + bd->obj_per_bucket - 1) / bd->obj_per_bucket;
+	/* keep at most half of a fair share of the buckets on an lcore */
+	bd->bucket_stack_thresh = RTE_MAX(1U,
+		n_buckets / (2 * rte_lcore_count()));
+
+	RTE_LCORE_FOREACH(i) {
+		bd->buckets[i] = bucket_stack_create(mp, n_buckets);
+		if (bd->buckets[i] == NULL) {
+			ret = -ENOMEM;
+			goto fail;
+		}
+
+		ret = snprintf(rg_name, sizeof(rg_name),
+			       RTE_MEMPOOL_MZ_FORMAT ".a%u", mp->name, i);
+		if (ret < 0 || ret >= (int)sizeof(rg_name)) {
+			ret = -ENAMETOOLONG;
+			goto fail;
+		}
+		bd->adoption_buffer_rings[i] = rte_ring_create(rg_name,
+			rte_align32pow2(mp->size + 1), mp->socket_id,
+			RING_F_SC_DEQ);
+		if (bd->adoption_buffer_rings[i] == NULL) {
+			ret = -rte_errno;
+			goto fail;
+		}
+	}
+
+	ret = snprintf(rg_name, sizeof(rg_name),
+		       RTE_MEMPOOL_MZ_FORMAT ".o", mp->name);
+	if (ret < 0 || ret >= (int)sizeof(rg_name)) {
+		ret = -ENAMETOOLONG;
+		goto fail;
+	}
+	bd->shared_orphan_ring = rte_ring_create(rg_name,
+		rte_align32pow2(mp->size + 1), mp->socket_id, 0);
+	if (bd->shared_orphan_ring == NULL) {
+		ret = -rte_errno;
+		goto fail;
+	}
+
+	ret = snprintf(rg_name, sizeof(rg_name),
+		       RTE_MEMPOOL_MZ_FORMAT ".b", mp->name);
+	if (ret < 0 || ret >= (int)sizeof(rg_name)) {
+		ret = -ENAMETOOLONG;
+		goto fail;
+	}
+	bd->shared_bucket_ring = rte_ring_create(rg_name,
+		rte_align32pow2(n_buckets + 1), mp->socket_id, 0);
+	if (bd->shared_bucket_ring == NULL) {
+		ret = -rte_errno;
+		goto fail;
+	}
+
+	return 0;
+
+fail:
+	bucket_free(mp);
+	return ret;
+}
+
+static const struct rte_mempool_ops ops_bucket = {
+	.name = "bucket",
+	.alloc = bucket_alloc,
+	.free = bucket_free,
+	.enqueue = bucket_enqueue,
+	.dequeue = bucket_dequeue,
+	.get_count = bucket_get_count,
+	.calc_mem_size = bucket_calc_mem_size,
+	.populate = bucket_populate,
+	.get_info = bucket_get_info,
+	.dequeue_contig_blocks = bucket_dequeue_contig_blocks,
+};
+
+MEMPOOL_REGISTER_OPS(ops_bucket);
@@ -0,0 +1,329 @@
+/*
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Semihalf. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Semihalf nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include <rte_branch_prediction.h>
+#include <rte_log.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+#include <rte_spinlock.h>
+
+/* Unluckily, container_of is defined by both DPDK and MUSDK,
+ * we'll declare only one version.
+ *
+ * Note that it is not used in this driver anyway.
+ */
+#ifdef container_of
+#undef container_of
+#endif
+
+#include <drivers/mv_pp2.h>
+#include <drivers/mv_pp2_bpool.h>
+#include <drivers/mv_pp2_hif.h>
+
+#include "mrvl_mempool.h"
+
+/* Maximum match string length */
+#define MRVL_MATCH_LEN 16
+
+/* Number of buffers put into BPool at once */
+#define MRVL_MEMPOOL_PUT_BULK 64U
+
+#define MRVL_COOKIE_ADDR_INVALID ~0ULL
+
+#define MRVL_COOKIE_HIGH_ADDR_SHIFT	(sizeof(pp2_cookie_t) * 8)
+#define MRVL_COOKIE_HIGH_ADDR_MASK	(~0ULL << MRVL_COOKIE_HIGH_ADDR_SHIFT)
+
+/* Ids below MRVL_MEMPOOL_BPOOL_FIRST are used by kernel and PMD */
+static int used_bpools[PP2_NUM_PKT_PROC] = {
+	(1 << MRVL_MEMPOOL_BPOOL_FIRST) - 1,
+	(1 << MRVL_MEMPOOL_BPOOL_FIRST) - 1
+};
+
+/*
+ * All BPool backed mempools share a single hif, accesses are serialized
+ * by the lock. Mempool cache absorbs most of the get/put operations,
+ * so the lock is taken on cache refill and flush only.
+ */
+static struct pp2_hif *hif;
+static int hif_users;
+static rte_spinlock_t hif_lock = RTE_SPINLOCK_INITIALIZER;
+
+static int
+mrvl_mempool_hif_get(void)
+{
+	struct pp2_hif_params params;
+	char match[MRVL_MATCH_LEN];
+	int ret = 0;
+
+	rte_spinlock_lock(&hif_lock);
+
+	if (hif_users++)
+		goto out;
+
+	snprintf(match, sizeof(match), "hif-%d", MRVL_MEMPOOL_HIF_ID);
+	memset(&params, 0, sizeof(params));
+	params.match = match;
+	params.out_size = MRVL_MEMPOOL_PUT_BULK;
+	ret = pp2_hif_init(&params, &hif);
+	if (ret) {
+		RTE_LOG(ERR, MEMPOOL, "Failed to initialize hif %d\n",
+			MRVL_MEMPOOL_HIF_ID);
+		hif_users--;
+	}
+out:
+	rte_spinlock_unlock(&hif_lock);
+
+	return ret;
+}
+
+static void
+mrvl_mempool_hif_put(void)
+{
+	rte_spinlock_lock(&hif_lock);
+
+	if (!--hif_users) {
+		pp2_hif_deinit(hif);
+		hif = NULL;
+	}
+
+	rte_spinlock_unlock(&hif_lock);
+}
+
+static int
+mrvl_mempool_alloc(struct rte_mempool *mp)
+{
+	struct pp2_bpool_params params;
+	struct mrvl_mempool *pool;
+	char match[MRVL_MATCH_LEN];
+	unsigned int pp2_id = (uintptr_t)mp->pool_config;
+	int ret, id;
+
+	if (pp2_id >= PP2_NUM_PKT_PROC) {
+		RTE_LOG(ERR, MEMPOOL, "Invalid packet processor %u\n", pp2_id);
+		return -EINVAL;
+	}
+
+	/* BPool buffers are handed to the hardware as mbuf data buffers */
+	if (mp->private_data_size < sizeof(struct rte_pktmbuf_pool_private)) {
+		RTE_LOG(ERR, MEMPOOL, "Mempool %s is not a pktmbuf pool\n",
+			mp->name);
+		return -EINVAL;
+	}
+
+	pool = rte_zmalloc_socket("mrvl_mempool", sizeof(*pool), 0,
+				  mp->socket_id);
+	if (!pool)
+		return -ENOMEM;
+
+	pool->cookie_addr_high = MRVL_COOKIE_ADDR_INVALID;
+	pool->data_offset = sizeof(struct rte_mbuf) +
+			    rte_pktmbuf_priv_size(mp) + RTE_PKTMBUF_HEADROOM;
+
+	ret = mrvl_mempool_hif_get();
+	if (ret)
+		goto out_free_pool;
+
+	rte_spinlock_lock(&hif_lock);
+	id = __builtin_ffs(~used_bpools[pp2_id]) - 1;
+	if (id >= 0 && id < PP2_BPOOL_NUM_POOLS)
+		used_bpools[pp2_id] |= 1 << id;
+	rte_spinlock_unlock(&hif_lock);
+
+	if (id < 0 || id >= PP2_BPOOL_NUM_POOLS) {
+		RTE_LOG(ERR, MEMPOOL, "No free bpool on pp2 %u\n", pp2_id);
+		ret = -ENOSPC;
+		goto out_put_hif;
+	}
+
+	snprintf(match, sizeof(match), "pool-%u:%d", pp2_id, id);
+	memset(&params, 0, sizeof(params));
+	params.match = match;
+	params.buff_len = rte_pktmbuf_data_room_size(mp) -
+			  RTE_PKTMBUF_HEADROOM;
+	ret = pp2_bpool_init(&params, &pool->bpool);
+	if (ret) {
+		RTE_LOG(ERR, MEMPOOL, "Failed to initialize bpool %s\n",
+			match);
+		ret = -EIO;
+		goto out_clear_bpool_bit;
+	}
+
+	mp->pool_data = pool;
+
+	return 0;
+out_clear_bpool_bit:
+	rte_spinlock_lock(&hif_lock);
+	used_bpools[pp2_id] &= ~(1 << id);
+	rte_spinlock_unlock(&hif_lock);
+out_put_hif:
+	mrvl_mempool_hif_put();
+out_free_pool:
+	rte_free(pool);
+
+	return ret;
+}
+
+static void
+mrvl_mempool_free(struct rte_mempool *mp)
+{
+	struct mrvl_mempool *pool = mp->pool_data;
+
+	/* Buffers are owned by the mempool memory, just drop references */
+	rte_spinlock_lock(&hif_lock);
+	used_bpools[pool->bpool->pp2_id] &= ~(1 << pool->bpool->id);
+	rte_spinlock_unlock(&hif_lock);
+
+	pp2_bpool_deinit(pool->bpool);
+	mrvl_mempool_hif_put();
+	rte_free(pool);
+}
+
+static int
+mrvl_mempool_enqueue(struct rte_mempool *mp, void * const *obj_table,
+		     unsigned int n)
+{
+	struct mrvl_mempool *pool = mp->pool_data;
+	struct buff_release_entry entries[MRVL_MEMPOOL_PUT_BULK];
+	unsigned int i;
+
+	rte_spinlock_lock(&hif_lock);
+
+	if (unlikely(pool->cookie_addr_high == MRVL_COOKIE_ADDR_INVALID))
+		pool->cookie_addr_high =
+			(uint64_t)obj_table[0] & MRVL_COOKIE_HIGH_ADDR_MASK;
+
+	/* Either all objects go into the BPool or none of them */
+	for (i = 0; i < n; i++) {
+		void *obj = obj_table[i];
+
+		if (unlikely(rte_mempool_virt2phy(mp, obj) ==
+			     RTE_BAD_PHYS_ADDR ||
+			     ((uint64_t)obj & MRVL_COOKIE_HIGH_ADDR_MASK) !=
+			     pool->cookie_addr_high)) {
+			rte_spinlock_unlock(&hif_lock);
+			RTE_LOG(ERR, MEMPOOL,
+				"Object %p cannot be put into bpool\n", obj);
+			return -ENOBUFS;
+		}
+	}
+
+	i = 0;
+	while (i < n) {
+		uint16_t j, put, num = RTE_MIN(n - i, MRVL_MEMPOOL_PUT_BULK);
+
+		for (j = 0; j < num; j++) {
+			void *obj = obj_table[i + j];
+
+			entries[j].buff.addr = rte_mempool_virt2phy(mp, obj) +
+					       pool->data_offset;
+			entries[j].buff.cookie = (pp2_cookie_t)(uint64_t)obj;
+			entries[j].bpool = pool->bpool;
+		}
+
+		put = num;
+		pp2_bpool_put_buffs(hif, entries, &put);
+		i += put;
+
+		if (unlikely(put != num))
+			break;
+	}
+
+	rte_spinlock_unlock(&hif_lock);
+
+	return i == n ? 0 : -ENOBUFS;
+}
+
+static int
+mrvl_mempool_dequeue(struct rte_mempool *mp, void **obj_table,
+		     unsigned int n)
+{
+	struct mrvl_mempool *pool = mp->pool_data;
+	struct pp2_buff_inf inf;
+	unsigned int i;
+
+	rte_spinlock_lock(&hif_lock);
+
+	for (i = 0; i < n; i++) {
+		if (unlikely(pp2_bpool_get_buff(hif, pool->bpool, &inf)))
+			break;
+
+		obj_table[i] = (void *)(uintptr_t)
+			       (pool->cookie_addr_high | inf.cookie);
+	}
+
+	/* Dequeue is all or nothing, give back what was taken */
+	if (unlikely(i != n)) {
+		while (i--) {
+			inf.addr = rte_mempool_virt2phy(mp, obj_table[i]) +
+				   pool->data_offset;
+			inf.cookie = (pp2_cookie_t)(uint64_t)obj_table[i];
+			pp2_bpool_put_buff(hif, pool->bpool, &inf);
+		}
+
+		rte_spinlock_unlock(&hif_lock);
+
+		return -ENOBUFS;
+	}
+
+	rte_spinlock_unlock(&hif_lock);
+
+	return 0;
+}
+
+static unsigned int
+mrvl_mempool_get_count(const struct rte_mempool *mp)
+{
+	struct mrvl_mempool *pool = mp->pool_data;
+	uint32_t num;
+
+	if (pp2_bpool_get_num_buffs(pool->bpool, &num))
+		return 0;
+
+	return num;
+}
+
+static const struct rte_mempool_ops mrvl_mempool_ops = {
+	.name = MRVL_MEMPOOL_OPS_NAME,
+	.alloc = mrvl_mempool_alloc,
+	.free = mrvl_mempool_free,
+	.enqueue = mrvl_mempool_enqueue,
+	.dequeue = mrvl_mempool_dequeue,
+	.get_count = mrvl_mempool_get_count,
+};
+
+MEMPOOL_REGISTER_OPS(mrvl_mempool_ops);
@@ -0,0 +1,83 @@
+/*
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Semihalf. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Semihalf nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _MRVL_MEMPOOL_H_
+#define _MRVL_MEMPOOL_H_
+
+#include <string.h>
+
+#include <rte_mempool.h>
+
+#include <drivers/mv_pp2_bpool.h>
+
+/** Name of the BPool backed mempool ops. */
+#define MRVL_MEMPOOL_OPS_NAME "mrvl_bpool"
+
+/** Hif used by all BPool backed mempools, PMD uses the lower ones. */
+#define MRVL_MEMPOOL_HIF_ID 8
+
+/** First BPool id available to mempools, PMD uses the lower ones. */
+#define MRVL_MEMPOOL_BPOOL_FIRST 8
+
+/**
+ * Private data of the BPool backed mempool.
+ *
+ * Free objects are kept by the hardware, hence mbufs returned to the
+ * mempool are instantly available to every port using this BPool.
+ */
+struct mrvl_mempool {
+	struct pp2_bpool *bpool;   /**< Backing BPool */
+	uint64_t cookie_addr_high; /**< Upper object address bits */
+	uint32_t data_offset;      /**< Object to packet data offset */
+};
+
+/**
+ * Get BPool backed mempool private data.
+ *
+ * @param mp
+ *   Pointer to the mempool.
+ *
+ * @return
+ *   Pointer to the private data, NULL if mempool is not BPool backed.
+ */
+static inline struct mrvl_mempool *
+mrvl_mempool_get(struct rte_mempool *mp)
+{
+	if (strcmp(rte_mempool_get_ops(mp->ops_index)->name,
+		   MRVL_MEMPOOL_OPS_NAME))
+		return NULL;
+
+	return mp->pool_data;
+}
+
+#endif /* _MRVL_MEMPOOL_H_ */
@@ -145,3 +145,267 @@ static struct rte_mempool_ops ops_stack = {
 };
 
 MEMPOOL_REGISTER_OPS(ops_stack);
+
+#if defined(RTE_ARCH_X86_64) || defined(RTE_ARCH_ARM64)
+
+/*
+ * Lock-free variant of the stack handler.
+ *
+ * The objects are held by a LIFO linked list of elements, and the unused
+ * elements by a second one. Both are updated with a 128-bit compare and
+ * swap of their top pointer and of a modification counter, which makes
+ * the swap fail when the top was popped and pushed back in between (ABA).
+ * The elements are never freed, so a stale element can always be read
+ * while walking a list: the swap then fails and the walk is retried.
+ */
+
+struct lf_stack_elem {
+	void *data;                 /**< object */
+	struct lf_stack_elem *next; /**< next element towards the bottom */
+};
+
+struct lf_stack_head {
+	RTE_STD_C11
+	union {
+		struct {
+			struct lf_stack_elem *top; /**< top of the list */
+			uint64_t cnt;              /**< modification counter */
+		};
+		uint64_t w[2];
+	};
+} __rte_aligned(16);
+
+struct lf_stack_list {
+	struct lf_stack_head head;
+	rte_atomic64_t len;         /**< number of elements in the list */
+};
+
+struct rte_mempool_lf_stack {
+	struct lf_stack_list used __rte_cache_aligned; /**< objects */
+	struct lf_stack_list free __rte_cache_aligned; /**< unused elements */
+	struct lf_stack_elem elems[] __rte_cache_aligned;
+};
+
+/*
+ * Atomically replace *dst by *src if it is equal to *exp. Return 1 on
+ * success, otherwise load the current value of *dst in *exp and return 0.
+ */
+static inline int
+lf_stack_cas(struct lf_stack_head *dst, struct lf_stack_head *exp,
+		const struct lf_stack_head *src)
+{
+#if defined(RTE_ARCH_X86_64)
+	uint8_t res;
+
+	asm volatile (
+			MPLOCKED
+			"cmpxchg16b %[dst];"
+			"sete %[res]"
+			: [dst] "+m" (dst->w),
+			  [res] "=r" (res),
+			  "+a" (exp->w[0]),
+			  "+d" (exp->w[1])
+			: "b" (src->w[0]),
+			  "c" (src->w[1])
+			: "memory");
+
+	return res;
+#else
+	uint64_t old0, old1;
+	uint32_t fail;
+
+	do {
+		asm volatile (
+				"ldaxp %[old0], %[old1], %[dst]"
+				: [old0] "=&r" (old0),
+				  [old1] "=&r" (old1)
+				: [dst] "Q" (dst->w[0])
+				: "memory");
+
+		/* store back the value read on mismatch, so that it is
+		 * known to be read atomically */
+		if (old0 == exp->w[0] && old1 == exp->w[1])
+			asm volatile (
+					"stlxp %w[fail], %[src0], %[src1], %[dst]"
+					: [fail] "=&r" (fail)
+					: [src0] "r" (src->w[0]),
+					  [src1] "r" (src->w[1]),
+					  [dst] "Q" (dst->w[0])
+					: "memory");
+		else
+			asm volatile (
+					"stlxp %w[fail], %[old0], %[old1], %[dst]"
+					: [fail] "=&r" (fail)
+					: [old0] "r" (old0),
+					  [old1] "r" (old1),
+					  [dst] "Q" (dst->w[0])
+					: "memory");
+	} while (unlikely(fail));
+
+	if (old0 == exp->w[0] && old1 == exp->w[1])
+		return 1;
+
+	exp->w[0] = old0;
+	exp->w[1] = old1;
+	return 0;
+#endif
+}
+
+/* push the n elements linked from first to last on top of the list */
+static inline void
+lf_stack_push(struct lf_stack_list *list, struct lf_stack_elem *first,
+		struct lf_stack_elem *last, unsigned n)
+{
+	struct lf_stack_head old_head, new_head;
+
+	old_head = list->head;
+
+	do {
+		last->next = old_head.top;
+		new_head.top = first;
+		new_head.cnt = old_head.cnt + 1;
+	} while (!lf_stack_cas(&list->head, &old_head, &new_head));
+
+	rte_atomic64_add(&list->len, n);
+}
+
+/*
+ * Pop n elements from the top of the list, or none if there are fewer.
+ * Return the first one and the last one in *last, they are still linked.
+ * If obj_table is not NULL, it is filled with the objects of the elements.
+ */
+static inline struct lf_stack_elem *
+lf_stack_pop(struct lf_stack_list *list, unsigned n, void **obj_table,
+		struct lf_stack_elem **last)
+{
+	struct lf_stack_head old_head, new_head;
+	struct lf_stack_elem *tmp;
+	int64_t len;
+	unsigned i;
+
+	/* reserve n elements, so that the walk below finds them */
+	do {
+		len = rte_atomic64_read(&list->len);
+		if (unlikely(len < (int64_t)n))
+			return NULL;
+	} while (!rte_atomic64_cmpset((volatile uint64_t *)&list->len.cnt,
+			len, len - n));
+
+	old_head = list->head;
+
+	do {
+		/* a NULL next pointer means that the list changed while
+		 * walking it: read the head again and retry */
+		rte_smp_rmb();
+		tmp = old_head.top;
+		for (i = 0; i < n && tmp != NULL; i++) {
+			if (obj_table != NULL)
+				obj_table[i] = tmp->data;
+			*last = tmp;
+			tmp = tmp->next;
+		}
+		if (unlikely(i != n)) {
+			old_head = list->head;
+			continue;
+		}
+
+		new_head.top = tmp;
+		new_head.cnt = old_head.cnt + 1;
+		if (lf_stack_cas(&list->head, &old_head, &new_head))
+			break;
+	} while (1);
+
+	return old_head.top;
+}
+
+static int
+lf_stack_alloc(struct rte_mempool *mp)
+{
+	struct rte_mempool_lf_stack *s;
+	unsigned n = mp->size;
+	unsigned i;
+	size_t size = sizeof(*s) + n * sizeof(s->elems[0]);
+
+	/* Allocate our local memory structure */
+	s = rte_zmalloc_socket("mempool-lf-stack",
+			size,
+			RTE_CACHE_LINE_SIZE,
+			mp->socket_id);
+	if (s == NULL) {
+		RTE_LOG(ERR, MEMPOOL, "Cannot allocate lock-free stack!\n");
+		return -ENOMEM;
+	}
+
+	/* all the elements are unused */
+	for (i = 0; i + 1 < n; i++)
+		s->elems[i].next = &s->elems[i + 1];
+	if (n != 0)
+		lf_stack_push(&s->free, &s->elems[0], &s->elems[n - 1], n);
+
+	mp->pool_data = s;
+
+	return 0;
+}
+
+static int
+lf_stack_enqueue(struct rte_mempool *mp, void * const *obj_table,
+		unsigned n)
+{
+	struct rte_mempool_lf_stack *s = mp->pool_data;
+	struct lf_stack_elem *first, *last = NULL, *tmp;
+	unsigned index;
+
+	if (unlikely(n == 0))
+		return 0;
+
+	/* Is there sufficient space in the stack ? */
+	first = lf_stack_pop(&s->free, n, NULL, &last);
+	if (unlikely(first == NULL))
+		return -ENOBUFS;
+
+	/* Add elements back into the stack, the last one on top */
+	for (tmp = first, index = n; index > 0; tmp = tmp->next)
+		tmp->data = obj_table[--index];
+
+	lf_stack_push(&s->used, first, last, n);
+	return 0;
+}
+
+static int
+lf_stack_dequeue(struct rte_mempool *mp, void **obj_table,
+		unsigned n)
+{
+	struct rte_mempool_lf_stack *s = mp->pool_data;
+	struct lf_stack_elem *first, *last = NULL;
+
+	if (unlikely(n == 0))
+		return 0;
+
+	first = lf_stack_pop(&s->used, n, obj_table, &last);
+	if (unlikely(first == NULL))
+		return -ENOENT;
+
+	lf_stack_push(&s->free, first, last, n);
+	return 0;
+}
+
+static unsigned
+lf_stack_get_count(const struct rte_mempool *mp)
+{
+	struct rte_mempool_lf_stack *s = mp->pool_data;
+
+	return rte_atomic64_read(&s->used.len);
+}
+
+static struct rte_mempool_ops ops_lf_stack = {
+	.name = "lf_stack",
+	.alloc = lf_stack_alloc,
+	.free = stack_free,
+	.enqueue = lf_stack_enqueue,
+	.dequeue = lf_stack_dequeue,
+	.get_count = lf_stack_get_count
+};
+
+MEMPOOL_REGISTER_OPS(ops_lf_stack);
+
+#endif /* RTE_ARCH_X86_64 || RTE_ARCH_ARM64 */
@@ -0,0 +1,191 @@
+/*
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Semihalf. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Semihalf nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _MRVL_BPOOL_H_
+#define _MRVL_BPOOL_H_
+
+#include <stdint.h>
+
+#include <rte_atomic.h>
+#include <rte_branch_prediction.h>
+#include <rte_common.h>
+#include <rte_memory.h>
+
+/*
+ * Per-lcore view of a BPool.
+ *
+ * Each lcore accounts only for buffers it has put into or taken from the
+ * BPool, so the fast path never writes to shared cache lines. The sum of
+ * all sizes is the number of buffers in the BPool. Since buffers received on
+ * one lcore are often released on another one, the rebalancer periodically
+ * sets credits so that every receiving lcore sees an even share of the pool.
+ *
+ * Nothing here touches the hardware, the caller moves the buffers and
+ * updates size accordingly.
+ */
+struct mrvl_bpool_lcore {
+	int size;		/* buffers put minus buffers taken */
+	int credit;		/* share correction set by the rebalancer */
+	int min_size;		/* refill watermark */
+	int init_size;		/* refill target */
+	int max_size;		/* trim watermark */
+	rte_atomic32_t rx_active; /* lcore receives from this bpool */
+	uint32_t bursts;	/* number of bursts, drives rebalancing */
+	uint64_t refills;	/* number of refill events */
+	uint64_t trims;		/* number of trim events */
+} __rte_cache_aligned;
+
+/**
+ * Split BPool between receiving lcores.
+ *
+ * Every receiving lcore gets an even share of buffers currently in the BPool
+ * and an even slice of minimum, initial and maximum BPool sizes. Buffers
+ * accounted to lcores which do not receive are handed over to others.
+ * Caller must make sure only one lcore at a time runs it.
+ *
+ * @param lcs Per-lcore views of the BPool.
+ * @param first First lcore to consider.
+ * @param last Last lcore to consider.
+ * @param min_size Minimum BPool size.
+ * @param init_size Initial BPool size.
+ * @param max_size Maximum BPool size.
+ */
+static inline void
+mrvl_bpool_lcores_rebalance(struct mrvl_bpool_lcore *lcs, int first, int last,
+			    int min_size, int init_size, int max_size)
+{
+	int i, share, total = 0, nb_active = 0;
+
+	for (i = first; i <= last; i++) {
+		total += lcs[i].size;
+		nb_active += rte_atomic32_read(&lcs[i].rx_active);
+	}
+
+	if (!nb_active)
+		return;
+
+	share = total / nb_active;
+
+	for (i = first; i <= last; i++) {
+		if (!rte_atomic32_read(&lcs[i].rx_active)) {
+			lcs[i].credit = -lcs[i].size;
+			continue;
+		}
+
+		lcs[i].credit = share - lcs[i].size;
+		lcs[i].min_size = min_size / nb_active;
+		lcs[i].init_size = init_size / nb_active;
+		lcs[i].max_size = max_size / nb_active;
+	}
+}
+
+/**
+ * Mark all lcores as no longer receiving from the BPool.
+ *
+ * @param lcs Per-lcore views of the BPool.
+ * @param first First lcore to consider.
+ * @param last Last lcore to consider.
+ */
+static inline void
+mrvl_bpool_lcores_deactivate(struct mrvl_bpool_lcore *lcs, int first, int last)
+{
+	int i;
+
+	for (i = first; i <= last; i++)
+		rte_atomic32_clear(&lcs[i].rx_active);
+}
+
+/**
+ * Check lcore's slice of the BPool against its watermarks.
+ *
+ * @param lc Calling lcore's view of the BPool.
+ * @param rx_done Number of packets received in the current burst.
+ * @param burst Minimum number of buffers to add at once.
+ * @param budget Maximum number of buffers to add or remove at once.
+ * @return
+ *   Number of buffers to add if positive, number of buffers to remove
+ *   if negative, 0 if slice is within its watermarks.
+ */
+static inline int
+mrvl_bpool_lcore_refill_num(struct mrvl_bpool_lcore *lc, int rx_done,
+			    int burst, int budget)
+{
+	int num = lc->size + lc->credit;
+
+	if (unlikely((num <= lc->min_size) ||
+		     (!rx_done && (num < lc->init_size))))
+		return RTE_MIN(RTE_MAX(lc->init_size - num, burst), budget);
+
+	if (unlikely(num > lc->max_size))
+		return -RTE_MIN(num - lc->init_size, budget);
+
+	return 0;
+}
+
+/**
+ * Check lcore's slice of the BPool after a receive burst.
+ *
+ * The BPool is rebalanced every rebalance_bursts bursts, until the lcore
+ * gets its slice, and when the lcore's share of buffers ran out, which
+ * happens when the buffers it received were released on other lcores.
+ * Rebalancing writes to the views of all lcores, the rebalance callback
+ * must make sure only one lcore at a time runs it.
+ *
+ * @param lc Calling lcore's view of the BPool.
+ * @param rx_done Number of packets received in the current burst.
+ * @param burst Minimum number of buffers to add at once.
+ * @param budget Maximum number of buffers to add or remove at once.
+ * @param rebalance_bursts Rebalancing period in bursts, a power of 2.
+ * @param rebalance Callback rebalancing the BPool.
+ * @param arg Argument passed to the rebalance callback.
+ * @return
+ *   Same as mrvl_bpool_lcore_refill_num(), 0 if lcore has no slice yet.
+ */
+static inline int
+mrvl_bpool_lcore_burst(struct mrvl_bpool_lcore *lc, int rx_done, int burst,
+		       int budget, uint32_t rebalance_bursts,
+		       void (*rebalance)(void *arg), void *arg)
+{
+	if (unlikely(!(lc->bursts++ & (rebalance_bursts - 1)) ||
+		     !lc->max_size || (lc->size + lc->credit <= 0))) {
+		rte_atomic32_set(&lc->rx_active, 1);
+		rebalance(arg);
+		/* Slice was not assigned yet, try again next time. */
+		if (!lc->max_size)
+			return 0;
+	}
+
+	return mrvl_bpool_lcore_refill_num(lc, rx_done, burst, budget);
+}
+
+#endif /* _MRVL_BPOOL_H_ */
@@ -51,13 +51,19 @@
 #include <linux/sockios.h>
 #include <net/if.h>
 #include <net/if_arp.h>
+#include <poll.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
+
+#include <mrvl_mempool.h>
 
 #include "mrvl_ethdev.h"
+#include "mrvl_bpool.h"
 #include "mrvl_qos.h"
+#include "mrvl_flow.h"
 
 /* bitmask with reserved hifs */
 #define MRVL_MUSDK_HIFS_RESERVED 0x0F
@@ -65,8 +71,8 @@
 #define MRVL_MUSDK_BPOOLS_RESERVED 0x07
 /* bitmask with reserved kernel RSS tables */
 #define MRVL_MUSDK_RSS_RESERVED 0x01
-/* maximum number of available hifs */
-#define MRVL_MUSDK_HIFS_MAX 9
+/* maximum number of available hifs, the last one is left to mempools */
+#define MRVL_MUSDK_HIFS_MAX MRVL_MEMPOOL_HIF_ID
 
 /* prefetch shift */
 #define MRVL_MUSDK_PREFETCH_SHIFT 2
@@ -82,13 +88,105 @@
 
 #define MRVL_BURST_SIZE 64
 
+/* Maximum number of buffers added to/removed from bpool at once per lcore */
+#define MRVL_BPOOL_REFILL_BUDGET (MRVL_BURST_SIZE * 4)
+
+/* Number of bursts between bpool rebalancing attempts, must be power of 2 */
+#define MRVL_BPOOL_REBALANCE_BURSTS 1024
+
 #define MRVL_ARP_LENGTH 28
 
+/* Rx interrupt coalescing: raise event on first packet, without delay */
+#define MRVL_RX_INTR_PKT_COAL 1
+#define MRVL_RX_INTR_USEC_COAL 0
+
 #define MRVL_COOKIE_ADDR_INVALID ~0ULL
 
 #define MRVL_COOKIE_HIGH_ADDR_SHIFT	(sizeof(pp2_cookie_t) * 8)
 #define MRVL_COOKIE_HIGH_ADDR_MASK	(~0ULL << MRVL_COOKIE_HIGH_ADDR_SHIFT)
 
+/* Get mbuf pointer out of rx descriptor cookie */
+#define MRVL_DESC_TO_MBUF(desc) \
+	((struct rte_mbuf *)(cookie_addr_high | \
+			     pp2_ppio_inq_desc_get_cookie(desc)))
+
+/* Number of descriptors converted to mbufs at once */
+#define MRVL_RX_VEC_SIZE 4
+
+/* Number of entries in l3/l4 type decoding tables, must be power of 2 */
+#define MRVL_L3_TYPES 8
+#define MRVL_L4_TYPES 8
+
+/* Fixed point shift of software token bucket rate */
+#define MRVL_TB_SHIFT 32
+#define MRVL_TB_FRAC_MASK ((1ULL << MRVL_TB_SHIFT) - 1)
+
+/*
+ * Build mbuf->tx_offload holding l2_len and l3_len only, both truncated to
+ * their bitfield widths (7 and 9 bits) so they never spill into other fields.
+ */
+#define MRVL_TX_OFFLOAD_L2_L3(l2_len, l3_len) \
+	(((uint64_t)(l2_len) & 0x7f) | (((uint64_t)(l3_len) & 0x1ff) << 7))
+
+#define MRVL_XSTATS_TBL_ENTRY(name) { \
+	#name, offsetof(struct pp2_ppio_statistics, name), \
+	sizeof(((struct pp2_ppio_statistics *)0)->name) \
+}
+
+#define MRVL_XSTATS_SET(stats, idx, val) do { \
+	(stats)[idx].id = (idx); \
+	(stats)[idx].value = (val); \
+	(idx)++; \
+} while (0)
+
+/** Port xstats taken directly from MUSDK port statistics */
+struct mrvl_xstats_tbl_entry {
+	const char *name;
+	unsigned int offset;
+	unsigned int size;
+};
+
+static const struct mrvl_xstats_tbl_entry mrvl_xstats_tbl[] = {
+	MRVL_XSTATS_TBL_ENTRY(rx_bytes),
+	MRVL_XSTATS_TBL_ENTRY(rx_packets),
+	MRVL_XSTATS_TBL_ENTRY(rx_unicast_packets),
+	MRVL_XSTATS_TBL_ENTRY(rx_errors),
+	MRVL_XSTATS_TBL_ENTRY(rx_fullq_dropped),
+	MRVL_XSTATS_TBL_ENTRY(rx_bm_dropped),
+	MRVL_XSTATS_TBL_ENTRY(rx_early_dropped),
+	MRVL_XSTATS_TBL_ENTRY(rx_fifo_dropped),
+	MRVL_XSTATS_TBL_ENTRY(rx_cls_dropped),
+	MRVL_XSTATS_TBL_ENTRY(tx_bytes),
+	MRVL_XSTATS_TBL_ENTRY(tx_packets),
+	MRVL_XSTATS_TBL_ENTRY(tx_unicast_packets),
+	MRVL_XSTATS_TBL_ENTRY(tx_errors)
+};
+
+/* Per rx queue xstats, "rx_q<n>_" prefixed */
+static const char * const mrvl_rxq_xstats_names[] = {
+	"packets", "bytes", "drop_mac", "drop_early", "drop_fullq", "drop_bm"
+};
+
+/* Per Traffic Class xstats, "rx_tc<n>_" prefixed */
+static const char * const mrvl_tc_xstats_names[] = {
+	"packets", "bytes", "drops"
+};
+
+/* Per tx queue xstats, "tx_q<n>_" prefixed */
+static const char * const mrvl_txq_xstats_names[] = {
+	"packets", "bytes", "enq_desc", "shadowq_size", "shadowq_full"
+};
+
+/* Port's BPool xstats, "bpool_" prefixed */
+static const char * const mrvl_bpool_xstats_names[] = {
+	"hw_size", "size"
+};
+
+/* Per lcore BPool xstats, "bpool_lcore<n>_" prefixed */
+static const char * const mrvl_lcore_xstats_names[] = {
+	"size", "share", "refills", "trims"
+};
+
 static const char *valid_args[] = {
 	MRVL_IFACE_NAME_ARG,
 	MRVL_CFG_ARG,
@@ -103,7 +201,8 @@ static int used_bpools[PP2_NUM_PKT_PROC] = {
 };
 
 struct pp2_bpool *mrvl_port_to_bpool_lookup[RTE_MAX_ETHPORTS];
-int mrvl_port_bpool_size[PP2_NUM_PKT_PROC][PP2_BPOOL_NUM_POOLS][RTE_MAX_LCORE];
+struct mrvl_bpool_lcore
+mrvl_port_bpool_lcore[PP2_NUM_PKT_PROC][PP2_BPOOL_NUM_POOLS][RTE_MAX_LCORE];
 uint64_t cookie_addr_high = MRVL_COOKIE_ADDR_INVALID;
 
 /*
@@ -116,13 +215,21 @@ uint64_t cookie_addr_high = MRVL_COOKIE_ADDR_INVALID;
  * on condition it originated from interface.
  * In case it  was generated by application itself i.e: mbuf->port field is
  * 0xff then its released to software mempool.
+ *
+ * Packet length is kept aside of the entries (which are handed to MUSDK
+ * as is) so that transmitted bytes can be accounted once hardware reports
+ * completion without touching the mbuf again.
  */
 struct mrvl_shadow_txq {
 	int head;			/* write index - used when sending buffers */
 	int tail;			/* read index - used when releasing buffers */
 	u16 size;			/* queue occupied size */
 	u16 num_to_release;		/* number of buffers sent, that can be released */
+	uint64_t packets_sent;		/* number of completed packets */
+	uint64_t bytes_sent;		/* number of completed bytes */
+	uint64_t drop_full;		/* packets rejected due to lack of room */
 	struct buff_release_entry ent[MRVL_PP2_TX_SHADOWQ_SIZE]; /* queue entries */
+	uint16_t len[MRVL_PP2_TX_SHADOWQ_SIZE]; /* entries packet length */
 };
 
 struct mrvl_rxq;
@@ -134,15 +241,19 @@ struct mrvl_rxq {
 	int queue_id;
 	int port_id;
 	int cksum_enabled;
+	uint64_t rearm_data;		/* mbuf rearm_data template */
 	uint64_t bytes_recv;
 	uint64_t drop_mac;
+	uint64_t desc_recv;		/* descriptors taken from the inq */
+	struct mv_sys_event *event;	/* rx interrupt event */
 };
 
 struct mrvl_txq {
 	struct mrvl_priv *priv;
 	int queue_id;
 	int port_id;
-	uint64_t bytes_sent;
+	int multseg;			/* may get multi-segment mbufs */
+	struct mrvl_shaper shaper;	/* software rate limiter */
 	struct mrvl_shadow_txq shadow_txqs[RTE_MAX_LCORE];
 };
 
@@ -154,9 +265,16 @@ int mrvl_lcore_last;
 int mrvl_dev_num;
 
 static int mrvl_fill_bpool(struct mrvl_rxq *rxq, int num);
+static void mrvl_shaper_setup(struct mrvl_shaper *sh,
+			      const struct rte_pmd_mrvl_rate_limit *rl,
+			      int hw_bytes);
 static inline void mrvl_free_sent_buffers(struct pp2_ppio *ppio,
 			struct pp2_hif *hif, unsigned int core_id,
 			struct mrvl_shadow_txq *sq, int qid, int force);
+static uint16_t mrvl_tx_pkt_burst(void *txq, struct rte_mbuf **tx_pkts,
+				  uint16_t nb_pkts);
+static uint16_t mrvl_tx_sg_pkt_burst(void *txq, struct rte_mbuf **tx_pkts,
+				     uint16_t nb_pkts);
 
 static inline int
 mrvl_get_bpool_size(int	pp2_id, int pool_id)
@@ -165,11 +283,36 @@ mrvl_get_bpool_size(int	pp2_id, int pool_id)
 	int size = 0;
 
 	for (i = mrvl_lcore_first; i <= mrvl_lcore_last; i++)
-		size += mrvl_port_bpool_size[pp2_id][pool_id][i];
+		size += mrvl_port_bpool_lcore[pp2_id][pool_id][i].size;
 
 	return size;
 }
 
+/**
+ * Rebalance BPool slices between lcores.
+ *
+ * Slow path, called every MRVL_BPOOL_REBALANCE_BURSTS bursts by any receiving
+ * lcore. Only one lcore at a time does the work, others simply skip it.
+ *
+ * @param arg Port's private data.
+ */
+static void
+mrvl_bpool_rebalance(void *arg)
+{
+	struct mrvl_priv *priv = arg;
+	struct pp2_bpool *bpool = priv->bpool;
+
+	if (!rte_atomic32_test_and_set(&priv->bpool_rebalance))
+		return;
+
+	mrvl_bpool_lcores_rebalance(
+		mrvl_port_bpool_lcore[bpool->pp2_id][bpool->id],
+		mrvl_lcore_first, mrvl_lcore_last, priv->bpool_min_size,
+		priv->bpool_init_size, priv->bpool_max_size);
+
+	rte_atomic32_clear(&priv->bpool_rebalance);
+}
+
 
 static inline int
 mrvl_reserve_bit(int *bitmap, int max)
@@ -288,6 +431,11 @@ mrvl_dev_configure(struct rte_eth_dev *dev)
 		return -EINVAL;
 	}
 
+	/*
+	 * Hardware stores a frame in a single BPool buffer, rx buffers must
+	 * be large enough to hold the maximum frame (checked on rx queue
+	 * setup).
+	 */
 	if (dev->data->dev_conf.rxmode.enable_scatter) {
 		RTE_LOG(INFO, PMD, "RX Scatter/Gather not supported\n");
 		return -EINVAL;
@@ -307,6 +455,14 @@ mrvl_dev_configure(struct rte_eth_dev *dev)
 	if (ret < 0)
 		return ret;
 
+	ret = mrvl_configure_txqs(priv, dev->data->port_id,
+		dev->data->nb_tx_queues);
+	if (ret < 0)
+		return ret;
+
+	/* Switched to gather variant on tx queue setup if needed */
+	dev->tx_pkt_burst = mrvl_tx_pkt_burst;
+
 
 	priv->ppio_params.outqs_params.num_outqs = dev->data->nb_tx_queues;
 	priv->ppio_params.maintain_stats = 1;
@@ -565,6 +721,108 @@ mrvl_vlan_filter_set(struct rte_eth_dev *dev, uint16_t vlan_id, int on)
 		    pp2_ppio_remove_vlan(priv->ppio, vlan_id);
 }
 
+/**
+ * Set up rx interrupts.
+ *
+ * Each rx queue gets its own MUSDK event whose file descriptor is
+ * exposed through the device interrupt handle so that it can be
+ * waited on with epoll. Events are created disabled.
+ *
+ * @param dev
+ *   Pointer to Ethernet device structure.
+ *
+ * @return
+ *   0 on success, negative error value otherwise.
+ */
+static int
+mrvl_rx_intr_setup(struct rte_eth_dev *dev)
+{
+	struct mrvl_priv *priv = dev->data->dev_private;
+	struct rte_intr_handle *intr_handle = &priv->intr_handle;
+	int i, ret;
+
+	if (dev->data->nb_rx_queues > RTE_MAX_RXTX_INTR_VEC_ID) {
+		RTE_LOG(ERR, PMD, "Too many rx queues for rx interrupts\n");
+		return -EINVAL;
+	}
+
+	intr_handle->intr_vec = rte_zmalloc("intr_vec",
+			dev->data->nb_rx_queues * sizeof(int), 0);
+	if (!intr_handle->intr_vec)
+		return -ENOMEM;
+
+	for (i = 0; i < dev->data->nb_rx_queues; i++) {
+		struct mrvl_rxq *rxq = dev->data->rx_queues[i];
+		struct pp2_ppio_event_params params;
+
+		memset(&params, 0, sizeof(params));
+		params.event_types = PP2_PPIO_EVENT_RX;
+		params.tc_inqs_mask[priv->rxq_map[i].tc] =
+			1 << priv->rxq_map[i].inq;
+		params.pkt_coal = MRVL_RX_INTR_PKT_COAL;
+		params.usec_coal = MRVL_RX_INTR_USEC_COAL;
+
+		ret = pp2_ppio_create_event(priv->ppio, &params, &rxq->event);
+		if (ret) {
+			RTE_LOG(ERR, PMD,
+				"Failed to create rx queue %d event\n", i);
+			goto out_delete;
+		}
+
+		intr_handle->efds[i] = rxq->event->fd;
+		intr_handle->intr_vec[i] = RTE_INTR_VEC_RXTX_OFFSET + i;
+	}
+
+	intr_handle->type = RTE_INTR_HANDLE_EXT;
+	intr_handle->nb_efd = dev->data->nb_rx_queues;
+	intr_handle->max_intr = dev->data->nb_rx_queues + 1;
+
+	return 0;
+out_delete:
+	while (--i >= 0) {
+		struct mrvl_rxq *rxq = dev->data->rx_queues[i];
+
+		pp2_ppio_delete_event(rxq->event);
+		rxq->event = NULL;
+	}
+	rte_free(intr_handle->intr_vec);
+	intr_handle->intr_vec = NULL;
+
+	return -EFAULT;
+}
+
+/**
+ * Release rx interrupts resources.
+ *
+ * @param dev
+ *   Pointer to Ethernet device structure.
+ */
+static void
+mrvl_rx_intr_release(struct rte_eth_dev *dev)
+{
+	struct mrvl_priv *priv = dev->data->dev_private;
+	struct rte_intr_handle *intr_handle = &priv->intr_handle;
+	int i;
+
+	if (!intr_handle->intr_vec)
+		return;
+
+	for (i = 0; i < dev->data->nb_rx_queues; i++) {
+		struct mrvl_rxq *rxq = dev->data->rx_queues[i];
+
+		if (!rxq || !rxq->event)
+			continue;
+
+		pp2_ppio_delete_event(rxq->event);
+		rxq->event = NULL;
+	}
+
+	intr_handle->nb_efd = 0;
+	intr_handle->max_intr = 0;
+	rte_free(intr_handle->intr_vec);
+	intr_handle->intr_vec = NULL;
+}
+
 static int
 mrvl_dev_start(struct rte_eth_dev *dev)
 {
@@ -590,7 +848,7 @@ mrvl_dev_start(struct rte_eth_dev *dev)
 	 * smaller than minimum size add more buffers
 	 */
 	def_init_size = priv->bpool_min_size + MRVL_BURST_SIZE * 2;
-	if (priv->bpool_init_size < def_init_size) {
+	if (!priv->bpool_ext && priv->bpool_init_size < def_init_size) {
 		int buffs_to_add = def_init_size - priv->bpool_init_size;
 
 		priv->bpool_init_size += buffs_to_add;
@@ -609,11 +867,41 @@ mrvl_dev_start(struct rte_eth_dev *dev)
 	priv->bpool_max_size = (priv->nb_rx_queues * MRVL_PP2_RXD_MAX) +
 				priv->bpool_min_size;
 
+	priv->ppio_params.rate_limit_enable =
+		mrvl_rate_limit_params(&priv->rate_limit,
+				       &priv->ppio_params.rate_limit_params);
+	for (i = 0; i < dev->data->nb_tx_queues; i++) {
+		struct pp2_ppio_outq_params *outq =
+			&priv->ppio_params.outqs_params.outqs_params[i];
+
+		outq->rate_limit_enable =
+			mrvl_rate_limit_params(&priv->txq_rate_limit[i],
+					       &outq->rate_limit_params);
+	}
+
+	/* TCs were configured before rx queues had chosen the bpool */
+	for (i = 0; i < priv->ppio_params.inqs_params.num_tcs; i++)
+		priv->ppio_params.inqs_params.tcs_params[i].pools[0] =
+			priv->bpool;
+
 	ret = pp2_ppio_init(&priv->ppio_params, &priv->ppio);
 	if (ret) {
 		RTE_LOG(ERR, PMD, "Failed to init ppio\n");
 		return ret;
 	}
+
+	/* Hardware took bytes limits, software handles the rest */
+	mrvl_shaper_setup(&priv->shaper, &priv->rate_limit,
+			  priv->ppio_params.rate_limit_enable);
+	for (i = 0; i < dev->data->nb_tx_queues; i++) {
+		struct mrvl_txq *txq = dev->data->tx_queues[i];
+
+		if (txq)
+			mrvl_shaper_setup(&txq->shaper,
+					  &priv->txq_rate_limit[i],
+					  priv->ppio_params.outqs_params.
+					  outqs_params[i].rate_limit_enable);
+	}
 	/*
 	 * In case there are some some stale uc/mc mac addresses flush them
 	 * here. It cannot be done during mrvl_dev_close() as port information
@@ -684,15 +972,31 @@ mrvl_dev_start(struct rte_eth_dev *dev)
 		}
 	}
 
+	ret = mrvl_flow_start(dev);
+	if (ret) {
+		RTE_LOG(ERR, PMD, "Failed to apply flows\n");
+		goto out;
+	}
+
+	if (dev->data->dev_conf.intr_conf.rxq) {
+		ret = mrvl_rx_intr_setup(dev);
+		if (ret) {
+			RTE_LOG(ERR, PMD, "Failed to setup rx interrupts\n");
+			goto out;
+		}
+	}
+
 	if (!priv->init_cfg.is_link_down) {
 		ret = mrvl_dev_set_link_up(dev);
 		if (ret) {
 			RTE_LOG(ERR, PMD, "Failed to set link UP\n");
-			goto out;
+			goto out_intr;
 		}
 	}
 
 	return 0;
+out_intr:
+	mrvl_rx_intr_release(dev);
 out:
 	RTE_LOG(ERR, PMD, "Failed to start device\n");
 	pp2_ppio_deinit(priv->ppio);
@@ -740,12 +1044,15 @@ mrvl_flush_tx_shadow_queues(struct rte_eth_dev *dev)
 				while (sq->tail != sq->head) {
 					uint64_t addr = cookie_addr_high |
 						sq->ent[sq->tail].buff.cookie;
-					rte_pktmbuf_free(
+					rte_pktmbuf_free_seg(
 						(struct rte_mbuf *)addr);
 					sq->tail = (sq->tail + 1) &
 						    MRVL_PP2_TX_SHADOWQ_MASK;
 				}
-				memset(sq, 0, sizeof(*sq));
+				sq->head = 0;
+				sq->tail = 0;
+				sq->size = 0;
+				sq->num_to_release = 0;
 			}
 		}
 	}
@@ -760,6 +1067,10 @@ mrvl_flush_bpool(struct rte_eth_dev *dev)
 	int ret;
 	unsigned int core_id = rte_lcore_id();
 
+	/* Buffers of mempool backed bpool belong to the mempool */
+	if (priv->bpool_ext)
+		return;
+
 	if (core_id == LCORE_ID_ANY)
 		core_id = 0;
 
@@ -782,12 +1093,25 @@ mrvl_flush_bpool(struct rte_eth_dev *dev)
 		addr = cookie_addr_high | inf.cookie;
 		rte_pktmbuf_free((struct rte_mbuf *)addr);
 	}
+
+	/* BPool is empty now, so are all lcores' slices. */
+	memset(mrvl_port_bpool_lcore[priv->bpool->pp2_id][priv->bpool->id], 0,
+	       sizeof(mrvl_port_bpool_lcore[0][0]));
 }
 
 static void
 mrvl_dev_stop(struct rte_eth_dev *dev)
 {
+	struct mrvl_priv *priv = dev->data->dev_private;
+
 	mrvl_dev_set_link_down(dev);
+
+	/* Queues are stopped, lcores no longer receive from the bpool. */
+	if (priv->bpool)
+		mrvl_bpool_lcores_deactivate(
+			mrvl_port_bpool_lcore[priv->bpool->pp2_id]
+					     [priv->bpool->id],
+			mrvl_lcore_first, mrvl_lcore_last);
 }
 
 static void
@@ -808,6 +1132,9 @@ mrvl_dev_close(struct rte_eth_dev *dev)
 				tcs_params[i].inqs_params = NULL;
 		}
 
+	mrvl_flow_deinit(priv);
+	mrvl_rx_intr_release(dev);
+
 	if (priv->qos_tbl)
 		pp2_cls_qos_tbl_deinit(priv->qos_tbl);
 
@@ -870,6 +1197,62 @@ mrvl_link_update(struct rte_eth_dev *dev, int wait_to_complete __rte_unused)
 	return 0;
 }
 
+/**
+ * Get number of extended statistics of the port.
+ *
+ * @param dev
+ *   Pointer to Ethernet device structure.
+ * @return
+ *   Number of xstats.
+ */
+static unsigned int
+mrvl_xstats_count(struct rte_eth_dev *dev)
+{
+	struct mrvl_priv *priv = dev->data->dev_private;
+
+	return RTE_DIM(mrvl_xstats_tbl) +
+	       dev->data->nb_rx_queues * RTE_DIM(mrvl_rxq_xstats_names) +
+	       priv->ppio_params.inqs_params.num_tcs *
+			RTE_DIM(mrvl_tc_xstats_names) +
+	       dev->data->nb_tx_queues * RTE_DIM(mrvl_txq_xstats_names) +
+	       RTE_DIM(mrvl_bpool_xstats_names) +
+	       rte_lcore_count() * RTE_DIM(mrvl_lcore_xstats_names);
+}
+
+/**
+ * Sum up tx queue counters kept in per lcore shadow queues.
+ *
+ * @param txq
+ *   Pointer to tx queue structure.
+ * @param packets
+ *   Pointer to number of completed packets.
+ * @param bytes
+ *   Pointer to number of completed bytes.
+ * @param drop_full
+ *   Pointer to number of packets rejected due to full shadow queue
+ *   (may be NULL).
+ */
+static void
+mrvl_txq_sent(struct mrvl_txq *txq, uint64_t *packets, uint64_t *bytes,
+	      uint64_t *drop_full)
+{
+	int i;
+
+	*packets = 0;
+	*bytes = 0;
+	if (drop_full)
+		*drop_full = 0;
+
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		struct mrvl_shadow_txq *sq = &txq->shadow_txqs[i];
+
+		*packets += sq->packets_sent;
+		*bytes += sq->bytes_sent;
+		if (drop_full)
+			*drop_full += sq->drop_full;
+	}
+}
+
 static void
 mrvl_stats_get(struct rte_eth_dev *dev, struct rte_eth_stats *stats)
 {
@@ -915,27 +1298,24 @@ mrvl_stats_get(struct rte_eth_dev *dev, struct rte_eth_stats *stats)
 
 	for (i = 0; i < dev->data->nb_tx_queues; i++) {
 		struct mrvl_txq *txq = dev->data->tx_queues[i];
-		struct pp2_ppio_outq_statistics tx_stats;
+		uint64_t packets_sent, bytes_sent;
 
 		if (!txq)
 			continue;
 
+		mrvl_txq_sent(txq, &packets_sent, &bytes_sent, NULL);
+		stats->opackets += packets_sent;
+		stats->obytes += bytes_sent;
+
 		idx = txq->queue_id;
 		if (unlikely(idx >= RTE_ETHDEV_QUEUE_STAT_CNTRS)) {
 			RTE_LOG(ERR, PMD, "tx queue %d stats out of range (0 - %d)\n",
 				idx, RTE_ETHDEV_QUEUE_STAT_CNTRS - 1);
+			continue;
 		}
 
-		ret = pp2_ppio_outq_get_statistics(priv->ppio, idx, &tx_stats, 0);
-		if (unlikely(ret)) {
-			RTE_LOG(ERR, PMD, "Failed to update tx queue %d stats\n", idx);
-			break;
-		}
-
-		stats->q_opackets[idx] = tx_stats.deq_desc;
-		stats->q_obytes[idx] = txq->bytes_sent;
-		stats->obytes += txq->bytes_sent;
-
+		stats->q_opackets[idx] = packets_sent;
+		stats->q_obytes[idx] = bytes_sent;
 	}
 
 	ret = pp2_ppio_get_statistics(priv->ppio, &ppio_stats, 0);
@@ -945,7 +1325,6 @@ mrvl_stats_get(struct rte_eth_dev *dev, struct rte_eth_stats *stats)
 	}
 
 	stats->ipackets += ppio_stats.rx_packets - drop_mac;
-	stats->opackets += ppio_stats.tx_packets;
 	stats->imissed += ppio_stats.rx_fullq_dropped +
 			  ppio_stats.rx_bm_dropped +
 			  ppio_stats.rx_early_dropped +
@@ -958,7 +1337,7 @@ static void
 mrvl_stats_reset(struct rte_eth_dev *dev)
 {
 	struct mrvl_priv *priv = dev->data->dev_private;
-	int i;
+	int i, j;
 
 	if (!priv->ppio)
 		return;
@@ -970,18 +1349,231 @@ mrvl_stats_reset(struct rte_eth_dev *dev)
 			priv->rxq_map[i].tc, priv->rxq_map[i].inq, NULL, 1);
 		rxq->bytes_recv = 0;
 		rxq->drop_mac = 0;
+		rxq->desc_recv = 0;
 	}
 
 	for (i = 0; i < dev->data->nb_tx_queues; i++) {
 		struct mrvl_txq *txq = dev->data->tx_queues[i];
 
 		pp2_ppio_outq_get_statistics(priv->ppio, i, NULL, 1);
-		txq->bytes_sent = 0;
+		for (j = 0; j < RTE_MAX_LCORE; j++) {
+			txq->shadow_txqs[j].packets_sent = 0;
+			txq->shadow_txqs[j].bytes_sent = 0;
+			txq->shadow_txqs[j].drop_full = 0;
+		}
 	}
 
 	pp2_ppio_get_statistics(priv->ppio, NULL, 1);
 }
 
+/**
+ * DPDK callback to get extended statistics.
+ *
+ * @param dev
+ *   Pointer to Ethernet device structure.
+ * @param stats
+ *   Pointer to xstats table.
+ * @param n
+ *   Number of entries in xstats table.
+ * @return
+ *   Negative value on error, number of read xstats otherwise.
+ */
+static int
+mrvl_xstats_get(struct rte_eth_dev *dev, struct rte_eth_xstat *stats,
+		unsigned int n)
+{
+	struct mrvl_priv *priv = dev->data->dev_private;
+	struct pp2_ppio_statistics ppio_stats;
+	uint64_t vals[RTE_DIM(mrvl_rxq_xstats_names)];
+	uint64_t tc_vals[MRVL_PP2_TC_MAX][RTE_DIM(mrvl_tc_xstats_names)];
+	struct mrvl_bpool_lcore *lcs;
+	unsigned int i, j, count = 0, num = mrvl_xstats_count(dev);
+	uint32_t hw_size;
+	int ret;
+
+	if (n < num)
+		return num;
+
+	/* Port not started yet, report the same table with zeroed values. */
+	if (!priv->ppio) {
+		while (count < num)
+			MRVL_XSTATS_SET(stats, count, 0);
+		return count;
+	}
+
+	ret = pp2_ppio_get_statistics(priv->ppio, &ppio_stats, 0);
+	if (ret)
+		return -EINVAL;
+
+	for (i = 0; i < RTE_DIM(mrvl_xstats_tbl); i++) {
+		uint64_t val;
+
+		if (mrvl_xstats_tbl[i].size == sizeof(uint32_t))
+			val = *(uint32_t *)((uint8_t *)&ppio_stats +
+					    mrvl_xstats_tbl[i].offset);
+		else
+			val = *(uint64_t *)((uint8_t *)&ppio_stats +
+					    mrvl_xstats_tbl[i].offset);
+
+		MRVL_XSTATS_SET(stats, count, val);
+	}
+
+	memset(tc_vals, 0, sizeof(tc_vals));
+
+	for (i = 0; i < dev->data->nb_rx_queues; i++) {
+		struct mrvl_rxq *rxq = dev->data->rx_queues[i];
+		struct pp2_ppio_inq_statistics rx_stats;
+		int tc = priv->rxq_map[i].tc;
+
+		memset(&rx_stats, 0, sizeof(rx_stats));
+		pp2_ppio_inq_get_statistics(priv->ppio, tc,
+				priv->rxq_map[i].inq, &rx_stats, 0);
+
+		vals[0] = rx_stats.enq_desc - (rxq ? rxq->drop_mac : 0);
+		vals[1] = rxq ? rxq->bytes_recv : 0;
+		vals[2] = rxq ? rxq->drop_mac : 0;
+		vals[3] = rx_stats.drop_early;
+		vals[4] = rx_stats.drop_fullq;
+		vals[5] = rx_stats.drop_bm;
+
+		for (j = 0; j < RTE_DIM(mrvl_rxq_xstats_names); j++)
+			MRVL_XSTATS_SET(stats, count, vals[j]);
+
+		if (tc >= MRVL_PP2_TC_MAX)
+			continue;
+
+		tc_vals[tc][0] += vals[0];
+		tc_vals[tc][1] += vals[1];
+		tc_vals[tc][2] += vals[2] + vals[3] + vals[4] + vals[5];
+	}
+
+	for (i = 0; i < priv->ppio_params.inqs_params.num_tcs; i++)
+		for (j = 0; j < RTE_DIM(mrvl_tc_xstats_names); j++)
+			MRVL_XSTATS_SET(stats, count, tc_vals[i][j]);
+
+	for (i = 0; i < dev->data->nb_tx_queues; i++) {
+		struct mrvl_txq *txq = dev->data->tx_queues[i];
+		struct pp2_ppio_outq_statistics tx_stats;
+		uint64_t sq_size = 0, packets = 0, bytes = 0, drop_full = 0;
+
+		memset(&tx_stats, 0, sizeof(tx_stats));
+		pp2_ppio_outq_get_statistics(priv->ppio, i, &tx_stats, 0);
+
+		if (txq) {
+			mrvl_txq_sent(txq, &packets, &bytes, &drop_full);
+			for (j = 0; j < RTE_MAX_LCORE; j++)
+				sq_size += txq->shadow_txqs[j].size;
+		}
+
+		MRVL_XSTATS_SET(stats, count, packets);
+		MRVL_XSTATS_SET(stats, count, bytes);
+		MRVL_XSTATS_SET(stats, count, tx_stats.enq_desc);
+		MRVL_XSTATS_SET(stats, count, sq_size);
+		MRVL_XSTATS_SET(stats, count, drop_full);
+	}
+
+	if (pp2_bpool_get_num_buffs(priv->bpool, &hw_size))
+		hw_size = 0;
+
+	MRVL_XSTATS_SET(stats, count, hw_size);
+	MRVL_XSTATS_SET(stats, count,
+			mrvl_get_bpool_size(priv->bpool->pp2_id,
+					    priv->bpool->id));
+
+	lcs = mrvl_port_bpool_lcore[priv->bpool->pp2_id][priv->bpool->id];
+	RTE_LCORE_FOREACH(i) {
+		MRVL_XSTATS_SET(stats, count, lcs[i].size);
+		MRVL_XSTATS_SET(stats, count, lcs[i].size + lcs[i].credit);
+		MRVL_XSTATS_SET(stats, count, lcs[i].refills);
+		MRVL_XSTATS_SET(stats, count, lcs[i].trims);
+	}
+
+	return count;
+}
+
+/**
+ * DPDK callback to reset extended statistics.
+ *
+ * @param dev
+ *   Pointer to Ethernet device structure.
+ */
+static void
+mrvl_xstats_reset(struct rte_eth_dev *dev)
+{
+	struct mrvl_priv *priv = dev->data->dev_private;
+	struct mrvl_bpool_lcore *lcs;
+	unsigned int i;
+
+	mrvl_stats_reset(dev);
+
+	lcs = mrvl_port_bpool_lcore[priv->bpool->pp2_id][priv->bpool->id];
+	RTE_LCORE_FOREACH(i) {
+		lcs[i].refills = 0;
+		lcs[i].trims = 0;
+	}
+}
+
+/**
+ * DPDK callback to get extended statistics names.
+ *
+ * @param dev
+ *   Pointer to Ethernet device structure.
+ * @param xstats_names
+ *   Pointer to xstats names table.
+ * @param size
+ *   Size of the xstats names table.
+ * @return
+ *   Number of read names.
+ */
+static int
+mrvl_xstats_get_names(struct rte_eth_dev *dev,
+		      struct rte_eth_xstat_name *xstats_names,
+		      unsigned int size)
+{
+	struct mrvl_priv *priv = dev->data->dev_private;
+	unsigned int i, j, count = 0, num = mrvl_xstats_count(dev);
+
+	if (!xstats_names)
+		return num;
+
+	if (size < num)
+		return num;
+
+	for (i = 0; i < RTE_DIM(mrvl_xstats_tbl); i++)
+		snprintf(xstats_names[count++].name, RTE_ETH_XSTATS_NAME_SIZE,
+			 "%s", mrvl_xstats_tbl[i].name);
+
+	for (i = 0; i < dev->data->nb_rx_queues; i++)
+		for (j = 0; j < RTE_DIM(mrvl_rxq_xstats_names); j++)
+			snprintf(xstats_names[count++].name,
+				 RTE_ETH_XSTATS_NAME_SIZE, "rx_q%u_%s",
+				 i, mrvl_rxq_xstats_names[j]);
+
+	for (i = 0; i < priv->ppio_params.inqs_params.num_tcs; i++)
+		for (j = 0; j < RTE_DIM(mrvl_tc_xstats_names); j++)
+			snprintf(xstats_names[count++].name,
+				 RTE_ETH_XSTATS_NAME_SIZE, "rx_tc%u_%s",
+				 i, mrvl_tc_xstats_names[j]);
+
+	for (i = 0; i < dev->data->nb_tx_queues; i++)
+		for (j = 0; j < RTE_DIM(mrvl_txq_xstats_names); j++)
+			snprintf(xstats_names[count++].name,
+				 RTE_ETH_XSTATS_NAME_SIZE, "tx_q%u_%s",
+				 i, mrvl_txq_xstats_names[j]);
+
+	for (j = 0; j < RTE_DIM(mrvl_bpool_xstats_names); j++)
+		snprintf(xstats_names[count++].name, RTE_ETH_XSTATS_NAME_SIZE,
+			 "bpool_%s", mrvl_bpool_xstats_names[j]);
+
+	RTE_LCORE_FOREACH(i)
+		for (j = 0; j < RTE_DIM(mrvl_lcore_xstats_names); j++)
+			snprintf(xstats_names[count++].name,
+				 RTE_ETH_XSTATS_NAME_SIZE, "bpool_lcore%u_%s",
+				 i, mrvl_lcore_xstats_names[j]);
+
+	return count;
+}
+
 static void
 mrvl_dev_infos_get(struct rte_eth_dev *dev __rte_unused,
 		    struct rte_eth_dev_info *info)
@@ -1023,6 +1615,9 @@ mrvl_dev_infos_get(struct rte_eth_dev *dev __rte_unused,
 	/* By default packets are dropped if no descriptors are available */
 	info->default_rxconf.rx_drop_en = 1;
 
+	/* Multi-segment tx is opt-in as it is slower */
+	info->default_txconf.txq_flags = ETH_TXQ_FLAGS_NOMULTSEGS;
+
 	info->max_rx_pktlen = MRVL_PKT_SIZE_MAX;
 }
 
@@ -1108,7 +1703,7 @@ mrvl_fill_bpool(struct mrvl_rxq *rxq, int num)
 	}
 
 	pp2_bpool_put_buffs(hif, entries, (uint16_t *)&i);
-	mrvl_port_bpool_size[bpool->pp2_id][bpool->id][core_id] += i;
+	mrvl_port_bpool_lcore[bpool->pp2_id][bpool->id][core_id].size += i;
 
 	if (i != num)
 		goto out;
@@ -1121,37 +1716,139 @@ mrvl_fill_bpool(struct mrvl_rxq *rxq, int num)
 	return -1;
 }
 
+/**
+ * Prepare per-queue template for mbuf rearm_data.
+ *
+ * @param rxq Pointer to the rx queue.
+ */
+static void
+mrvl_rxq_rearm_setup(struct mrvl_rxq *rxq)
+{
+	struct rte_mbuf mb_def = { .buf_addr = 0 }; /* zeroed mbuf */
+	uintptr_t p;
+
+	mb_def.nb_segs = 1;
+	mb_def.data_off = RTE_PKTMBUF_HEADROOM + MRVL_PKT_EFFEC_OFFS;
+	mb_def.port = rxq->port_id;
+	rte_mbuf_refcnt_set(&mb_def, 1);
+
+	/* prevent compiler reordering: rearm_data covers previous fields */
+	rte_compiler_barrier();
+	p = (uintptr_t)&mb_def.rearm_data;
+	rxq->rearm_data = *(uint64_t *)p;
+}
+
+/**
+ * Select BPool feeding port's rx queues.
+ *
+ * BPool of mrvl mempool is used directly, port's own BPool is released
+ * then. Otherwise own BPool is filled with mbufs taken from the mempool.
+ *
+ * @param priv Pointer to the port's private data.
+ * @param mp Pointer to the rx queue mempool.
+ *
+ * @return 0 on success, negative error value otherwise.
+ */
 static int
-mrvl_rx_queue_setup(struct rte_eth_dev *dev, uint16_t idx, uint16_t desc,
-		    unsigned int socket, const struct rte_eth_rxconf *conf __rte_unused,
-		    struct rte_mempool *mp)
+mrvl_rx_bpool_setup(struct mrvl_priv *priv, struct rte_mempool *mp)
 {
-	struct mrvl_priv *priv = dev->data->dev_private;
-	struct mrvl_rxq *rxq;
-	uint32_t min_size;
-	int ret;
+	struct mrvl_mempool *pool = mrvl_mempool_get(mp);
 
-	if (priv->rxq_map[idx].tc == MRVL_UNKNOWN_TC) {
-		/* Unknown TC mapping, mapping will not have a correct queue. */
-		RTE_LOG(ERR, PMD, "Unknown TC mapping for queue %hu eth%hhu\n",
-				idx, priv->ppio_id);
-		return -EFAULT;
+	if (!pool) {
+		if (priv->bpool_ext) {
+			RTE_LOG(ERR, PMD,
+				"Rx queues must share mempool %s\n",
+				MRVL_MEMPOOL_OPS_NAME);
+			return -EINVAL;
+		}
+
+		return 0;
+	}
+
+	if (priv->bpool_ext) {
+		if (priv->bpool != pool->bpool) {
+			RTE_LOG(ERR, PMD, "Rx queues must share mempool %s\n",
+				MRVL_MEMPOOL_OPS_NAME);
+			return -EINVAL;
+		}
+
+		return 0;
 	}
 
-	min_size = mp->elt_size - sizeof(struct rte_mbuf) -
-		   RTE_PKTMBUF_HEADROOM - MRVL_PKT_EFFEC_OFFS - MV_MH_SIZE;
-	if (min_size > mp->elt_size) {
-		RTE_LOG(ERR, PMD, "Mempool element is to small\n");
+	if (priv->bpool_init_size) {
+		RTE_LOG(ERR, PMD, "Rx queues cannot mix mempool %s with "
+			"other mempools\n", MRVL_MEMPOOL_OPS_NAME);
 		return -EINVAL;
 	}
 
-	if (dev->data->rx_queues[idx]) {
-		rte_free(dev->data->rx_queues[idx]);
-		dev->data->rx_queues[idx] = NULL;
+	if (pool->bpool->pp2_id != priv->pp_id) {
+		RTE_LOG(ERR, PMD, "Mempool %s belongs to pp2 %u, port to %u\n",
+			mp->name, pool->bpool->pp2_id, priv->pp_id);
+		return -EINVAL;
 	}
 
-	rxq = rte_zmalloc_socket("rxq", sizeof(*rxq), 0, socket);
-	if (!rxq)
+	if (pool->cookie_addr_high == MRVL_COOKIE_ADDR_INVALID) {
+		RTE_LOG(ERR, PMD, "Mempool %s is empty\n", mp->name);
+		return -EINVAL;
+	}
+
+	if (cookie_addr_high == MRVL_COOKIE_ADDR_INVALID)
+		cookie_addr_high = pool->cookie_addr_high;
+
+	if (cookie_addr_high != pool->cookie_addr_high) {
+		RTE_LOG(ERR, PMD, "Mempool %s virtual addr high 0x%lx out of "
+			"range\n", mp->name, pool->cookie_addr_high >> 32);
+		return -EINVAL;
+	}
+
+	pp2_bpool_deinit(priv->bpool);
+	used_bpools[priv->pp_id] &= ~(1 << priv->bpool_bit);
+	priv->bpool = pool->bpool;
+	priv->bpool_ext = 1;
+
+	return 0;
+}
+
+static int
+mrvl_rx_queue_setup(struct rte_eth_dev *dev, uint16_t idx, uint16_t desc,
+		    unsigned int socket, const struct rte_eth_rxconf *conf __rte_unused,
+		    struct rte_mempool *mp)
+{
+	struct mrvl_priv *priv = dev->data->dev_private;
+	struct mrvl_rxq *rxq;
+	uint32_t buf_size, max_rx_pkt_len;
+	int ret;
+
+	if (priv->rxq_map[idx].tc == MRVL_UNKNOWN_TC) {
+		/* Unknown TC mapping, mapping will not have a correct queue. */
+		RTE_LOG(ERR, PMD, "Unknown TC mapping for queue %hu eth%hhu\n",
+				idx, priv->ppio_id);
+		return -EFAULT;
+	}
+
+	buf_size = rte_pktmbuf_data_room_size(mp);
+	max_rx_pkt_len = dev->data->dev_conf.rxmode.jumbo_frame ?
+			 dev->data->dev_conf.rxmode.max_rx_pkt_len :
+			 ETHER_MAX_LEN;
+	if (buf_size < RTE_PKTMBUF_HEADROOM + MRVL_PKT_EFFEC_OFFS +
+		       max_rx_pkt_len) {
+		RTE_LOG(ERR, PMD,
+			"Mbuf data room (%u) too small for %u bytes frames\n",
+			buf_size, max_rx_pkt_len);
+		return -EINVAL;
+	}
+
+	ret = mrvl_rx_bpool_setup(priv, mp);
+	if (ret)
+		return ret;
+
+	if (dev->data->rx_queues[idx]) {
+		rte_free(dev->data->rx_queues[idx]);
+		dev->data->rx_queues[idx] = NULL;
+	}
+
+	rxq = rte_zmalloc_socket("rxq", sizeof(*rxq), 0, socket);
+	if (!rxq)
 		return -ENOMEM;
 
 	rxq->priv = priv;
@@ -1159,19 +1856,22 @@ mrvl_rx_queue_setup(struct rte_eth_dev *dev, uint16_t idx, uint16_t desc,
 	rxq->cksum_enabled = dev->data->dev_conf.rxmode.hw_ip_checksum;
 	rxq->queue_id = idx;
 	rxq->port_id = dev->data->port_id;
+	mrvl_rxq_rearm_setup(rxq);
 	mrvl_port_to_bpool_lookup[rxq->port_id] = priv->bpool;
 
 	priv->ppio_params.inqs_params.
 		tcs_params[priv->rxq_map[rxq->queue_id].tc].
 		inqs_params[priv->rxq_map[rxq->queue_id].inq].size = desc;
 
-	ret = mrvl_fill_bpool(rxq, desc);
-	if (ret) {
-		rte_free(rxq);
-		return ret;
-	}
+	if (!priv->bpool_ext) {
+		ret = mrvl_fill_bpool(rxq, desc);
+		if (ret) {
+			rte_free(rxq);
+			return ret;
+		}
 
-	priv->bpool_init_size += desc;
+		priv->bpool_init_size += desc;
+	}
 
 	dev->data->rx_queues[idx] = rxq;
 
@@ -1194,6 +1894,9 @@ mrvl_rx_queue_release(void *rxq)
 	if (!q || !hif)
 		return;
 
+	if (q->priv->bpool_ext)
+		goto out;
+
 	num = q->priv->ppio_params.inqs_params.
 			tcs_params[q->priv->rxq_map[q->queue_id].tc].
 			inqs_params[q->priv->rxq_map[q->queue_id].inq].size;
@@ -1205,16 +1908,17 @@ mrvl_rx_queue_release(void *rxq)
 		addr = cookie_addr_high | inf.cookie;
 		rte_pktmbuf_free((struct rte_mbuf *)addr);
 	}
-
+out:
 	rte_free(q);
 }
 
 static int
 mrvl_tx_queue_setup(struct rte_eth_dev *dev, uint16_t idx, uint16_t desc,
-		    unsigned int socket, const struct rte_eth_txconf *conf __rte_unused)
+		    unsigned int socket, const struct rte_eth_txconf *conf)
 {
 	struct mrvl_priv *priv = dev->data->dev_private;
 	struct mrvl_txq *txq;
+	int i;
 
 	if (dev->data->tx_queues[idx]) {
 		rte_free(dev->data->tx_queues[idx]);
@@ -1228,10 +1932,21 @@ mrvl_tx_queue_setup(struct rte_eth_dev *dev, uint16_t idx, uint16_t desc,
 	txq->priv = priv;
 	txq->queue_id = idx;
 	txq->port_id = dev->data->port_id;
+	txq->multseg = !(conf->txq_flags & ETH_TXQ_FLAGS_NOMULTSEGS);
 	dev->data->tx_queues[idx] = txq;
 
+	/* Single tx function is used per port, gather if any queue needs it */
+	dev->tx_pkt_burst = mrvl_tx_pkt_burst;
+	for (i = 0; i < dev->data->nb_tx_queues; i++) {
+		struct mrvl_txq *q = dev->data->tx_queues[i];
+
+		if (q && q->multseg) {
+			dev->tx_pkt_burst = mrvl_tx_sg_pkt_burst;
+			break;
+		}
+	}
+
 	priv->ppio_params.outqs_params.outqs_params[idx].size = desc;
-	priv->ppio_params.outqs_params.outqs_params[idx].weight = 1;
 
 	return 0;
 }
@@ -1275,6 +1990,226 @@ mrvl_rss_hash_conf_get(struct rte_eth_dev *dev, struct rte_eth_rss_conf *rss_con
 	return 0;
 }
 
+/**
+ * DPDK callback to enable rx queue interrupt.
+ *
+ * Pending notification is consumed first, so that a subsequent epoll
+ * wait blocks until new packets arrive.
+ *
+ * @param dev
+ *   Pointer to Ethernet device structure.
+ * @param rx_queue_id
+ *   Rx queue index.
+ *
+ * @return
+ *   0 on success, negative error value otherwise.
+ */
+static int
+mrvl_rx_queue_intr_enable(struct rte_eth_dev *dev, uint16_t rx_queue_id)
+{
+	struct mrvl_rxq *rxq = dev->data->rx_queues[rx_queue_id];
+	struct pollfd pfd;
+	uint32_t count;
+
+	if (!rxq || !rxq->event)
+		return -EINVAL;
+
+	pfd.fd = rxq->event->fd;
+	pfd.events = POLLIN;
+	while (poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN))
+		if (read(pfd.fd, &count, sizeof(count)) <= 0)
+			break;
+
+	return pp2_ppio_set_event(rxq->event, 1);
+}
+
+/**
+ * DPDK callback to disable rx queue interrupt.
+ *
+ * @param dev
+ *   Pointer to Ethernet device structure.
+ * @param rx_queue_id
+ *   Rx queue index.
+ *
+ * @return
+ *   0 on success, negative error value otherwise.
+ */
+static int
+mrvl_rx_queue_intr_disable(struct rte_eth_dev *dev, uint16_t rx_queue_id)
+{
+	struct mrvl_rxq *rxq = dev->data->rx_queues[rx_queue_id];
+
+	if (!rxq || !rxq->event)
+		return -EINVAL;
+
+	return pp2_ppio_set_event(rxq->event, 0);
+}
+
+/**
+ * Get number of descriptors waiting in rx queue.
+ *
+ * Hardware does not expose inq fill level, hence it is derived from
+ * number of descriptors enqueued by the hardware and taken by the driver.
+ *
+ * @param rxq
+ *   Pointer to rx queue structure.
+ *
+ * @return
+ *   Number of used descriptors.
+ */
+static uint32_t
+mrvl_rxq_used(struct mrvl_rxq *rxq)
+{
+	struct mrvl_priv *priv = rxq->priv;
+	struct pp2_ppio_inq_statistics rx_stats;
+	uint8_t tc = priv->rxq_map[rxq->queue_id].tc;
+	uint8_t inq = priv->rxq_map[rxq->queue_id].inq;
+	uint32_t size;
+	int64_t used;
+
+	if (!priv->ppio)
+		return 0;
+
+	if (pp2_ppio_inq_get_statistics(priv->ppio, tc, inq, &rx_stats, 0))
+		return 0;
+
+	/* Counters are not reset atomically with respect to each other. */
+	used = (int64_t)(rx_stats.enq_desc - rxq->desc_recv);
+	size = priv->ppio_params.inqs_params.tcs_params[tc].
+		inqs_params[inq].size;
+
+	return RTE_MIN((uint64_t)RTE_MAX(used, 0), size);
+}
+
+/**
+ * DPDK callback to get number of used rx descriptors.
+ *
+ * @param dev
+ *   Pointer to Ethernet device structure.
+ * @param rx_queue_id
+ *   Rx queue index.
+ *
+ * @return
+ *   Number of used descriptors.
+ */
+static uint32_t
+mrvl_rx_queue_count(struct rte_eth_dev *dev, uint16_t rx_queue_id)
+{
+	struct mrvl_rxq *rxq = dev->data->rx_queues[rx_queue_id];
+
+	if (!rxq)
+		return 0;
+
+	return mrvl_rxq_used(rxq);
+}
+
+/**
+ * DPDK callback to check the status of a rx descriptor.
+ *
+ * @param rx_queue
+ *   Pointer to rx queue structure.
+ * @param offset
+ *   Offset of the descriptor, relative to the next one to be received.
+ *
+ * @return
+ *   Descriptor status on success, negative error value otherwise.
+ */
+static int
+mrvl_rx_descriptor_status(void *rx_queue, uint16_t offset)
+{
+	struct mrvl_rxq *rxq = rx_queue;
+	struct mrvl_priv *priv = rxq->priv;
+	uint8_t tc = priv->rxq_map[rxq->queue_id].tc;
+	uint8_t inq = priv->rxq_map[rxq->queue_id].inq;
+
+	if (offset >= priv->ppio_params.inqs_params.tcs_params[tc].
+			inqs_params[inq].size)
+		return -EINVAL;
+
+	/* Buffers come from the BPool, free slots are always available. */
+	if (offset < mrvl_rxq_used(rxq))
+		return RTE_ETH_RX_DESC_DONE;
+
+	return RTE_ETH_RX_DESC_AVAIL;
+}
+
+/**
+ * DPDK callback to check the status of a tx descriptor.
+ *
+ * Occupancy is taken from the hardware outq. Descriptors of sent packets
+ * whose buffers still wait in lcores' shadow queues are reported as done,
+ * as the hardware may reuse them already. Shadow queues occupancy is
+ * available through tx_q<n>_shadowq_size xstats.
+ *
+ * @param tx_queue
+ *   Pointer to tx queue structure.
+ * @param offset
+ *   Offset of the descriptor, relative to the last one handed to hardware.
+ *
+ * @return
+ *   Descriptor status on success, negative error value otherwise.
+ */
+static int
+mrvl_tx_descriptor_status(void *tx_queue, uint16_t offset)
+{
+	struct mrvl_txq *txq = tx_queue;
+	struct mrvl_priv *priv = txq->priv;
+	struct pp2_ppio_outq_statistics tx_stats;
+	int64_t used;
+
+	if (offset >= priv->ppio_params.outqs_params.
+			outqs_params[txq->queue_id].size)
+		return -EINVAL;
+
+	if (!priv->ppio)
+		return RTE_ETH_TX_DESC_DONE;
+
+	if (pp2_ppio_outq_get_statistics(priv->ppio, txq->queue_id,
+					 &tx_stats, 0))
+		return -EIO;
+
+	used = (int64_t)(tx_stats.enq_desc - tx_stats.deq_desc);
+	if (offset < used)
+		return RTE_ETH_TX_DESC_FULL;
+
+	return RTE_ETH_TX_DESC_DONE;
+}
+
+/**
+ * DPDK callback to manage filters.
+ *
+ * Only generic flow API is supported.
+ *
+ * @param dev
+ *   Pointer to Ethernet device structure.
+ * @param filter_type
+ *   Filter type.
+ * @param filter_op
+ *   Operation to perform.
+ * @param arg
+ *   Pointer to operation-specific structure.
+ *
+ * @return
+ *   0 on success, negative error value otherwise.
+ */
+static int
+mrvl_eth_filter_ctrl(struct rte_eth_dev *dev __rte_unused,
+		     enum rte_filter_type filter_type,
+		     enum rte_filter_op filter_op, void *arg)
+{
+	switch (filter_type) {
+	case RTE_ETH_FILTER_GENERIC:
+		if (filter_op != RTE_ETH_FILTER_GET)
+			return -EINVAL;
+		*(const void **)arg = &mrvl_flow_ops;
+		return 0;
+	default:
+		RTE_LOG(WARNING, PMD, "Filter type (%d) not supported\n",
+			filter_type);
+		return -EINVAL;
+	}
+}
+
 static const struct eth_dev_ops mrvl_ops = {
 	.dev_configure = mrvl_dev_configure,
 	.dev_start = mrvl_dev_start,
@@ -1293,6 +2228,9 @@ static const struct eth_dev_ops mrvl_ops = {
 	.mtu_set = mrvl_mtu_set,
 	.stats_get = mrvl_stats_get,
 	.stats_reset = mrvl_stats_reset,
+	.xstats_get = mrvl_xstats_get,
+	.xstats_reset = mrvl_xstats_reset,
+	.xstats_get_names = mrvl_xstats_get_names,
 	.dev_infos_get = mrvl_dev_infos_get,
 	.dev_supported_ptypes_get = mrvl_dev_supported_ptypes_get,
 	.rxq_info_get = mrvl_rxq_info_get,
@@ -1304,6 +2242,38 @@ static const struct eth_dev_ops mrvl_ops = {
 	.tx_queue_release = mrvl_tx_queue_release,
 	.rss_hash_update = mrvl_rss_hash_update,
 	.rss_hash_conf_get = mrvl_rss_hash_conf_get,
+	.filter_ctrl = mrvl_eth_filter_ctrl,
+	.rx_queue_intr_enable = mrvl_rx_queue_intr_enable,
+	.rx_queue_intr_disable = mrvl_rx_queue_intr_disable,
+	.rx_queue_count = mrvl_rx_queue_count,
+	.rx_descriptor_status = mrvl_rx_descriptor_status,
+	.tx_descriptor_status = mrvl_tx_descriptor_status,
+};
+
+/*
+ * Descriptor decoding tables, indexed by l3/l4 type reported by the
+ * parser. Unknown types map to no extra ptype bits.
+ */
+static const uint32_t mrvl_l3_ptype[MRVL_L3_TYPES] = {
+	[PP2_INQ_L3_TYPE_IPV4_NO_OPTS] = RTE_PTYPE_L3_IPV4,
+	[PP2_INQ_L3_TYPE_IPV4_OK] = RTE_PTYPE_L3_IPV4_EXT,
+	[PP2_INQ_L3_TYPE_IPV4_TTL_ZERO] = RTE_PTYPE_L3_IPV4_EXT_UNKNOWN,
+	[PP2_INQ_L3_TYPE_IPV6_NO_EXT] = RTE_PTYPE_L3_IPV6,
+	[PP2_INQ_L3_TYPE_IPV6_EXT] = RTE_PTYPE_L3_IPV6_EXT,
+	[PP2_INQ_L3_TYPE_ARP] = RTE_PTYPE_L2_ETHER_ARP,
+};
+
+static const uint32_t mrvl_l4_ptype[MRVL_L4_TYPES] = {
+	[PP2_INQ_L4_TYPE_TCP] = RTE_PTYPE_L4_TCP,
+	[PP2_INQ_L4_TYPE_UDP] = RTE_PTYPE_L4_UDP,
+};
+
+/* Indexed by (l4 checksum error << 1) | l3 checksum error */
+static const uint64_t mrvl_cksum_ol_flags[4] = {
+	PKT_RX_IP_CKSUM_GOOD | PKT_RX_L4_CKSUM_GOOD,
+	PKT_RX_IP_CKSUM_BAD | PKT_RX_L4_CKSUM_GOOD,
+	PKT_RX_IP_CKSUM_GOOD | PKT_RX_L4_CKSUM_BAD,
+	PKT_RX_IP_CKSUM_BAD | PKT_RX_L4_CKSUM_BAD,
 };
 
 static inline uint32_t
@@ -1312,74 +2282,189 @@ mrvl_desc_to_packet_type_and_offset(struct pp2_ppio_desc *desc,
 {
 	enum pp2_inq_l3_type l3_type;
 	enum pp2_inq_l4_type l4_type;
-	uint64_t packet_type;
 
 	pp2_ppio_inq_desc_get_l3_info(desc, &l3_type, l3_offset);
 	pp2_ppio_inq_desc_get_l4_info(desc, &l4_type, l4_offset);
 
-	packet_type = RTE_PTYPE_L2_ETHER;
-
-	switch (l3_type) {
-	case PP2_INQ_L3_TYPE_IPV4_NO_OPTS:
-		packet_type |= RTE_PTYPE_L3_IPV4;
-		break;
-	case PP2_INQ_L3_TYPE_IPV4_OK:
-		packet_type |= RTE_PTYPE_L3_IPV4_EXT;
-		break;
-	case PP2_INQ_L3_TYPE_IPV4_TTL_ZERO:
-		packet_type |= RTE_PTYPE_L3_IPV4_EXT_UNKNOWN;
-		break;
-	case PP2_INQ_L3_TYPE_IPV6_NO_EXT:
-		packet_type |= RTE_PTYPE_L3_IPV6;
-		break;
-	case PP2_INQ_L3_TYPE_IPV6_EXT:
-		packet_type |= RTE_PTYPE_L3_IPV6_EXT;
-		break;
-	case PP2_INQ_L3_TYPE_ARP:
-		packet_type |= RTE_PTYPE_L2_ETHER_ARP;
-		/*
-		 * In case of ARP l4_offset is set to wrong value.
-		 * Set it to proper one so that later on mbuf->l3_len can be
-		 * calculated subtracting l4_offset and l3_offset.
-		 */
+	/*
+	 * In case of ARP l4_offset is set to wrong value.
+	 * Set it to proper one so that later on mbuf->l3_len can be
+	 * calculated subtracting l4_offset and l3_offset.
+	 */
+	if (unlikely(l3_type == PP2_INQ_L3_TYPE_ARP))
 		*l4_offset = *l3_offset + MRVL_ARP_LENGTH;
-		break;
-	default:
-		RTE_LOG(DEBUG, PMD, "Failed to recognise l3 packet type\n");
-		break;
+
+	return RTE_PTYPE_L2_ETHER |
+	       mrvl_l3_ptype[l3_type & (MRVL_L3_TYPES - 1)] |
+	       mrvl_l4_ptype[l4_type & (MRVL_L4_TYPES - 1)];
+}
+
+static inline uint64_t
+mrvl_desc_to_ol_flags(struct pp2_ppio_desc *desc)
+{
+	int idx;
+
+	idx = pp2_ppio_inq_desc_get_l3_pkt_error(desc) != PP2_DESC_ERR_OK;
+	idx |= (pp2_ppio_inq_desc_get_l4_pkt_error(desc) != PP2_DESC_ERR_OK) << 1;
+
+	return mrvl_cksum_ol_flags[idx];
+}
+
+/**
+ * Fill in mbuf fields from rx descriptor.
+ *
+ * Instead of resetting the mbuf and setting its fields one by one,
+ * rearm_data part is written at once using per-queue template. Fields not
+ * covered here (next, vlan_tci etc.) are already valid as buffers are
+ * always put into the BPool in their freed state.
+ *
+ * @param q Pointer to the rx queue.
+ * @param desc Pointer to the rx descriptor.
+ * @param mbuf Pointer to the mbuf described by desc.
+ */
+static inline void
+mrvl_desc_to_mbuf(struct mrvl_rxq *q, struct pp2_ppio_desc *desc,
+		  struct rte_mbuf *mbuf)
+{
+	uint8_t l3_offset, l4_offset;
+	uintptr_t p = (uintptr_t)&mbuf->rearm_data;
+
+	*(uint64_t *)p = q->rearm_data;
+	mbuf->packet_type = mrvl_desc_to_packet_type_and_offset(desc,
+			&l3_offset, &l4_offset);
+	mbuf->pkt_len = pp2_ppio_inq_desc_get_pkt_len(desc);
+	mbuf->data_len = mbuf->pkt_len;
+	mbuf->tx_offload = MRVL_TX_OFFLOAD_L2_L3(l3_offset,
+						 l4_offset - l3_offset);
+	mbuf->ol_flags = likely(q->cksum_enabled) ?
+			 mrvl_desc_to_ol_flags(desc) : 0;
+}
+
+/**
+ * Fill in MRVL_RX_VEC_SIZE mbufs at once.
+ *
+ * Descriptors are decoded in a first pass and mbufs are written in a second
+ * one. This way loads from descriptors are not serialized with stores to
+ * (possibly not yet cached) mbufs.
+ *
+ * @param q Pointer to the rx queue.
+ * @param descs Pointer to MRVL_RX_VEC_SIZE rx descriptors.
+ * @param mbufs Pointer to MRVL_RX_VEC_SIZE mbufs described by descs.
+ * @returns Number of bytes received.
+ */
+static inline uint64_t
+mrvl_desc_to_mbuf_vec(struct mrvl_rxq *q, struct pp2_ppio_desc *descs,
+		      struct rte_mbuf **mbufs)
+{
+	uint32_t ptype[MRVL_RX_VEC_SIZE];
+	uint16_t len[MRVL_RX_VEC_SIZE];
+	uint64_t tx_offload[MRVL_RX_VEC_SIZE];
+	uint64_t ol_flags[MRVL_RX_VEC_SIZE] = { 0 };
+	uint64_t bytes = 0;
+	uint8_t l3_offset, l4_offset;
+	uintptr_t p;
+	int i;
+
+	for (i = 0; i < MRVL_RX_VEC_SIZE; i++) {
+		ptype[i] = mrvl_desc_to_packet_type_and_offset(&descs[i],
+				&l3_offset, &l4_offset);
+		tx_offload[i] = MRVL_TX_OFFLOAD_L2_L3(l3_offset,
+						      l4_offset - l3_offset);
+		len[i] = pp2_ppio_inq_desc_get_pkt_len(&descs[i]);
+		bytes += len[i];
 	}
 
-	switch (l4_type) {
-	case PP2_INQ_L4_TYPE_TCP:
-		packet_type |= RTE_PTYPE_L4_TCP;
-		break;
-	case PP2_INQ_L4_TYPE_UDP:
-		packet_type |= RTE_PTYPE_L4_UDP;
-		break;
-	default:
-		RTE_LOG(DEBUG, PMD, "Failed to recognise l4 packet type\n");
-		break;
+	if (likely(q->cksum_enabled))
+		for (i = 0; i < MRVL_RX_VEC_SIZE; i++)
+			ol_flags[i] = mrvl_desc_to_ol_flags(&descs[i]);
+
+	for (i = 0; i < MRVL_RX_VEC_SIZE; i++) {
+		p = (uintptr_t)&mbufs[i]->rearm_data;
+		*(uint64_t *)p = q->rearm_data;
+		mbufs[i]->packet_type = ptype[i];
+		mbufs[i]->pkt_len = len[i];
+		mbufs[i]->data_len = len[i];
+		mbufs[i]->tx_offload = tx_offload[i];
+		mbufs[i]->ol_flags = ol_flags[i];
 	}
 
-	return packet_type;
+	return bytes;
 }
 
-static inline uint64_t
-mrvl_desc_to_ol_flags(struct pp2_ppio_desc *desc)
+/**
+ * Return buffer of a broken packet back to the BPool.
+ *
+ * @param q Pointer to the rx queue.
+ * @param hif Pointer to the lcore's hif.
+ * @param core_id Id of the calling lcore.
+ * @param mbuf Pointer to the mbuf to be dropped.
+ */
+static inline void
+mrvl_rx_drop(struct mrvl_rxq *q, struct pp2_hif *hif, unsigned int core_id,
+	     struct rte_mbuf *mbuf)
 {
-	uint64_t flags;
+	struct pp2_bpool *bpool = q->priv->bpool;
+	struct pp2_buff_inf binf = {
+		.addr = rte_mbuf_data_dma_addr_default(mbuf),
+		.cookie = (pp2_cookie_t)(uint64_t)mbuf,
+	};
 
-	if (unlikely(pp2_ppio_inq_desc_get_l3_pkt_error(desc) != PP2_DESC_ERR_OK))
-		flags = PKT_RX_IP_CKSUM_BAD;
-	else
-		flags = PKT_RX_IP_CKSUM_GOOD;
+	pp2_bpool_put_buff(hif, bpool, &binf);
+	mrvl_port_bpool_lcore[bpool->pp2_id][bpool->id][core_id].size++;
+	q->drop_mac++;
+}
 
-	if (unlikely(pp2_ppio_inq_desc_get_l4_pkt_error(desc) != PP2_DESC_ERR_OK))
-		flags |= PKT_RX_L4_CKSUM_BAD;
-	else
-		flags |= PKT_RX_L4_CKSUM_GOOD;
+/**
+ * Keep lcore's slice of the BPool between its watermarks.
+ *
+ * Apart from the occasional rebalancing, which is serialized, only the
+ * calling lcore's accounting is modified, hence no locking is needed here.
+ *
+ * @param q Pointer to the rx queue.
+ * @param hif Pointer to the lcore's hif.
+ * @param core_id Id of the calling lcore.
+ * @param rx_done Number of packets received in the current burst.
+ */
+static inline void
+mrvl_bpool_refill(struct mrvl_rxq *q, struct pp2_hif *hif,
+		  unsigned int core_id, int rx_done)
+{
+	struct pp2_bpool *bpool = q->priv->bpool;
+	struct mrvl_bpool_lcore *lc =
+		&mrvl_port_bpool_lcore[bpool->pp2_id][bpool->id][core_id];
+	int i, num, ret;
+
+	num = mrvl_bpool_lcore_burst(lc, rx_done, MRVL_BURST_SIZE,
+				     MRVL_BPOOL_REFILL_BUDGET,
+				     MRVL_BPOOL_REBALANCE_BURSTS,
+				     mrvl_bpool_rebalance, q->priv);
+	if (unlikely(num > 0)) {
+		ret = mrvl_fill_bpool(q, num);
+		if (ret)
+			RTE_LOG(ERR, PMD, "Failed to fill bpool\n");
+		lc->refills++;
+	} else if (unlikely(num < 0)) {
+		int pkt_to_remove = -num;
+		struct rte_mbuf *mbuf;
+		struct pp2_buff_inf buff;
 
-	return flags;
+		RTE_LOG(DEBUG, PMD, "\nport-%d:%d: bpool %d oversize -"
+			" remove %d buffers (lcore %u share: %d -> %d)\n",
+			bpool->pp2_id, q->priv->ppio->port_id,
+			bpool->id, pkt_to_remove, core_id,
+			lc->size + lc->credit, lc->init_size);
+
+		for (i = 0; i < pkt_to_remove; i++) {
+			ret = pp2_bpool_get_buff(hif, bpool, &buff);
+			if (ret)
+				break;
+			mbuf = (struct rte_mbuf *)
+				(cookie_addr_high | buff.cookie);
+			rte_pktmbuf_free(mbuf);
+		}
+		lc->size -= i;
+		lc->trims++;
+	}
 }
 
 static uint16_t
@@ -1389,7 +2474,6 @@ mrvl_rx_pkt_burst(void *rxq, struct rte_mbuf **rx_pkts, uint16_t nb_pkts)
 	struct pp2_ppio_desc descs[nb_pkts];
 	struct pp2_bpool *bpool;
 	int i, ret, rx_done = 0;
-	int num;
 	struct pp2_hif *hif;
 	unsigned int core_id = rte_lcore_id();
 
@@ -1409,92 +2493,71 @@ mrvl_rx_pkt_burst(void *rxq, struct rte_mbuf **rx_pkts, uint16_t nb_pkts)
 		RTE_LOG(ERR, PMD, "Failed to receive packets\n");
 		return 0;
 	}
-	mrvl_port_bpool_size[bpool->pp2_id][bpool->id][core_id] -= nb_pkts;
+	mrvl_port_bpool_lcore[bpool->pp2_id][bpool->id][core_id].size -= nb_pkts;
+	q->desc_recv += nb_pkts;
 
-	for (i = 0; i < nb_pkts; i++) {
-		struct rte_mbuf *mbuf;
-		uint8_t l3_offset, l4_offset;
-		uint64_t addr;
+	for (i = 0; i + MRVL_RX_VEC_SIZE <= nb_pkts; i += MRVL_RX_VEC_SIZE) {
+		struct rte_mbuf **mbufs = &rx_pkts[rx_done];
+		int j, err = 0;
 
-		if (likely((nb_pkts - i) > MRVL_MUSDK_PREFETCH_SHIFT)) {
-			struct pp2_ppio_desc *pref_desc;
-			u64 pref_addr;
-
-			pref_desc = &descs[i + MRVL_MUSDK_PREFETCH_SHIFT];
-			pref_addr =
-				cookie_addr_high | pp2_ppio_inq_desc_get_cookie(pref_desc);
-			rte_mbuf_prefetch_part1((struct rte_mbuf *)(pref_addr));
-			rte_mbuf_prefetch_part2((struct rte_mbuf *)(pref_addr));
-		}
+		if (likely(nb_pkts - i > MRVL_RX_VEC_SIZE))
+			for (j = i + MRVL_RX_VEC_SIZE;
+			     j < RTE_MIN(i + 2 * MRVL_RX_VEC_SIZE, nb_pkts);
+			     j++) {
+				struct rte_mbuf *pref =
+					MRVL_DESC_TO_MBUF(&descs[j]);
 
-		addr = cookie_addr_high | pp2_ppio_inq_desc_get_cookie(&descs[i]);
-		mbuf = (struct rte_mbuf *)addr;
-		rte_pktmbuf_reset(mbuf);
+				rte_mbuf_prefetch_part1(pref);
+				rte_mbuf_prefetch_part2(pref);
+			}
 
-		/* drop packet in case of mac, overrun or resource error */
-		if (unlikely(pp2_ppio_inq_desc_get_l2_pkt_error(&descs[i]) != PP2_DESC_ERR_OK)) {
-			struct pp2_buff_inf binf = {
-				.addr = rte_mbuf_data_dma_addr_default(mbuf),
-				.cookie = (pp2_cookie_t)(uint64_t)mbuf,
-			};
-
-			pp2_bpool_put_buff(hif, bpool, &binf);
-			mrvl_port_bpool_size
-				[bpool->pp2_id][bpool->id][core_id]++;
-			q->drop_mac++;
+		for (j = 0; j < MRVL_RX_VEC_SIZE; j++) {
+			mbufs[j] = MRVL_DESC_TO_MBUF(&descs[i + j]);
+			err |= pp2_ppio_inq_desc_get_l2_pkt_error(
+					&descs[i + j]) != PP2_DESC_ERR_OK;
+		}
+
+		if (likely(!err)) {
+			q->bytes_recv += mrvl_desc_to_mbuf_vec(q, &descs[i],
+							       mbufs);
+			rx_done += MRVL_RX_VEC_SIZE;
 			continue;
 		}
 
-		mbuf->data_off += MRVL_PKT_EFFEC_OFFS;
-		mbuf->pkt_len = pp2_ppio_inq_desc_get_pkt_len(&descs[i]);
-		mbuf->data_len = mbuf->pkt_len;
-		mbuf->port = q->port_id;
-		mbuf->packet_type = mrvl_desc_to_packet_type_and_offset(&descs[i],
-				&l3_offset, &l4_offset);
-		mbuf->l2_len = l3_offset;
-		mbuf->l3_len = l4_offset - l3_offset;
+		/* drop packet in case of mac, overrun or resource error */
+		for (j = 0; j < MRVL_RX_VEC_SIZE; j++) {
+			struct rte_mbuf *mbuf = mbufs[j];
 
-		if (likely(q->cksum_enabled))
-			mbuf->ol_flags = mrvl_desc_to_ol_flags(&descs[i]);
+			if (unlikely(pp2_ppio_inq_desc_get_l2_pkt_error(
+					&descs[i + j]) != PP2_DESC_ERR_OK)) {
+				mrvl_rx_drop(q, hif, core_id, mbuf);
+				continue;
+			}
 
-		rx_pkts[rx_done++] = mbuf;
-		q->bytes_recv += mbuf->pkt_len;
+			mrvl_desc_to_mbuf(q, &descs[i + j], mbuf);
+			rx_pkts[rx_done++] = mbuf;
+			q->bytes_recv += mbuf->pkt_len;
+		}
 	}
 
-	if (rte_spinlock_trylock(&q->priv->lock) == 1) {
-		num = mrvl_get_bpool_size(bpool->pp2_id, bpool->id);
+	for (; i < nb_pkts; i++) {
+		struct rte_mbuf *mbuf = MRVL_DESC_TO_MBUF(&descs[i]);
 
-		if (unlikely((num <= q->priv->bpool_min_size) ||
-			 (!rx_done && (num < q->priv->bpool_init_size)))) {
-			ret = mrvl_fill_bpool(q, MRVL_BURST_SIZE);
-			if (ret)
-				RTE_LOG(ERR, PMD, "Failed to fill bpool\n");
-		} else if (unlikely(num > q->priv->bpool_max_size)) {
-			int i;
-			int pkt_to_remove = num - q->priv->bpool_init_size;
-			struct rte_mbuf *mbuf;
-			struct pp2_buff_inf buff;
-
-			RTE_LOG(DEBUG, PMD, "\nport-%d:%d: bpool %d oversize -"
-				" remove %d buffers (pool size: %d -> %d)\n",
-				bpool->pp2_id, q->priv->ppio->port_id,
-				bpool->id, pkt_to_remove, num,
-				q->priv->bpool_init_size);
-
-			for (i = 0; i < pkt_to_remove; i++) {
-				ret = pp2_bpool_get_buff(hif, bpool, &buff);
-				if (ret)
-					break;
-				mbuf = (struct rte_mbuf *)
-					(cookie_addr_high | buff.cookie);
-				rte_pktmbuf_free(mbuf);
-			}
-			mrvl_port_bpool_size
-				[bpool->pp2_id][bpool->id][core_id] -= i;
+		/* drop packet in case of mac, overrun or resource error */
+		if (unlikely(pp2_ppio_inq_desc_get_l2_pkt_error(&descs[i]) !=
+			     PP2_DESC_ERR_OK)) {
+			mrvl_rx_drop(q, hif, core_id, mbuf);
+			continue;
 		}
-		rte_spinlock_unlock(&q->priv->lock);
+
+		mrvl_desc_to_mbuf(q, &descs[i], mbuf);
+		rx_pkts[rx_done++] = mbuf;
+		q->bytes_recv += mbuf->pkt_len;
 	}
 
+	if (likely(!q->priv->bpool_ext))
+		mrvl_bpool_refill(q, hif, core_id, rx_done);
+
 	return rx_done;
 }
 
@@ -1538,6 +2601,297 @@ mrvl_prepare_proto_info(uint64_t ol_flags, uint32_t packet_type,
 	return 0;
 }
 
+/**
+ * Add tokens accumulated since the last refill.
+ *
+ * Fraction of a token is carried over by not advancing the timestamp
+ * past the time it was earned.
+ *
+ * @param tb
+ *   Pointer to the token bucket.
+ * @param now
+ *   Current timer cycles.
+ */
+static inline void
+mrvl_tb_refill(struct mrvl_tb *tb, uint64_t now)
+{
+	uint64_t delta = now - tb->tsc, credit;
+
+	if (unlikely(delta >= tb->max_delta)) {
+		tb->tokens = tb->size;
+		tb->tsc = now;
+		return;
+	}
+
+	credit = delta * tb->rate;
+	tb->tokens = RTE_MIN(tb->tokens + (credit >> MRVL_TB_SHIFT), tb->size);
+	tb->tsc = now - (credit & MRVL_TB_FRAC_MASK) / tb->rate;
+}
+
+/**
+ * Set up token bucket.
+ *
+ * @param tb
+ *   Pointer to the token bucket.
+ * @param size
+ *   Bucket size, 0 disables the bucket.
+ * @param rate
+ *   Tokens per second.
+ */
+static void
+mrvl_tb_setup(struct mrvl_tb *tb, uint64_t size, uint64_t rate)
+{
+	tb->size = size;
+	tb->tokens = size;
+	tb->tsc = rte_get_timer_cycles();
+
+	if (!size || !rate) {
+		tb->size = 0;
+		return;
+	}
+
+	/* Keep the fixed point rate from overflowing, far above line rate */
+	rate = RTE_MIN(rate, UINT64_MAX >> MRVL_TB_SHIFT);
+	tb->rate = RTE_MAX((rate << MRVL_TB_SHIFT) / rte_get_timer_hz(), 1ULL);
+	tb->max_delta = UINT64_MAX / tb->rate;
+}
+
+/**
+ * Set up software shaper.
+ *
+ * @param sh
+ *   Pointer to the shaper.
+ * @param rl
+ *   Rate limit to enforce.
+ * @param hw_bytes
+ *   Bytes limit is enforced by the hardware.
+ */
+static void
+mrvl_shaper_setup(struct mrvl_shaper *sh,
+		  const struct rte_pmd_mrvl_rate_limit *rl, int hw_bytes)
+{
+	rte_spinlock_lock(&sh->lock);
+
+	mrvl_tb_setup(&sh->pkts, (uint64_t)rl->max_burst_kfps * 1000,
+		      (uint64_t)rl->max_throughput_kfps * 1000);
+	mrvl_tb_setup(&sh->bytes,
+		      hw_bytes ? 0 : (uint64_t)rl->max_burst_mbps * 125000,
+		      (uint64_t)rl->max_throughput_mbps * 125000);
+	rte_atomic32_set(&sh->enabled, sh->pkts.size || sh->bytes.size);
+
+	rte_spinlock_unlock(&sh->lock);
+}
+
+/**
+ * Take tokens for as many leading packets as the shaper lets through.
+ *
+ * @param sh
+ *   Pointer to the shaper.
+ * @param pkts
+ *   Packets to transmit.
+ * @param nb_pkts
+ *   Number of packets in array.
+ *
+ * @return
+ *   Number of packets allowed to be sent.
+ */
+static inline uint16_t
+mrvl_shaper_take(struct mrvl_shaper *sh, struct rte_mbuf **pkts,
+		 uint16_t nb_pkts)
+{
+	uint64_t now;
+	uint16_t i;
+
+	if (!rte_atomic32_read(&sh->enabled))
+		return nb_pkts;
+
+	now = rte_get_timer_cycles();
+
+	rte_spinlock_lock(&sh->lock);
+
+	if (sh->pkts.size) {
+		mrvl_tb_refill(&sh->pkts, now);
+		nb_pkts = RTE_MIN(nb_pkts, sh->pkts.tokens);
+		sh->pkts.tokens -= nb_pkts;
+	}
+
+	if (sh->bytes.size) {
+		mrvl_tb_refill(&sh->bytes, now);
+		for (i = 0; i < nb_pkts; i++) {
+			uint32_t len = rte_pktmbuf_pkt_len(pkts[i]);
+
+			if (len > sh->bytes.tokens)
+				break;
+			sh->bytes.tokens -= len;
+		}
+
+		if (sh->pkts.size)
+			sh->pkts.tokens += nb_pkts - i;
+		nb_pkts = i;
+	}
+
+	rte_spinlock_unlock(&sh->lock);
+
+	return nb_pkts;
+}
+
+/**
+ * Give back tokens of packets which were not sent.
+ *
+ * @param sh
+ *   Pointer to the shaper.
+ * @param pkts
+ *   Packets which were not sent.
+ * @param nb_pkts
+ *   Number of packets in array.
+ */
+static inline void
+mrvl_shaper_give(struct mrvl_shaper *sh, struct rte_mbuf **pkts,
+		 uint16_t nb_pkts)
+{
+	uint64_t bytes = 0;
+	uint16_t i;
+
+	if (!rte_atomic32_read(&sh->enabled))
+		return;
+
+	for (i = 0; i < nb_pkts; i++)
+		bytes += rte_pktmbuf_pkt_len(pkts[i]);
+
+	rte_spinlock_lock(&sh->lock);
+
+	if (sh->pkts.size)
+		sh->pkts.tokens = RTE_MIN(sh->pkts.tokens + nb_pkts,
+					  sh->pkts.size);
+	if (sh->bytes.size)
+		sh->bytes.tokens = RTE_MIN(sh->bytes.tokens + bytes,
+					   sh->bytes.size);
+
+	rte_spinlock_unlock(&sh->lock);
+}
+
+/**
+ * Limit burst to packets both tx queue's and port's shapers let through.
+ *
+ * @param q
+ *   Pointer to the tx queue.
+ * @param pkts
+ *   Packets to transmit.
+ * @param nb_pkts
+ *   Number of packets in array.
+ *
+ * @return
+ *   Number of packets allowed to be sent.
+ */
+static inline uint16_t
+mrvl_tx_shape(struct mrvl_txq *q, struct rte_mbuf **pkts, uint16_t nb_pkts)
+{
+	uint16_t num = mrvl_shaper_take(&q->shaper, pkts, nb_pkts);
+	uint16_t allowed = mrvl_shaper_take(&q->priv->shaper, pkts, num);
+
+	mrvl_shaper_give(&q->shaper, pkts + allowed, num - allowed);
+
+	return allowed;
+}
+
+/**
+ * Give back tokens of shaped packets which were not sent.
+ *
+ * @param q
+ *   Pointer to the tx queue.
+ * @param pkts
+ *   Packets which were not sent.
+ * @param nb_pkts
+ *   Number of packets in array.
+ */
+static inline void
+mrvl_tx_unshape(struct mrvl_txq *q, struct rte_mbuf **pkts, uint16_t nb_pkts)
+{
+	mrvl_shaper_give(&q->shaper, pkts, nb_pkts);
+	mrvl_shaper_give(&q->priv->shaper, pkts, nb_pkts);
+}
+
+/**
+ * Put a buffer into the shadow queue.
+ *
+ * Buffers that originated from some port and are not shared are
+ * released back to that port's BPool once sent, others go back to
+ * their mempool.
+ *
+ * @param sq
+ *   Pointer to the shadow queue.
+ * @param buf
+ *   Pointer to the mbuf (or segment) to be sent.
+ * @param len
+ *   Packet length to account on completion (0 if not last segment).
+ */
+static inline void
+mrvl_fill_shadowq(struct mrvl_shadow_txq *sq, struct rte_mbuf *buf,
+		  uint16_t len)
+{
+	sq->ent[sq->head].buff.cookie = (pp2_cookie_t)(uint64_t)buf;
+	sq->ent[sq->head].buff.addr = rte_mbuf_data_dma_addr_default(buf);
+	sq->ent[sq->head].bpool =
+		(unlikely(buf->port == 0xff || buf->refcnt > 1 ||
+			  RTE_MBUF_INDIRECT(buf))) ?
+		 NULL : mrvl_port_to_bpool_lookup[buf->port];
+	sq->len[sq->head] = len;
+	sq->head = (sq->head + 1) & MRVL_PP2_TX_SHADOWQ_MASK;
+	sq->size++;
+}
+
+/**
+ * Set up tx descriptor for a single buffer.
+ *
+ * @param desc
+ *   Pointer to the descriptor.
+ * @param buf
+ *   Pointer to the mbuf (or segment).
+ * @param len
+ *   Length of data in the buffer.
+ */
+static inline void
+mrvl_fill_desc(struct pp2_ppio_desc *desc, struct rte_mbuf *buf,
+	       uint16_t len)
+{
+	pp2_ppio_outq_desc_reset(desc);
+	pp2_ppio_outq_desc_set_phys_addr(desc, rte_pktmbuf_mtophys(buf));
+	pp2_ppio_outq_desc_set_pkt_offset(desc, 0);
+	pp2_ppio_outq_desc_set_pkt_len(desc, len);
+}
+
+/**
+ * Set up checksum offload information of the packet's first descriptor.
+ *
+ * @param desc
+ *   Pointer to the descriptor.
+ * @param mbuf
+ *   Pointer to the packet.
+ */
+static inline void
+mrvl_fill_desc_proto_info(struct pp2_ppio_desc *desc, struct rte_mbuf *mbuf)
+{
+	int gen_l3_cksum, gen_l4_cksum;
+	enum pp2_outq_l3_type l3_type;
+	enum pp2_outq_l4_type l4_type;
+	int ret;
+
+	/*
+	 * in case unsupported ol_flags were passed
+	 * do not update descriptor offload information
+	 */
+	ret = mrvl_prepare_proto_info(mbuf->ol_flags, mbuf->packet_type,
+				      &l3_type, &l4_type, &gen_l3_cksum,
+				      &gen_l4_cksum);
+	if (unlikely(ret))
+		return;
+
+	pp2_ppio_outq_desc_set_proto_info(desc, l3_type, l4_type,
+					  mbuf->l2_len,
+					  mbuf->l2_len + mbuf->l3_len,
+					  gen_l3_cksum, gen_l4_cksum);
+}
+
 static inline void
 mrvl_free_sent_buffers(struct pp2_ppio *ppio, struct pp2_hif *hif,
 		       unsigned int core_id, struct mrvl_shadow_txq *sq,
@@ -1568,18 +2922,34 @@ mrvl_free_sent_buffers(struct pp2_ppio *ppio, struct pp2_hif *hif,
 			goto skip;
 		}
 
+		if (likely(sq->len[sq->tail + num])) {
+			sq->packets_sent++;
+			sq->bytes_sent += sq->len[sq->tail + num];
+		} else if (entry->bpool) {
+			struct rte_mbuf *mbuf;
+
+			/*
+			 * Not the last segment of a packet. Rx hands out
+			 * BPool buffers as single segment mbufs, unchain it.
+			 */
+			mbuf = (struct rte_mbuf *)
+			       (cookie_addr_high | entry->buff.cookie);
+			mbuf->next = NULL;
+			mbuf->nb_segs = 1;
+		}
+
 		if (unlikely(!entry->bpool)) {
 			struct rte_mbuf *mbuf;
 
 			mbuf = (struct rte_mbuf *)
 			       (cookie_addr_high | entry->buff.cookie);
-			rte_pktmbuf_free(mbuf);
+			rte_pktmbuf_free_seg(mbuf);
 			skip_bufs = 1;
 			goto skip;
 		}
 
-		mrvl_port_bpool_size
-			[entry->bpool->pp2_id][entry->bpool->id][core_id]++;
+		mrvl_port_bpool_lcore
+			[entry->bpool->pp2_id][entry->bpool->id][core_id].size++;
 		num++;
 		if (unlikely(sq->tail + num == MRVL_PP2_TX_SHADOWQ_SIZE))
 			goto skip;
@@ -1609,9 +2979,8 @@ mrvl_tx_pkt_burst(void *txq, struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
 	struct pp2_hif *hif;
 	struct pp2_ppio_desc descs[nb_pkts];
 	unsigned int core_id = rte_lcore_id();
-	int i, ret, bytes_sent = 0;
-	uint16_t num, sq_free_size;
-	uint64_t addr;
+	int i;
+	uint16_t num, sq_free_size, shaped = 0;
 
 	hif = mrvl_get_hif(q->priv, core_id);
 	sq = &q->shadow_txqs[core_id];
@@ -1623,20 +2992,22 @@ mrvl_tx_pkt_burst(void *txq, struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
 		mrvl_free_sent_buffers(q->priv->ppio, hif, core_id,
 				       sq, q->queue_id, 0);
 
+	if (unlikely(rte_atomic32_read(&q->shaper.enabled) ||
+		     rte_atomic32_read(&q->priv->shaper.enabled)))
+		shaped = nb_pkts = mrvl_tx_shape(q, tx_pkts, nb_pkts);
+
 	sq_free_size = MRVL_PP2_TX_SHADOWQ_SIZE - sq->size - 1;
 	if (unlikely(nb_pkts > sq_free_size)) {
 		RTE_LOG(DEBUG, PMD,
 			"No room in shadow queue for %d packets!!!"
 			"%d packets will be sent.\n",
 			nb_pkts, sq_free_size);
+		sq->drop_full += nb_pkts - sq_free_size;
 		nb_pkts = sq_free_size;
 	}
 
 	for (i = 0; i < nb_pkts; i++) {
 		struct rte_mbuf *mbuf = tx_pkts[i];
-		int gen_l3_cksum, gen_l4_cksum;
-		enum pp2_outq_l3_type l3_type;
-		enum pp2_outq_l4_type l4_type;
 
 		if (likely((nb_pkts - i) > MRVL_MUSDK_PREFETCH_SHIFT)) {
 			struct rte_mbuf *pref_pkt_hdr;
@@ -1646,36 +3017,9 @@ mrvl_tx_pkt_burst(void *txq, struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
 			rte_mbuf_prefetch_part2(pref_pkt_hdr);
 		}
 
-		sq->ent[sq->head].buff.cookie = (pp2_cookie_t)(uint64_t)mbuf;
-		sq->ent[sq->head].buff.addr = rte_mbuf_data_dma_addr_default(mbuf);
-		sq->ent[sq->head].bpool =
-			(unlikely(mbuf->port == 0xff || mbuf->refcnt > 1)) ?
-			 NULL : mrvl_port_to_bpool_lookup[mbuf->port];
-		sq->head = (sq->head + 1) & MRVL_PP2_TX_SHADOWQ_MASK;
-		sq->size++;
-
-		pp2_ppio_outq_desc_reset(&descs[i]);
-		pp2_ppio_outq_desc_set_phys_addr(&descs[i],
-						 rte_pktmbuf_mtophys(mbuf));
-		pp2_ppio_outq_desc_set_pkt_offset(&descs[i], 0);
-		pp2_ppio_outq_desc_set_pkt_len(&descs[i],
-					       rte_pktmbuf_pkt_len(mbuf));
-
-		bytes_sent += rte_pktmbuf_pkt_len(mbuf);
-		/*
-		 * in case unsupported ol_flags were passed
-		 * do not update descriptor offload information
-		 */
-		ret = mrvl_prepare_proto_info(mbuf->ol_flags, mbuf->packet_type,
-					      &l3_type, &l4_type, &gen_l3_cksum,
-					      &gen_l4_cksum);
-		if (unlikely(ret))
-			continue;
-
-		pp2_ppio_outq_desc_set_proto_info(&descs[i], l3_type, l4_type,
-						  mbuf->l2_len,
-						  mbuf->l2_len + mbuf->l3_len,
-						  gen_l3_cksum, gen_l4_cksum);
+		mrvl_fill_shadowq(sq, mbuf, rte_pktmbuf_pkt_len(mbuf));
+		mrvl_fill_desc(&descs[i], mbuf, rte_pktmbuf_pkt_len(mbuf));
+		mrvl_fill_desc_proto_info(&descs[i], mbuf);
 	}
 
 	num = nb_pkts;
@@ -1683,32 +3027,123 @@ mrvl_tx_pkt_burst(void *txq, struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
 			    descs, &nb_pkts);
 	/* number of packets that were not sent */
 	if (unlikely(num > nb_pkts)) {
-		for (i = nb_pkts; i < num; i++) {
-			sq->head = (MRVL_PP2_TX_SHADOWQ_SIZE + sq->head - 1) &
-			    	   MRVL_PP2_TX_SHADOWQ_MASK;
-			addr = cookie_addr_high | sq->ent[sq->head].buff.cookie;
-			bytes_sent -= rte_pktmbuf_pkt_len((struct rte_mbuf *)addr);
-		}
+		sq->head = (MRVL_PP2_TX_SHADOWQ_SIZE + sq->head -
+			    (num - nb_pkts)) & MRVL_PP2_TX_SHADOWQ_MASK;
 		sq->size -= num - nb_pkts;
 	}
 
-	/*
-	 * TODO
-	 * Counting bytes that were actually sent should be done inside
-	 * loop that iterates over shadow-q.
-	 *
-	 * This is not done this way currently as time that passes between
-	 * enqueuing packet (pp2_ppio_send) and checking whether it was
-	 * sent (pp2_ppio_get_num_outq_done) is shorter that time needed to
-	 * push out a packet.
-	 *
-	 * Thus calling pp2_ppio_get_num_outq_done will return number of
-	 * packet previously sent which means statistics will not be
-	 * entirely up to date and some tests will fail.
-	 *
-	 * Perhaps MUSDK can count transmitted bytes?
-	 */
-	q->bytes_sent += bytes_sent;
+	if (unlikely(shaped > nb_pkts))
+		mrvl_tx_unshape(q, tx_pkts + nb_pkts, shaped - nb_pkts);
+
+	return nb_pkts;
+}
+
+/**
+ * DPDK callback for multi-segment transmit.
+ *
+ * Every segment occupies a descriptor and a shadow queue entry, so that
+ * it can be released independently once sent. Packet length is recorded
+ * in the entry of the last segment only, hence packet is accounted once.
+ *
+ * @param txq
+ *   Generic pointer transmit queue.
+ * @param tx_pkts
+ *   Packets to transmit.
+ * @param nb_pkts
+ *   Number of packets in array.
+ *
+ * @return
+ *   Number of packets successfully transmitted.
+ */
+static uint16_t
+mrvl_tx_sg_pkt_burst(void *txq, struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
+{
+	struct mrvl_txq *q = txq;
+	struct mrvl_shadow_txq *sq;
+	struct pp2_hif *hif;
+	struct pp2_ppio_desc descs[nb_pkts * PP2_PPIO_DESC_NUM_FRAGS];
+	struct pp2_ppio_sg_pkts pkts;
+	uint8_t frags[nb_pkts];
+	unsigned int core_id = rte_lcore_id();
+	int i, j;
+	uint16_t num, sq_free_size, total_descs = 0, shaped = 0;
+
+	hif = mrvl_get_hif(q->priv, core_id);
+	sq = &q->shadow_txqs[core_id];
+
+	if (unlikely(!q->priv->ppio || !hif))
+		return 0;
+
+	if (sq->size)
+		mrvl_free_sent_buffers(q->priv->ppio, hif, core_id,
+				       sq, q->queue_id, 0);
+
+	if (unlikely(rte_atomic32_read(&q->shaper.enabled) ||
+		     rte_atomic32_read(&q->priv->shaper.enabled)))
+		shaped = nb_pkts = mrvl_tx_shape(q, tx_pkts, nb_pkts);
+
+	sq_free_size = MRVL_PP2_TX_SHADOWQ_SIZE - sq->size - 1;
+
+	for (i = 0; i < nb_pkts; i++) {
+		struct rte_mbuf *mbuf = tx_pkts[i], *seg;
+		int nb_segs = mbuf->nb_segs;
+
+		if (likely((nb_pkts - i) > MRVL_MUSDK_PREFETCH_SHIFT)) {
+			struct rte_mbuf *pref_pkt_hdr;
+
+			pref_pkt_hdr = tx_pkts[i + MRVL_MUSDK_PREFETCH_SHIFT];
+			rte_mbuf_prefetch_part1(pref_pkt_hdr);
+			rte_mbuf_prefetch_part2(pref_pkt_hdr);
+		}
+
+		if (unlikely(nb_segs > PP2_PPIO_DESC_NUM_FRAGS)) {
+			RTE_LOG(DEBUG, PMD,
+				"Too many segments (%d) in packet\n", nb_segs);
+			break;
+		}
+
+		if (unlikely(total_descs + nb_segs > sq_free_size)) {
+			RTE_LOG(DEBUG, PMD,
+				"No room in shadow queue for %d packets!!!"
+				"%d packets will be sent.\n",
+				nb_pkts, i);
+			sq->drop_full += nb_pkts - i;
+			break;
+		}
+
+		for (j = 0, seg = mbuf; j < nb_segs - 1; j++) {
+			mrvl_fill_shadowq(sq, seg, 0);
+			mrvl_fill_desc(&descs[total_descs + j], seg,
+				       rte_pktmbuf_data_len(seg));
+			seg = seg->next;
+		}
+
+		mrvl_fill_shadowq(sq, seg, rte_pktmbuf_pkt_len(mbuf));
+		mrvl_fill_desc(&descs[total_descs + j], seg,
+			       rte_pktmbuf_data_len(seg));
+
+		mrvl_fill_desc_proto_info(&descs[total_descs], mbuf);
+
+		frags[i] = nb_segs;
+		total_descs += nb_segs;
+	}
+
+	nb_pkts = i;
+	pkts.frags = frags;
+	pkts.num = nb_pkts;
+	num = total_descs;
+	pp2_ppio_send_sg(q->priv->ppio, hif, q->queue_id, descs,
+			 &total_descs, &pkts);
+	/* number of descriptors (and packets) that were not sent */
+	if (unlikely(num > total_descs)) {
+		sq->head = (MRVL_PP2_TX_SHADOWQ_SIZE + sq->head -
+			    (num - total_descs)) & MRVL_PP2_TX_SHADOWQ_MASK;
+		sq->size -= num - total_descs;
+		nb_pkts = pkts.num;
+	}
+
+	if (unlikely(shaped > nb_pkts))
+		mrvl_tx_unshape(q, tx_pkts + nb_pkts, shaped - nb_pkts);
 
 	return nb_pkts;
 }
@@ -1749,7 +3184,7 @@ mrvl_priv_create(const char *dev_name)
 		goto out_free_priv;
 
 	bpool_bit = mrvl_reserve_bit(&used_bpools[priv->pp_id],
-				     PP2_BPOOL_NUM_POOLS);
+				     MRVL_MEMPOOL_BPOOL_FIRST);
 	if (bpool_bit < 0)
 		goto out_free_priv;
 	priv->bpool_bit = bpool_bit;
@@ -1764,6 +3199,7 @@ mrvl_priv_create(const char *dev_name)
 
 	priv->ppio_params.type = PP2_PPIO_T_NIC;
 	rte_spinlock_init(&priv->lock);
+	TAILQ_INIT(&priv->flows);
 
 	return priv;
 out_clear_bpool_bit:
@@ -1816,6 +3252,7 @@ mrvl_eth_dev_create(const char *drv_name, const char *name)
 	eth_dev->data->drv_name = drv_name;
 	eth_dev->data->dev_private = priv;
 	eth_dev->dev_ops = &mrvl_ops;
+	eth_dev->intr_handle = &priv->intr_handle;
 
 	return 0;
 out_free_mac:
@@ -1839,7 +3276,8 @@ mrvl_eth_dev_destroy(const char *name)
 		return;
 
 	priv = eth_dev->data->dev_private;
-	pp2_bpool_deinit(priv->bpool);
+	if (!priv->bpool_ext)
+		pp2_bpool_deinit(priv->bpool);
 	rte_free(priv);
 	rte_free(eth_dev->data->mac_addrs);
 	rte_eth_dev_release_port(eth_dev);
@@ -1924,7 +3362,7 @@ rte_pmd_mrvl_probe(struct rte_vdev_device *vdev)
 			goto out_deinit_dma;
 		}
 
-		memset(mrvl_port_bpool_size, 0, sizeof(mrvl_port_bpool_size));
+		memset(mrvl_port_bpool_lcore, 0, sizeof(mrvl_port_bpool_lcore));
 
 		mrvl_lcore_first = RTE_MAX_LCORE;
 		mrvl_lcore_last = 0;
@@ -1988,6 +3426,137 @@ rte_pmd_mrvl_remove(struct rte_vdev_device *vdev)
 	return 0;
 }
 
+int
+rte_pmd_mrvl_set_port_rate_limit(uint8_t port,
+				 const struct rte_pmd_mrvl_rate_limit *rl)
+{
+	static const struct rte_pmd_mrvl_rate_limit no_limit;
+	struct rte_eth_dev *dev;
+	struct mrvl_priv *priv;
+	int hw = 0;
+
+	RTE_ETH_VALID_PORTID_OR_ERR_RET(port, -ENODEV);
+
+	dev = &rte_eth_devices[port];
+	if (dev->dev_ops != &mrvl_ops)
+		return -ENOTSUP;
+
+	if (!rl)
+		rl = &no_limit;
+
+	if (mrvl_rate_limit_check(rl))
+		return -EINVAL;
+
+	priv = dev->data->dev_private;
+	priv->rate_limit = *rl;
+
+	if (!priv->ppio)
+		return 0;
+
+	if (mrvl_rate_limit_params(rl, &priv->ppio_params.rate_limit_params))
+		hw = !pp2_ppio_set_rate_limit(priv->ppio,
+				&priv->ppio_params.rate_limit_params);
+	else
+		pp2_ppio_clear_rate_limit(priv->ppio);
+
+	if (rl->max_throughput_mbps && !hw)
+		RTE_LOG(INFO, PMD,
+			"Port %u bytes rate limited in software\n", port);
+
+	mrvl_shaper_setup(&priv->shaper, rl, hw);
+
+	return 0;
+}
+
+int
+rte_pmd_mrvl_set_txq_rate_limit(uint8_t port, uint16_t queue,
+				const struct rte_pmd_mrvl_rate_limit *rl)
+{
+	static const struct rte_pmd_mrvl_rate_limit no_limit;
+	struct pp2_ppio_outq_params *outq;
+	struct rte_eth_dev *dev;
+	struct mrvl_priv *priv;
+	struct mrvl_txq *txq;
+	int hw = 0;
+
+	RTE_ETH_VALID_PORTID_OR_ERR_RET(port, -ENODEV);
+
+	dev = &rte_eth_devices[port];
+	if (dev->dev_ops != &mrvl_ops)
+		return -ENOTSUP;
+
+	if (queue >= dev->data->nb_tx_queues)
+		return -EINVAL;
+
+	if (!rl)
+		rl = &no_limit;
+
+	if (mrvl_rate_limit_check(rl))
+		return -EINVAL;
+
+	priv = dev->data->dev_private;
+	priv->txq_rate_limit[queue] = *rl;
+
+	txq = dev->data->tx_queues[queue];
+	if (!priv->ppio || !txq)
+		return 0;
+
+	outq = &priv->ppio_params.outqs_params.outqs_params[queue];
+	if (mrvl_rate_limit_params(rl, &outq->rate_limit_params))
+		hw = !pp2_ppio_set_outq_rate_limit(priv->ppio, queue,
+						   &outq->rate_limit_params);
+	else
+		pp2_ppio_clear_outq_rate_limit(priv->ppio, queue);
+
+	if (rl->max_throughput_mbps && !hw)
+		RTE_LOG(INFO, PMD,
+			"Port %u txq %u bytes rate limited in software\n",
+			port, queue);
+
+	mrvl_shaper_setup(&txq->shaper, rl, hw);
+
+	return 0;
+}
+
+int
+rte_pmd_mrvl_set_txq_sched(uint8_t port, uint16_t queue,
+			   enum rte_pmd_mrvl_sched_mode mode, uint8_t weight)
+{
+	struct pp2_ppio_outq_params *outq;
+	struct rte_eth_dev *dev;
+	struct mrvl_priv *priv;
+
+	RTE_ETH_VALID_PORTID_OR_ERR_RET(port, -ENODEV);
+
+	dev = &rte_eth_devices[port];
+	if (dev->dev_ops != &mrvl_ops)
+		return -ENOTSUP;
+
+	if (queue >= dev->data->nb_tx_queues)
+		return -EINVAL;
+
+	priv = dev->data->dev_private;
+	if (priv->ppio)
+		return -EBUSY;
+
+	outq = &priv->ppio_params.outqs_params.outqs_params[queue];
+	switch (mode) {
+	case RTE_PMD_MRVL_SCHED_SP:
+		outq->sched_mode = PP2_PPIO_SCHED_M_SP;
+		break;
+	case RTE_PMD_MRVL_SCHED_WRR:
+		if (!weight)
+			return -EINVAL;
+		outq->sched_mode = PP2_PPIO_SCHED_M_WRR;
+		outq->weight = weight;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
 static struct rte_vdev_driver pmd_mrvl_drv = {
 	.probe = rte_pmd_mrvl_probe,
 	.remove = rte_pmd_mrvl_remove,
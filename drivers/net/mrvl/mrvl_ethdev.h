@@ -34,12 +34,17 @@
 #ifndef _MRVL_ETHDEV_H_
 #define _MRVL_ETHDEV_H_
 
+#include <sys/queue.h>
+
+#include <rte_atomic.h>
 #include <rte_spinlock.h>
 #include <rte_ethdev.h>
 #include <env/mv_autogen_comp_flags.h>
 #include <drivers/mv_pp2_cls.h>
 #include <drivers/mv_pp2_ppio.h>
 
+#include "rte_pmd_mrvl.h"
+
 
 /** Maximum number of rx queues per port */
 #define MRVL_PP2_RXQ_MAX 32
@@ -111,14 +116,33 @@ struct mrvl_config {
 	int vlan_fltrs_num;
 };
 
+/** Software token bucket. */
+struct mrvl_tb {
+	uint64_t tokens;	/**< Available tokens */
+	uint64_t size;		/**< Bucket size, 0 if unlimited */
+	uint64_t rate;		/**< Tokens per timer cycle, fixed point */
+	uint64_t max_delta;	/**< Longest refill period without overflow */
+	uint64_t tsc;		/**< Timestamp of the last refill */
+};
+
+/** Software shaper, enforces limits the hardware cannot. */
+struct mrvl_shaper {
+	rte_spinlock_t lock;	/**< Serializes lcores sharing the shaper */
+	rte_atomic32_t enabled;	/**< Any of the buckets is limited */
+	struct mrvl_tb pkts;	/**< Packets bucket */
+	struct mrvl_tb bytes;	/**< Bytes bucket */
+};
+
 struct mrvl_priv {
 	/* Hot fields, used in fast path. */
 	struct pp2_bpool *bpool;  /**< BPool pointer */
 	struct pp2_ppio	*ppio;    /**< Port handler pointer */
-	rte_spinlock_t lock;	  /**< Spinlock for checking bpool status */
+	rte_spinlock_t lock;	  /**< Spinlock for hif allocation */
+	rte_atomic32_t bpool_rebalance; /**< BPool rebalancing in progress */
 	uint16_t bpool_max_size;  /**< BPool maximum size */
 	uint16_t bpool_min_size;  /**< BPool minimum size  */
 	uint16_t bpool_init_size; /**< Configured BPool size  */
+	uint8_t bpool_ext;        /**< BPool owned by mrvl mempool */
 
 	/** Mapping for DPDK rx queue->(TC, MRVL relative inq) */
 	struct {
@@ -139,6 +163,19 @@ struct mrvl_priv {
 	struct pp2_cls_qos_tbl_params qos_tbl_params;
 	struct pp2_cls_tbl *qos_tbl;
 	uint16_t nb_rx_queues;
+
+	/* Generic flow API data. */
+	TAILQ_HEAD(mrvl_flows, rte_flow) flows; /**< Created flows */
+	struct pp2_cls_tbl_params cls_tbl_params;
+	struct pp2_cls_cos_desc cls_default_cos;
+	struct pp2_cls_tbl *cls_tbl;
+
+	struct rte_intr_handle intr_handle; /**< Rx interrupts handle */
+
+	/* Egress rate limiting. */
+	struct mrvl_shaper shaper; /**< Port software shaper */
+	struct rte_pmd_mrvl_rate_limit rate_limit; /**< Port rate limit */
+	struct rte_pmd_mrvl_rate_limit txq_rate_limit[MRVL_PP2_TXQ_MAX];
 };
 
 /** Number of ports configured. */
@@ -0,0 +1,967 @@
+/*
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Semihalf. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Semihalf nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/queue.h>
+
+#include <rte_byteorder.h>
+#include <rte_common.h>
+#include <rte_ip.h>
+#include <rte_log.h>
+#include <rte_malloc.h>
+
+#ifdef container_of
+#undef container_of
+#endif
+
+#include "mrvl_flow.h"
+#include "mrvl_qos.h"
+
+/** Maximum number of rules in classifier table (limited by TCAM size). */
+#define MRVL_CLS_MAX_NUM_RULES 20
+
+/** Size of a string used to pass key/mask of a single field to MUSDK. */
+#define MRVL_CLS_STR_SIZE_MAX 40
+
+/** Maximum size of a single field in bytes (IPv6 address). */
+#define MRVL_CLS_FIELD_SIZE_MAX 16
+
+/** Pattern layers, items must appear in increasing order. */
+enum mrvl_flow_layer {
+	MRVL_LAYER_NONE,
+	MRVL_LAYER_ETH,
+	MRVL_LAYER_VLAN,
+	MRVL_LAYER_L3,
+	MRVL_LAYER_L4,
+};
+
+/**
+ * Classifier table key fields.
+ *
+ * Order matters as it determines order of fields in table key and rules.
+ */
+enum mrvl_flow_field {
+	MRVL_F_ETH_DMAC,
+	MRVL_F_ETH_SMAC,
+	MRVL_F_ETH_TYPE,
+	MRVL_F_VLAN_PRI,
+	MRVL_F_VLAN_ID,
+	MRVL_F_IP4_TOS,
+	MRVL_F_IP4_SIP,
+	MRVL_F_IP4_DIP,
+	MRVL_F_IP4_PROTO,
+	MRVL_F_IP6_TC,
+	MRVL_F_IP6_SIP,
+	MRVL_F_IP6_DIP,
+	MRVL_F_IP6_FLOW,
+	MRVL_F_IP6_NEXT_HDR,
+	MRVL_F_TCP_SPORT,
+	MRVL_F_TCP_DPORT,
+	MRVL_F_UDP_SPORT,
+	MRVL_F_UDP_DPORT,
+	MRVL_F_MAX
+};
+
+/** Description of a classifier field as understood by MUSDK. */
+struct mrvl_flow_field_desc {
+	struct pp2_cls_fld_proto proto_field;
+	uint8_t size; /**< Field size in bytes */
+};
+
+#define MRVL_FIELD(p, f, v, sz) \
+	{ { .proto = (p), .field = { .f = (v) } }, (sz) }
+
+static const struct mrvl_flow_field_desc mrvl_flow_fields[MRVL_F_MAX] = {
+	[MRVL_F_ETH_DMAC] = MRVL_FIELD(MV_NET_PROTO_ETH, eth,
+				       MV_NET_ETH_F_DA, ETHER_ADDR_LEN),
+	[MRVL_F_ETH_SMAC] = MRVL_FIELD(MV_NET_PROTO_ETH, eth,
+				       MV_NET_ETH_F_SA, ETHER_ADDR_LEN),
+	[MRVL_F_ETH_TYPE] = MRVL_FIELD(MV_NET_PROTO_ETH, eth,
+				       MV_NET_ETH_F_TYPE, 2),
+	[MRVL_F_VLAN_PRI] = MRVL_FIELD(MV_NET_PROTO_VLAN, vlan,
+				       MV_NET_VLAN_F_PRI, 1),
+	[MRVL_F_VLAN_ID] = MRVL_FIELD(MV_NET_PROTO_VLAN, vlan,
+				      MV_NET_VLAN_F_ID, 2),
+	[MRVL_F_IP4_TOS] = MRVL_FIELD(MV_NET_PROTO_IP4, ipv4,
+				      MV_NET_IP4_F_TOS, 1),
+	[MRVL_F_IP4_SIP] = MRVL_FIELD(MV_NET_PROTO_IP4, ipv4,
+				      MV_NET_IP4_F_SA, 4),
+	[MRVL_F_IP4_DIP] = MRVL_FIELD(MV_NET_PROTO_IP4, ipv4,
+				      MV_NET_IP4_F_DA, 4),
+	[MRVL_F_IP4_PROTO] = MRVL_FIELD(MV_NET_PROTO_IP4, ipv4,
+					MV_NET_IP4_F_PROTO, 1),
+	[MRVL_F_IP6_TC] = MRVL_FIELD(MV_NET_PROTO_IP6, ipv6,
+				     MV_NET_IP6_F_TC, 1),
+	[MRVL_F_IP6_SIP] = MRVL_FIELD(MV_NET_PROTO_IP6, ipv6,
+				      MV_NET_IP6_F_SA, 16),
+	[MRVL_F_IP6_DIP] = MRVL_FIELD(MV_NET_PROTO_IP6, ipv6,
+				      MV_NET_IP6_F_DA, 16),
+	[MRVL_F_IP6_FLOW] = MRVL_FIELD(MV_NET_PROTO_IP6, ipv6,
+				       MV_NET_IP6_F_FLOW, 3),
+	[MRVL_F_IP6_NEXT_HDR] = MRVL_FIELD(MV_NET_PROTO_IP6, ipv6,
+					   MV_NET_IP6_F_NEXT_HDR, 1),
+	[MRVL_F_TCP_SPORT] = MRVL_FIELD(MV_NET_PROTO_TCP, tcp,
+					MV_NET_TCP_F_SP, 2),
+	[MRVL_F_TCP_DPORT] = MRVL_FIELD(MV_NET_PROTO_TCP, tcp,
+					MV_NET_TCP_F_DP, 2),
+	[MRVL_F_UDP_SPORT] = MRVL_FIELD(MV_NET_PROTO_UDP, udp,
+					MV_NET_UDP_F_SP, 2),
+	[MRVL_F_UDP_DPORT] = MRVL_FIELD(MV_NET_PROTO_UDP, udp,
+					MV_NET_UDP_F_DP, 2),
+};
+
+/** PMD specific flow rule. */
+struct rte_flow {
+	TAILQ_ENTRY(rte_flow) next;
+	uint32_t fields;	/**< Bitmask of matched fields */
+	int applied;		/**< Rule is present in classifier table */
+	struct pp2_cls_tbl_rule rule;
+	struct pp2_cls_cos_desc cos;
+	struct pp2_cls_tbl_action action;
+	/** Key and mask of each field, in network byte order */
+	uint8_t key[MRVL_F_MAX][MRVL_CLS_FIELD_SIZE_MAX];
+	uint8_t mask[MRVL_F_MAX][MRVL_CLS_FIELD_SIZE_MAX];
+	/** Key and mask strings passed to MUSDK */
+	char key_str[PP2_CLS_TBL_MAX_NUM_FIELDS][MRVL_CLS_STR_SIZE_MAX];
+	char mask_str[PP2_CLS_TBL_MAX_NUM_FIELDS][MRVL_CLS_STR_SIZE_MAX];
+};
+
+/* Masks of the fields supported by the classifier, per pattern item. */
+static const struct rte_flow_item_eth mrvl_eth_supported = {
+	.dst.addr_bytes = "\xff\xff\xff\xff\xff\xff",
+	.src.addr_bytes = "\xff\xff\xff\xff\xff\xff",
+	.type = 0xffff,
+};
+
+static const struct rte_flow_item_vlan mrvl_vlan_supported = {
+	.tci = 0xffff,
+};
+
+static const struct rte_flow_item_ipv4 mrvl_ipv4_supported = {
+	.hdr = {
+		.type_of_service = 0xff,
+		.next_proto_id = 0xff,
+		.src_addr = 0xffffffff,
+		.dst_addr = 0xffffffff,
+	},
+};
+
+static const struct rte_flow_item_ipv6 mrvl_ipv6_supported = {
+	.hdr = {
+		.vtc_flow = 0xffffffff,
+		.proto = 0xff,
+		.src_addr = "\xff\xff\xff\xff\xff\xff\xff\xff"
+			    "\xff\xff\xff\xff\xff\xff\xff\xff",
+		.dst_addr = "\xff\xff\xff\xff\xff\xff\xff\xff"
+			    "\xff\xff\xff\xff\xff\xff\xff\xff",
+	},
+};
+
+static const struct rte_flow_item_tcp mrvl_tcp_supported = {
+	.hdr = {
+		.src_port = 0xffff,
+		.dst_port = 0xffff,
+	},
+};
+
+static const struct rte_flow_item_udp mrvl_udp_supported = {
+	.hdr = {
+		.src_port = 0xffff,
+		.dst_port = 0xffff,
+	},
+};
+
+/**
+ * Get spec and mask of a pattern item.
+ *
+ * @param item Pattern item.
+ * @param def_mask Default mask of the item.
+ * @param supported Mask of the fields supported by the classifier.
+ * @param size Size of the item specification structure.
+ * @param spec Pointer to returned spec (NULL if item matches anything).
+ * @param mask Pointer to returned mask.
+ * @param error Pointer to the flow error.
+ * @returns 0 in case of success, negative value otherwise.
+ */
+static int
+mrvl_parse_init(const struct rte_flow_item *item, const void *def_mask,
+		const void *supported, size_t size, const void **spec,
+		const void **mask, struct rte_flow_error *error)
+{
+	const uint8_t *m, *s = supported;
+	size_t i;
+
+	if (item->last)
+		return -rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ITEM, item,
+				"Ranges are not supported");
+
+	*spec = item->spec;
+	*mask = item->mask ? item->mask : def_mask;
+
+	if (!*spec) {
+		if (item->mask)
+			return -rte_flow_error_set(error, EINVAL,
+					RTE_FLOW_ERROR_TYPE_ITEM, item,
+					"Mask given without spec");
+		return 0;
+	}
+
+	m = *mask;
+	for (i = 0; i < size; i++)
+		if (m[i] & ~s[i])
+			return -rte_flow_error_set(error, ENOTSUP,
+					RTE_FLOW_ERROR_TYPE_ITEM, item,
+					"Mask contains unsupported fields");
+
+	return 0;
+}
+
+/**
+ * Add a field to the flow if its mask is not empty.
+ *
+ * @param flow Pointer to the flow.
+ * @param field Field to add.
+ * @param key Field value in network byte order.
+ * @param mask Field mask in network byte order.
+ */
+static void
+mrvl_parse_field(struct rte_flow *flow, enum mrvl_flow_field field,
+		 const void *key, const void *mask)
+{
+	const uint8_t *m = mask;
+	size_t size = mrvl_flow_fields[field].size;
+	size_t i;
+
+	for (i = 0; i < size; i++)
+		if (m[i])
+			break;
+
+	if (i == size)
+		return;
+
+	memcpy(flow->key[field], key, size);
+	memcpy(flow->mask[field], mask, size);
+	flow->fields |= 1u << field;
+}
+
+static int
+mrvl_parse_eth(const struct rte_flow_item *item, struct rte_flow *flow,
+	       struct rte_flow_error *error)
+{
+	const struct rte_flow_item_eth *spec, *mask;
+	int ret;
+
+	ret = mrvl_parse_init(item, &rte_flow_item_eth_mask,
+			      &mrvl_eth_supported, sizeof(*spec),
+			      (const void **)&spec, (const void **)&mask,
+			      error);
+	if (ret || !spec)
+		return ret;
+
+	mrvl_parse_field(flow, MRVL_F_ETH_DMAC, &spec->dst, &mask->dst);
+	mrvl_parse_field(flow, MRVL_F_ETH_SMAC, &spec->src, &mask->src);
+	mrvl_parse_field(flow, MRVL_F_ETH_TYPE, &spec->type, &mask->type);
+
+	return 0;
+}
+
+static int
+mrvl_parse_vlan(const struct rte_flow_item *item, struct rte_flow *flow,
+		struct rte_flow_error *error)
+{
+	const struct rte_flow_item_vlan *spec, *mask;
+	uint16_t tci, tci_mask, id, id_mask;
+	uint8_t pri, pri_mask;
+	int ret;
+
+	ret = mrvl_parse_init(item, &rte_flow_item_vlan_mask,
+			      &mrvl_vlan_supported, sizeof(*spec),
+			      (const void **)&spec, (const void **)&mask,
+			      error);
+	if (ret || !spec)
+		return ret;
+
+	/* Classifier can not match on CFI/DEI bit, it is ignored. */
+	tci = rte_be_to_cpu_16(spec->tci);
+	tci_mask = rte_be_to_cpu_16(mask->tci);
+
+	pri = (tci & 0xe000) >> 13;
+	pri_mask = (tci_mask & 0xe000) >> 13;
+	mrvl_parse_field(flow, MRVL_F_VLAN_PRI, &pri, &pri_mask);
+
+	id = rte_cpu_to_be_16(tci & 0x0fff);
+	id_mask = rte_cpu_to_be_16(tci_mask & 0x0fff);
+	mrvl_parse_field(flow, MRVL_F_VLAN_ID, &id, &id_mask);
+
+	return 0;
+}
+
+static int
+mrvl_parse_ipv4(const struct rte_flow_item *item, struct rte_flow *flow,
+		struct rte_flow_error *error)
+{
+	const struct rte_flow_item_ipv4 *spec, *mask;
+	int ret;
+
+	ret = mrvl_parse_init(item, &rte_flow_item_ipv4_mask,
+			      &mrvl_ipv4_supported, sizeof(*spec),
+			      (const void **)&spec, (const void **)&mask,
+			      error);
+	if (ret || !spec)
+		return ret;
+
+	mrvl_parse_field(flow, MRVL_F_IP4_TOS, &spec->hdr.type_of_service,
+			 &mask->hdr.type_of_service);
+	mrvl_parse_field(flow, MRVL_F_IP4_SIP, &spec->hdr.src_addr,
+			 &mask->hdr.src_addr);
+	mrvl_parse_field(flow, MRVL_F_IP4_DIP, &spec->hdr.dst_addr,
+			 &mask->hdr.dst_addr);
+	mrvl_parse_field(flow, MRVL_F_IP4_PROTO, &spec->hdr.next_proto_id,
+			 &mask->hdr.next_proto_id);
+
+	return 0;
+}
+
+static int
+mrvl_parse_ipv6(const struct rte_flow_item *item, struct rte_flow *flow,
+		struct rte_flow_error *error)
+{
+	const struct rte_flow_item_ipv6 *spec, *mask;
+	uint32_t vtc_flow, vtc_flow_mask, fl, fl_mask;
+	uint8_t tc, tc_mask;
+	int ret;
+
+	ret = mrvl_parse_init(item, &rte_flow_item_ipv6_mask,
+			      &mrvl_ipv6_supported, sizeof(*spec),
+			      (const void **)&spec, (const void **)&mask,
+			      error);
+	if (ret || !spec)
+		return ret;
+
+	vtc_flow = rte_be_to_cpu_32(spec->hdr.vtc_flow);
+	vtc_flow_mask = rte_be_to_cpu_32(mask->hdr.vtc_flow);
+
+	if (vtc_flow_mask & 0xf0000000)
+		return -rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ITEM, item,
+				"IPv6 version matching is not supported");
+
+	tc = (vtc_flow >> 20) & 0xff;
+	tc_mask = (vtc_flow_mask >> 20) & 0xff;
+	mrvl_parse_field(flow, MRVL_F_IP6_TC, &tc, &tc_mask);
+
+	mrvl_parse_field(flow, MRVL_F_IP6_SIP, spec->hdr.src_addr,
+			 mask->hdr.src_addr);
+	mrvl_parse_field(flow, MRVL_F_IP6_DIP, spec->hdr.dst_addr,
+			 mask->hdr.dst_addr);
+
+	/* 20 bit flow label, stored as 3 bytes in network byte order */
+	fl = rte_cpu_to_be_32((vtc_flow & 0xfffff) << 8);
+	fl_mask = rte_cpu_to_be_32((vtc_flow_mask & 0xfffff) << 8);
+	mrvl_parse_field(flow, MRVL_F_IP6_FLOW, &fl, &fl_mask);
+
+	mrvl_parse_field(flow, MRVL_F_IP6_NEXT_HDR, &spec->hdr.proto,
+			 &mask->hdr.proto);
+
+	return 0;
+}
+
+static int
+mrvl_parse_tcp(const struct rte_flow_item *item, struct rte_flow *flow,
+	       struct rte_flow_error *error)
+{
+	const struct rte_flow_item_tcp *spec, *mask;
+	int ret;
+
+	ret = mrvl_parse_init(item, &rte_flow_item_tcp_mask,
+			      &mrvl_tcp_supported, sizeof(*spec),
+			      (const void **)&spec, (const void **)&mask,
+			      error);
+	if (ret || !spec)
+		return ret;
+
+	mrvl_parse_field(flow, MRVL_F_TCP_SPORT, &spec->hdr.src_port,
+			 &mask->hdr.src_port);
+	mrvl_parse_field(flow, MRVL_F_TCP_DPORT, &spec->hdr.dst_port,
+			 &mask->hdr.dst_port);
+
+	return 0;
+}
+
+static int
+mrvl_parse_udp(const struct rte_flow_item *item, struct rte_flow *flow,
+	       struct rte_flow_error *error)
+{
+	const struct rte_flow_item_udp *spec, *mask;
+	int ret;
+
+	ret = mrvl_parse_init(item, &rte_flow_item_udp_mask,
+			      &mrvl_udp_supported, sizeof(*spec),
+			      (const void **)&spec, (const void **)&mask,
+			      error);
+	if (ret || !spec)
+		return ret;
+
+	mrvl_parse_field(flow, MRVL_F_UDP_SPORT, &spec->hdr.src_port,
+			 &mask->hdr.src_port);
+	mrvl_parse_field(flow, MRVL_F_UDP_DPORT, &spec->hdr.dst_port,
+			 &mask->hdr.dst_port);
+
+	return 0;
+}
+
+/** Supported pattern items. */
+static const struct {
+	enum rte_flow_item_type type;
+	enum mrvl_flow_layer layer;
+	int (*parse)(const struct rte_flow_item *item, struct rte_flow *flow,
+		     struct rte_flow_error *error);
+} mrvl_flow_items[] = {
+	{ RTE_FLOW_ITEM_TYPE_ETH, MRVL_LAYER_ETH, mrvl_parse_eth },
+	{ RTE_FLOW_ITEM_TYPE_VLAN, MRVL_LAYER_VLAN, mrvl_parse_vlan },
+	{ RTE_FLOW_ITEM_TYPE_IPV4, MRVL_LAYER_L3, mrvl_parse_ipv4 },
+	{ RTE_FLOW_ITEM_TYPE_IPV6, MRVL_LAYER_L3, mrvl_parse_ipv6 },
+	{ RTE_FLOW_ITEM_TYPE_TCP, MRVL_LAYER_L4, mrvl_parse_tcp },
+	{ RTE_FLOW_ITEM_TYPE_UDP, MRVL_LAYER_L4, mrvl_parse_udp },
+};
+
+static int
+mrvl_flow_parse_attr(const struct rte_flow_attr *attr,
+		     struct rte_flow_error *error)
+{
+	if (!attr)
+		return -rte_flow_error_set(error, EINVAL,
+				RTE_FLOW_ERROR_TYPE_ATTR, NULL,
+				"NULL attribute");
+
+	if (attr->group)
+		return -rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ATTR_GROUP, attr,
+				"Groups are not supported");
+
+	if (attr->priority)
+		return -rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ATTR_PRIORITY, attr,
+				"Priorities are not supported");
+
+	if (attr->egress || !attr->ingress)
+		return -rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ATTR_EGRESS, attr,
+				"Only ingress is supported");
+
+	return 0;
+}
+
+static int
+mrvl_flow_parse_pattern(const struct rte_flow_item pattern[],
+			struct rte_flow *flow, struct rte_flow_error *error)
+{
+	enum mrvl_flow_layer layer = MRVL_LAYER_NONE;
+	const struct rte_flow_item *item;
+	unsigned int i;
+	int ret;
+
+	if (!pattern)
+		return -rte_flow_error_set(error, EINVAL,
+				RTE_FLOW_ERROR_TYPE_ITEM_NUM, NULL,
+				"NULL pattern");
+
+	for (item = pattern; item->type != RTE_FLOW_ITEM_TYPE_END; item++) {
+		if (item->type == RTE_FLOW_ITEM_TYPE_VOID)
+			continue;
+
+		for (i = 0; i < RTE_DIM(mrvl_flow_items); i++)
+			if (mrvl_flow_items[i].type == item->type)
+				break;
+
+		if (i == RTE_DIM(mrvl_flow_items))
+			return -rte_flow_error_set(error, ENOTSUP,
+					RTE_FLOW_ERROR_TYPE_ITEM, item,
+					"Unsupported pattern item");
+
+		if (mrvl_flow_items[i].layer <= layer)
+			return -rte_flow_error_set(error, EINVAL,
+					RTE_FLOW_ERROR_TYPE_ITEM, item,
+					"Unexpected pattern item order");
+		layer = mrvl_flow_items[i].layer;
+
+		ret = mrvl_flow_items[i].parse(item, flow, error);
+		if (ret)
+			return ret;
+	}
+
+	if (!flow->fields)
+		return -rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ITEM, pattern,
+				"Pattern does not match any field");
+
+	if (__builtin_popcount(flow->fields) > PP2_CLS_TBL_MAX_NUM_FIELDS)
+		return -rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ITEM, pattern,
+				"Too many fields in pattern");
+
+	return 0;
+}
+
+static int
+mrvl_flow_parse_actions(struct mrvl_priv *priv,
+			const struct rte_flow_action actions[],
+			struct rte_flow *flow, struct rte_flow_error *error)
+{
+	const struct rte_flow_action *action;
+	int fate = 0;
+
+	if (!actions)
+		return -rte_flow_error_set(error, EINVAL,
+				RTE_FLOW_ERROR_TYPE_ACTION_NUM, NULL,
+				"NULL actions");
+
+	for (action = actions; action->type != RTE_FLOW_ACTION_TYPE_END;
+	     action++) {
+		const struct rte_flow_action_queue *queue;
+		const struct rte_flow_action_rss *rss;
+		unsigned int i;
+
+		switch (action->type) {
+		case RTE_FLOW_ACTION_TYPE_VOID:
+			continue;
+		case RTE_FLOW_ACTION_TYPE_DROP:
+			flow->action.type = PP2_CLS_TBL_ACT_DROP;
+			break;
+		case RTE_FLOW_ACTION_TYPE_QUEUE:
+			queue = action->conf;
+			if (queue->index >= priv->nb_rx_queues)
+				return -rte_flow_error_set(error, EINVAL,
+						RTE_FLOW_ERROR_TYPE_ACTION,
+						action, "Invalid queue index");
+			flow->action.type = PP2_CLS_TBL_ACT_DONE;
+			flow->cos.tc = priv->rxq_map[queue->index].tc;
+			break;
+		case RTE_FLOW_ACTION_TYPE_RSS:
+			/*
+			 * Classifier selects a Traffic Class, packets are
+			 * then hashed across all in-queues of that TC.
+			 * Hence all queues must belong to the same TC.
+			 */
+			rss = action->conf;
+			if (!rss || !rss->num)
+				return -rte_flow_error_set(error, EINVAL,
+						RTE_FLOW_ERROR_TYPE_ACTION,
+						action, "No queues given");
+			for (i = 0; i < rss->num; i++) {
+				if (rss->queue[i] >= priv->nb_rx_queues)
+					return -rte_flow_error_set(error,
+						EINVAL,
+						RTE_FLOW_ERROR_TYPE_ACTION,
+						action, "Invalid queue index");
+				if (priv->rxq_map[rss->queue[i]].tc !=
+				    priv->rxq_map[rss->queue[0]].tc)
+					return -rte_flow_error_set(error,
+						ENOTSUP,
+						RTE_FLOW_ERROR_TYPE_ACTION,
+						action,
+						"Queues must share Traffic Class");
+			}
+			flow->action.type = PP2_CLS_TBL_ACT_DONE;
+			flow->cos.tc = priv->rxq_map[rss->queue[0]].tc;
+			break;
+		default:
+			return -rte_flow_error_set(error, ENOTSUP,
+					RTE_FLOW_ERROR_TYPE_ACTION, action,
+					"Unsupported action");
+		}
+
+		if (fate++)
+			return -rte_flow_error_set(error, ENOTSUP,
+					RTE_FLOW_ERROR_TYPE_ACTION, action,
+					"Only one fate action is supported");
+	}
+
+	if (!fate)
+		return -rte_flow_error_set(error, EINVAL,
+				RTE_FLOW_ERROR_TYPE_ACTION_NUM, actions,
+				"Fate action is missing");
+
+	return 0;
+}
+
+/**
+ * Format a field as a hexadecimal string understood by MUSDK.
+ *
+ * @param str Output string.
+ * @param bytes Field bytes in network byte order.
+ * @param size Field size in bytes.
+ */
+static void
+mrvl_flow_field_str(char *str, const uint8_t *bytes, size_t size)
+{
+	size_t i;
+
+	str += sprintf(str, "0x");
+	for (i = 0; i < size; i++)
+		str += sprintf(str, "%02x", bytes[i]);
+}
+
+/**
+ * Build classifier rule out of the parsed fields.
+ *
+ * Rule fields are laid out in mrvl_flow_field order, the same one
+ * used for the table key.
+ *
+ * @param flow Pointer to the flow.
+ */
+static void
+mrvl_flow_build_rule(struct rte_flow *flow)
+{
+	struct pp2_cls_tbl_rule *rule = &flow->rule;
+	int i;
+
+	rule->num_fields = 0;
+	for (i = 0; i < MRVL_F_MAX; i++) {
+		struct pp2_cls_rule_key_field *f;
+
+		if (!(flow->fields & (1u << i)))
+			continue;
+
+		f = &rule->fields[rule->num_fields];
+		mrvl_flow_field_str(flow->key_str[rule->num_fields],
+				    flow->key[i], mrvl_flow_fields[i].size);
+		mrvl_flow_field_str(flow->mask_str[rule->num_fields],
+				    flow->mask[i], mrvl_flow_fields[i].size);
+		f->size = mrvl_flow_fields[i].size;
+		f->key = (u8 *)flow->key_str[rule->num_fields];
+		f->mask = (u8 *)flow->mask_str[rule->num_fields];
+		rule->num_fields++;
+	}
+
+	flow->action.cos = &flow->cos;
+}
+
+/**
+ * Parse and check the flow against the port's existing flows.
+ *
+ * Does not touch hardware, so it can be used both for validation and
+ * before the port is started.
+ *
+ * @returns 0 in case of success, negative value otherwise.
+ */
+static int
+mrvl_flow_parse(struct mrvl_priv *priv, const struct rte_flow_attr *attr,
+		const struct rte_flow_item pattern[],
+		const struct rte_flow_action actions[], struct rte_flow *flow,
+		struct rte_flow_error *error)
+{
+	struct rte_flow *first;
+	int ret, num = 0;
+
+	ret = mrvl_flow_parse_attr(attr, error);
+	if (ret)
+		return ret;
+
+	ret = mrvl_flow_parse_pattern(pattern, flow, error);
+	if (ret)
+		return ret;
+
+	ret = mrvl_flow_parse_actions(priv, actions, flow, error);
+	if (ret)
+		return ret;
+
+	/*
+	 * Single classifier table is used per port, all its rules
+	 * have to match on the same set of fields.
+	 */
+	first = TAILQ_FIRST(&priv->flows);
+	if (first && first->fields != flow->fields)
+		return -rte_flow_error_set(error, ENOTSUP,
+				RTE_FLOW_ERROR_TYPE_ITEM, pattern,
+				"Pattern fields differ from existing flows");
+
+	TAILQ_FOREACH(first, &priv->flows, next)
+		num++;
+
+	if (num >= MRVL_CLS_MAX_NUM_RULES)
+		return -rte_flow_error_set(error, ENOSPC,
+				RTE_FLOW_ERROR_TYPE_HANDLE, NULL,
+				"Classifier table is full");
+
+	mrvl_flow_build_rule(flow);
+
+	return 0;
+}
+
+/**
+ * Create classifier table with the key layout of a given flow.
+ *
+ * @param dev Pointer to Ethernet device structure.
+ * @param flow Flow defining the table key.
+ * @returns 0 in case of success, negative value otherwise.
+ */
+static int
+mrvl_cls_tbl_init(struct rte_eth_dev *dev, struct rte_flow *flow)
+{
+	struct mrvl_priv *priv = dev->data->dev_private;
+	struct pp2_cls_tbl_key *key = &priv->cls_tbl_params.key;
+	int i;
+
+	memset(&priv->cls_tbl_params, 0, sizeof(priv->cls_tbl_params));
+	priv->cls_tbl_params.type = PP2_CLS_TBL_MASKABLE;
+	priv->cls_tbl_params.max_num_rules = MRVL_CLS_MAX_NUM_RULES;
+
+	for (i = 0; i < MRVL_F_MAX; i++) {
+		if (!(flow->fields & (1u << i)))
+			continue;
+
+		key->proto_field[key->num_fields++] =
+			mrvl_flow_fields[i].proto_field;
+		key->key_size += mrvl_flow_fields[i].size;
+	}
+
+	/* Packets not matching any rule go to the default Traffic Class. */
+	priv->cls_default_cos.ppio = priv->ppio;
+	priv->cls_default_cos.tc = mrvl_qos_cfg ?
+		mrvl_qos_cfg->port[dev->data->port_id].default_tc : 0;
+	priv->cls_tbl_params.default_act.type = PP2_CLS_TBL_ACT_DONE;
+	priv->cls_tbl_params.default_act.cos = &priv->cls_default_cos;
+
+	return pp2_cls_tbl_init(&priv->cls_tbl_params, &priv->cls_tbl);
+}
+
+/**
+ * Push a flow to the classifier table, creating the table if needed.
+ *
+ * @returns 0 in case of success, negative value otherwise.
+ */
+static int
+mrvl_flow_apply(struct rte_eth_dev *dev, struct rte_flow *flow)
+{
+	struct mrvl_priv *priv = dev->data->dev_private;
+	int ret;
+
+	if (!priv->cls_tbl) {
+		ret = mrvl_cls_tbl_init(dev, flow);
+		if (ret) {
+			RTE_LOG(ERR, PMD, "Failed to init classifier table\n");
+			return ret;
+		}
+	}
+
+	flow->cos.ppio = priv->ppio;
+	ret = pp2_cls_tbl_add_rule(priv->cls_tbl, &flow->rule, &flow->action);
+	if (ret) {
+		RTE_LOG(ERR, PMD, "Failed to add classifier rule\n");
+		return ret;
+	}
+
+	flow->applied = 1;
+
+	return 0;
+}
+
+/**
+ * Remove a flow from the port, releasing the table with the last one.
+ *
+ * @returns 0 in case of success, negative value otherwise.
+ */
+static int
+mrvl_flow_remove(struct mrvl_priv *priv, struct rte_flow *flow)
+{
+	int ret;
+
+	if (flow->applied) {
+		ret = pp2_cls_tbl_remove_rule(priv->cls_tbl, &flow->rule);
+		if (ret) {
+			RTE_LOG(ERR, PMD, "Failed to remove classifier rule\n");
+			return ret;
+		}
+	}
+
+	TAILQ_REMOVE(&priv->flows, flow, next);
+	rte_free(flow);
+
+	if (TAILQ_EMPTY(&priv->flows) && priv->cls_tbl) {
+		pp2_cls_tbl_deinit(priv->cls_tbl);
+		priv->cls_tbl = NULL;
+	}
+
+	return 0;
+}
+
+static int
+mrvl_flow_validate(struct rte_eth_dev *dev, const struct rte_flow_attr *attr,
+		   const struct rte_flow_item pattern[],
+		   const struct rte_flow_action actions[],
+		   struct rte_flow_error *error)
+{
+	struct rte_flow *flow;
+	int ret;
+
+	flow = rte_zmalloc("mrvl_flow", sizeof(*flow), 0);
+	if (!flow)
+		return -rte_flow_error_set(error, ENOMEM,
+				RTE_FLOW_ERROR_TYPE_HANDLE, NULL,
+				"Failed to allocate flow");
+
+	ret = mrvl_flow_parse(dev->data->dev_private, attr, pattern, actions,
+			      flow, error);
+	rte_free(flow);
+
+	return ret;
+}
+
+static struct rte_flow *
+mrvl_flow_create(struct rte_eth_dev *dev, const struct rte_flow_attr *attr,
+		 const struct rte_flow_item pattern[],
+		 const struct rte_flow_action actions[],
+		 struct rte_flow_error *error)
+{
+	struct mrvl_priv *priv = dev->data->dev_private;
+	struct rte_flow *flow;
+	int ret;
+
+	flow = rte_zmalloc("mrvl_flow", sizeof(*flow), 0);
+	if (!flow) {
+		rte_flow_error_set(error, ENOMEM, RTE_FLOW_ERROR_TYPE_HANDLE,
+				   NULL, "Failed to allocate flow");
+		return NULL;
+	}
+
+	ret = mrvl_flow_parse(priv, attr, pattern, actions, flow, error);
+	if (ret)
+		goto out_free;
+
+	/* Otherwise flow will be applied once port is started. */
+	if (priv->ppio) {
+		ret = mrvl_flow_apply(dev, flow);
+		if (ret) {
+			rte_flow_error_set(error, EINVAL,
+					   RTE_FLOW_ERROR_TYPE_HANDLE, NULL,
+					   "Failed to apply flow");
+			if (TAILQ_EMPTY(&priv->flows) && priv->cls_tbl) {
+				pp2_cls_tbl_deinit(priv->cls_tbl);
+				priv->cls_tbl = NULL;
+			}
+			goto out_free;
+		}
+	}
+
+	TAILQ_INSERT_TAIL(&priv->flows, flow, next);
+
+	return flow;
+out_free:
+	rte_free(flow);
+	return NULL;
+}
+
+static int
+mrvl_flow_destroy(struct rte_eth_dev *dev, struct rte_flow *flow,
+		  struct rte_flow_error *error)
+{
+	struct mrvl_priv *priv = dev->data->dev_private;
+	struct rte_flow *f;
+
+	TAILQ_FOREACH(f, &priv->flows, next)
+		if (f == flow)
+			break;
+
+	if (!f)
+		return -rte_flow_error_set(error, EINVAL,
+				RTE_FLOW_ERROR_TYPE_HANDLE, flow,
+				"Flow does not belong to the port");
+
+	if (mrvl_flow_remove(priv, flow))
+		return -rte_flow_error_set(error, EINVAL,
+				RTE_FLOW_ERROR_TYPE_HANDLE, flow,
+				"Failed to destroy flow");
+
+	return 0;
+}
+
+static int
+mrvl_flow_flush(struct rte_eth_dev *dev, struct rte_flow_error *error)
+{
+	struct mrvl_priv *priv = dev->data->dev_private;
+	struct rte_flow *flow;
+
+	while ((flow = TAILQ_FIRST(&priv->flows)) != NULL) {
+		if (mrvl_flow_remove(priv, flow))
+			return -rte_flow_error_set(error, EINVAL,
+					RTE_FLOW_ERROR_TYPE_HANDLE, flow,
+					"Failed to flush flows");
+	}
+
+	return 0;
+}
+
+int
+mrvl_flow_start(struct rte_eth_dev *dev)
+{
+	struct mrvl_priv *priv = dev->data->dev_private;
+	struct rte_flow *flow;
+	int ret;
+
+	TAILQ_FOREACH(flow, &priv->flows, next) {
+		if (flow->applied)
+			continue;
+
+		ret = mrvl_flow_apply(dev, flow);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+void
+mrvl_flow_deinit(struct mrvl_priv *priv)
+{
+	struct rte_flow *flow;
+
+	while ((flow = TAILQ_FIRST(&priv->flows)) != NULL) {
+		TAILQ_REMOVE(&priv->flows, flow, next);
+		rte_free(flow);
+	}
+
+	if (priv->cls_tbl) {
+		pp2_cls_tbl_deinit(priv->cls_tbl);
+		priv->cls_tbl = NULL;
+	}
+}
+
+const struct rte_flow_ops mrvl_flow_ops = {
+	.validate = mrvl_flow_validate,
+	.create = mrvl_flow_create,
+	.destroy = mrvl_flow_destroy,
+	.flush = mrvl_flow_flush,
+};
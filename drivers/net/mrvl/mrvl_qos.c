@@ -81,6 +81,10 @@
 /** Maximum possible value of DSCP. */
 #define MAX_DSCP 63
 
+/** Maximum rate limits, 10G line rate. */
+#define MRVL_MAX_THROUGHPUT_KFPS 14881
+#define MRVL_MAX_THROUGHPUT_MBPS 10000
+
 /** Global QoS configuration. */
 struct mrvl_qos_cfg *mrvl_qos_cfg;
 
@@ -144,7 +148,7 @@ get_outq_cfg(struct rte_cfgfile *file, int port, int outq,
 		if (get_val_securely(entry, &val) < 0)
 			return -1;
 		cfg->port[port].outq[outq].rate_limit_params.
-			max_throuput_kfps = val;
+			max_throughput_kfps = val;
 		cfg->port[port].outq[outq].rate_limit = 1;
 	}
 
@@ -154,7 +158,7 @@ get_outq_cfg(struct rte_cfgfile *file, int port, int outq,
 		if (get_val_securely(entry, &val) < 0)
 			return -1;
 		cfg->port[port].outq[outq].rate_limit_params.
-			max_throuput_mbps = val;
+			max_throughput_mbps = val;
 		cfg->port[port].outq[outq].rate_limit = 1;
 	}
 
@@ -208,26 +212,26 @@ get_outq_cfg(struct rte_cfgfile *file, int port, int outq,
 					max_burst_mbps;
 
 		if (cfg->port[port].outq[outq].rate_limit_params.
-			max_throuput_kfps == 0)
+			max_throughput_kfps == 0)
 			cfg->port[port].outq[outq].rate_limit_params.
-				max_throuput_kfps =
+				max_throughput_kfps =
 				cfg->port[port].rate_limit_params.
-					max_throuput_kfps;
+					max_throughput_kfps;
 
 		if (cfg->port[port].outq[outq].rate_limit_params.
-			max_throuput_mbps == 0)
+			max_throughput_mbps == 0)
 			cfg->port[port].outq[outq].rate_limit_params.
-				max_throuput_mbps =
+				max_throughput_mbps =
 				cfg->port[port].rate_limit_params.
-					max_throuput_mbps;
+					max_throughput_mbps;
 		if ((cfg->port[port].outq[outq].rate_limit_params.
 				max_burst_kfps == 0) ||
 			(cfg->port[port].outq[outq].rate_limit_params.
 				max_burst_mbps == 0) ||
 			(cfg->port[port].outq[outq].rate_limit_params.
-					max_throuput_kfps == 0) ||
+					max_throughput_kfps == 0) ||
 			(cfg->port[port].outq[outq].rate_limit_params.
-					max_throuput_mbps == 0))
+					max_throughput_mbps == 0))
 			/* Enabling rate limiting needs setting all values */
 			rte_exit(EXIT_FAILURE,
 				"Default values for port %d needed but not set!\n",
@@ -503,7 +507,7 @@ mrvl_get_qoscfg(const char *key __rte_unused, const char *path,
 			if (get_val_securely(entry, &val) < 0)
 				return -1;
 			(*cfg)->port[n].rate_limit_params.
-				max_throuput_kfps = val;
+				max_throughput_kfps = val;
 			rate_limit = 1;
 		}
 
@@ -513,7 +517,7 @@ mrvl_get_qoscfg(const char *key __rte_unused, const char *path,
 			if (get_val_securely(entry, &val) < 0)
 				return -1;
 			(*cfg)->port[n].rate_limit_params.
-				max_throuput_mbps = val;
+				max_throughput_mbps = val;
 			rate_limit = 1;
 		}
 
@@ -565,9 +569,9 @@ mrvl_get_qoscfg(const char *key __rte_unused, const char *path,
 				((*cfg)->port[n].rate_limit_params.
 						max_burst_mbps == 0) ||
 				((*cfg)->port[n].rate_limit_params.
-						max_throuput_kfps == 0) ||
+						max_throughput_kfps == 0) ||
 				((*cfg)->port[n].rate_limit_params.
-						max_throuput_mbps == 0)))
+						max_throughput_mbps == 0)))
 			/* Enabling rate limiting needs setting all values. */
 			rte_exit(EXIT_FAILURE,
 				"Default values for port %d not set!\n", n);
@@ -747,6 +751,111 @@ mrvl_configure_rxqs(struct mrvl_priv *priv, uint8_t portid,
 	return 0;
 }
 
+/**
+ * Configure TX Queues in a given port.
+ *
+ * Sets up TX queues scheduling and port's and TX queues' rate limits.
+ * Rate limits are applied when port is started.
+ *
+ * @param priv Port's private data
+ * @param portid DPDK port ID
+ * @param max_queues Maximum number of queues to configure.
+ * @returns 0 in case of success, negative value otherwise.
+ */
+int
+mrvl_configure_txqs(struct mrvl_priv *priv, uint8_t portid,
+		uint16_t max_queues)
+{
+	struct pp2_ppio_outq_params *params =
+		priv->ppio_params.outqs_params.outqs_params;
+	struct port_cfg *port_cfg;
+	size_t i;
+
+	memset(&priv->rate_limit, 0, sizeof(priv->rate_limit));
+	memset(priv->txq_rate_limit, 0, sizeof(priv->txq_rate_limit));
+
+	for (i = 0; i < max_queues; ++i)
+		params[i].weight = 1;
+
+	if ((mrvl_qos_cfg == NULL) ||
+		(mrvl_qos_cfg->port[portid].use_global_defaults))
+		return 0;
+
+	port_cfg = &mrvl_qos_cfg->port[portid];
+
+	if (mrvl_rate_limit_check(&port_cfg->rate_limit_params)) {
+		RTE_LOG(ERR, PMD, "Invalid rate limit of port %d!\n", portid);
+		return -1;
+	}
+	priv->rate_limit = port_cfg->rate_limit_params;
+
+	for (i = 0; i < max_queues; ++i) {
+		if (port_cfg->outq[i].sched_mode != PP2_PPIO_SCHED_M_NONE)
+			params[i].sched_mode = port_cfg->outq[i].sched_mode;
+
+		if (port_cfg->outq[i].weight)
+			params[i].weight = port_cfg->outq[i].weight;
+
+		if (!port_cfg->outq[i].rate_limit)
+			continue;
+
+		if (mrvl_rate_limit_check(
+				&port_cfg->outq[i].rate_limit_params)) {
+			RTE_LOG(ERR, PMD,
+				"Invalid rate limit of port %d txq %zu!\n",
+				portid, i);
+			return -1;
+		}
+		priv->txq_rate_limit[i] = port_cfg->outq[i].rate_limit_params;
+	}
+
+	return 0;
+}
+
+/**
+ * Check rate limit parameters.
+ *
+ * Rate and burst must be set together, rates cannot exceed line rate.
+ *
+ * @param rl Rate limit.
+ * @returns 0 in case of success, negative value otherwise.
+ */
+int
+mrvl_rate_limit_check(const struct rte_pmd_mrvl_rate_limit *rl)
+{
+	if (!rl->max_burst_kfps != !rl->max_throughput_kfps)
+		return -1;
+
+	if (!rl->max_burst_mbps != !rl->max_throughput_mbps)
+		return -1;
+
+	if ((rl->max_throughput_kfps > MRVL_MAX_THROUGHPUT_KFPS) ||
+		(rl->max_throughput_mbps > MRVL_MAX_THROUGHPUT_MBPS))
+		return -1;
+
+	return 0;
+}
+
+/**
+ * Convert rate limit to MUSDK token bucket parameters.
+ *
+ * Only bytes limit can be enforced by the hardware.
+ *
+ * @param rl Rate limit.
+ * @param params[out] MUSDK rate limit parameters.
+ * @returns 1 if bytes limit is set, 0 otherwise.
+ */
+int
+mrvl_rate_limit_params(const struct rte_pmd_mrvl_rate_limit *rl,
+		struct pp2_ppio_rate_limit_params *params)
+{
+	/* Committed burst size in kB, committed rate in kbps. */
+	params->cbs = (uint64_t)rl->max_burst_mbps * 1000 / 8;
+	params->cir = (uint64_t)rl->max_throughput_mbps * 1000;
+
+	return rl->max_throughput_mbps != 0;
+}
+
 /**
  * Start QoS mapping.
  *
@@ -44,18 +44,10 @@
 /** Value used as "unknown". */
 #define MRVL_UNKNOWN_TC (0xFF)
 
-/* stubs */
-struct pp2_ppio_rate_limit_params_stub {
-	uint32_t max_burst_kfps;
-	uint32_t max_burst_mbps;
-	uint32_t max_throuput_kfps;
-	uint32_t max_throuput_mbps;
-};
-
 /* QoS config. */
 struct mrvl_qos_cfg {
 	struct port_cfg {
-		struct pp2_ppio_rate_limit_params_stub rate_limit_params;
+		struct rte_pmd_mrvl_rate_limit rate_limit_params;
 		struct {
 			uint8_t inq[MRVL_PP2_RXQ_MAX];
 			uint8_t dscp[MRVL_CP_PER_TC];
@@ -65,7 +57,7 @@ struct mrvl_qos_cfg {
 			uint8_t pcps;
 		} tc[MRVL_PP2_TC_MAX];
 		struct {
-			struct pp2_ppio_rate_limit_params_stub rate_limit_params;
+			struct rte_pmd_mrvl_rate_limit rate_limit_params;
 			enum pp2_ppio_outq_sched_mode sched_mode;
 			uint8_t weight;
 			uint8_t rate_limit;
@@ -109,6 +101,42 @@ int
 mrvl_configure_rxqs(struct mrvl_priv *priv, uint8_t portid,
 		uint16_t max_queues);
 
+/**
+ * Configure TX Queues in a given port.
+ *
+ * Sets up TX queues scheduling and port's and TX queues' rate limits.
+ *
+ * @param priv Port's private data
+ * @param portid DPDK port ID
+ * @param max_queues Maximum number of queues to configure.
+ * @returns 0 in case of success, negative value otherwise.
+ */
+int
+mrvl_configure_txqs(struct mrvl_priv *priv, uint8_t portid,
+		uint16_t max_queues);
+
+/**
+ * Check rate limit parameters.
+ *
+ * @param rl Rate limit.
+ * @returns 0 in case of success, negative value otherwise.
+ */
+int
+mrvl_rate_limit_check(const struct rte_pmd_mrvl_rate_limit *rl);
+
+/**
+ * Convert rate limit to MUSDK token bucket parameters.
+ *
+ * Only bytes limit can be enforced by the hardware.
+ *
+ * @param rl Rate limit.
+ * @param params[out] MUSDK rate limit parameters.
+ * @returns 1 if bytes limit is set, 0 otherwise.
+ */
+int
+mrvl_rate_limit_params(const struct rte_pmd_mrvl_rate_limit *rl,
+		struct pp2_ppio_rate_limit_params *params);
+
 /**
  * Start QoS mapping.
  *
@@ -0,0 +1,127 @@
+/*
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Semihalf. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Semihalf nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file rte_pmd_mrvl.h
+ * Marvell PMD specific functions.
+ *
+ **/
+
+#ifndef _PMD_MRVL_H_
+#define _PMD_MRVL_H_
+
+#include <rte_ethdev.h>
+
+/**
+ * Egress rate limit.
+ *
+ * Token bucket parameters, a zero pair leaves given unit unlimited.
+ * Byte limits are enforced by the hardware, packet limits and byte limits
+ * the hardware refused are enforced by the driver on the tx path.
+ */
+struct rte_pmd_mrvl_rate_limit {
+	uint32_t max_burst_kfps;      /**< Bucket size, thousands of frames */
+	uint32_t max_burst_mbps;      /**< Bucket size, megabits */
+	uint32_t max_throughput_kfps; /**< Rate, thousands of frames/s */
+	uint32_t max_throughput_mbps; /**< Rate, megabits/s */
+};
+
+/** Tx queue scheduling mode. */
+enum rte_pmd_mrvl_sched_mode {
+	RTE_PMD_MRVL_SCHED_SP,  /**< Strict priority */
+	RTE_PMD_MRVL_SCHED_WRR, /**< Weighted round robin */
+};
+
+/**
+ * Set egress rate limit of the port.
+ *
+ * Can be called at any time, also while traffic is running.
+ *
+ * @param port
+ *   The port identifier of the Ethernet device.
+ * @param rl
+ *   Rate limit, NULL disables it.
+ * @return
+ *   - (0) if successful.
+ *   - (-ENODEV) if *port* invalid.
+ *   - (-ENOTSUP) if *port* is not a Marvell port.
+ *   - (-EINVAL) if *rl* is invalid.
+ */
+int rte_pmd_mrvl_set_port_rate_limit(uint8_t port,
+		const struct rte_pmd_mrvl_rate_limit *rl);
+
+/**
+ * Set egress rate limit of the tx queue.
+ *
+ * Can be called at any time, also while traffic is running.
+ *
+ * @param port
+ *   The port identifier of the Ethernet device.
+ * @param queue
+ *   Tx queue index.
+ * @param rl
+ *   Rate limit, NULL disables it.
+ * @return
+ *   - (0) if successful.
+ *   - (-ENODEV) if *port* invalid.
+ *   - (-ENOTSUP) if *port* is not a Marvell port.
+ *   - (-EINVAL) if *queue* or *rl* is invalid.
+ */
+int rte_pmd_mrvl_set_txq_rate_limit(uint8_t port, uint16_t queue,
+		const struct rte_pmd_mrvl_rate_limit *rl);
+
+/**
+ * Set scheduling of the tx queue.
+ *
+ * Hardware arbiter is programmed when port is started for the first time,
+ * hence scheduling cannot be changed afterwards.
+ *
+ * @param port
+ *   The port identifier of the Ethernet device.
+ * @param queue
+ *   Tx queue index.
+ * @param mode
+ *   Scheduling mode.
+ * @param weight
+ *   Queue weight, used in WRR mode only.
+ * @return
+ *   - (0) if successful.
+ *   - (-ENODEV) if *port* invalid.
+ *   - (-ENOTSUP) if *port* is not a Marvell port.
+ *   - (-EINVAL) if *queue*, *mode* or *weight* is invalid.
+ *   - (-EBUSY) if *port* was already started.
+ */
+int rte_pmd_mrvl_set_txq_sched(uint8_t port, uint16_t queue,
+		enum rte_pmd_mrvl_sched_mode mode, uint8_t weight);
+
+#endif /* _PMD_MRVL_H_ */
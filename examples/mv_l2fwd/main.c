@@ -44,6 +44,7 @@
 #include <getopt.h>
 #include <signal.h>
 #include <stdbool.h>
+#include <limits.h>
 
 #include <rte_common.h>
 #include <rte_vect.h>
@@ -70,36 +71,9 @@
 #include <rte_mempool.h>
 #include <rte_mbuf.h>
 #include <rte_string_fns.h>
+#include <rte_malloc.h>
+#include <rte_metrics.h>
 
-//#define CHECK_CYCLES
-#ifdef CHECK_CYCLES
-#include <sys/time.h>   // for gettimeofday()
-#define CLK_MHZ 2000
-static signed int long long usecs1=0, cnt1=0;
-static struct timeval t1, t2;
-
-#define START_COUNT_CYCLES \
-	gettimeofday(&t1, NULL);
-#define STOP_N_REPORT_COUNT_CYCLES(_num,_max) \
-	do { \
-		gettimeofday(&t2, NULL); \
-		/* compute and print the elapsed time in millisec */ \
-		if (_num) { \
-			usecs1 += (t2.tv_sec - t1.tv_sec) * 1000000.0; \
-			usecs1 += (t2.tv_usec - t1.tv_usec); \
-			cnt1+=_num; \
-		} \
-		if (cnt1 >= _max) { \
-			printf("Cycles count: %lld\n", \
-			usecs1*CLK_MHZ/cnt1); \
-			usecs1=cnt1=0; \
-		} \
-	} while (0);
-
-#else
-#define START_COUNT_CYCLES
-#define STOP_N_REPORT_COUNT_CYCLES(_num,_max)
-#endif /* CHECK_CYCLES */
 
 
 #define RTE_LOGTYPE_L2FWD RTE_LOGTYPE_USER1
@@ -124,6 +98,16 @@ static struct timeval t1, t2;
 /* Configure how many packets ahead to prefetch, when reading packets */
 #define PREFETCH_OFFSET	  3
 
+/*
+ * Number of buckets in the per lcore RX burst size histogram:
+ * 0, 1, 2-3, 4-7, ..., MAX_PKT_BURST / 2 .. MAX_PKT_BURST - 1, MAX_PKT_BURST.
+ */
+#define BURST_HIST_SIZE 10
+
+#define MAX_TIMER_PERIOD 86400 /* 1 day max */
+
+#define BURST_TX_DRAIN_US 100 /* TX drain every ~100us */
+
 /* Used to mark destination port as 'invalid'. */
 #define	BAD_PORT ((uint16_t)-1)
 
@@ -142,9 +126,19 @@ struct lcore_rx_queue {
 	uint8_t dest_port_id;
 } __rte_cache_aligned;
 
+struct lcore_tx_queue {
+	struct rte_eth_dev_tx_buffer *buffer;
+	struct lcore_stats *stats;
+	uint16_t queue_id;
+	uint8_t port_id;
+};
+
 struct lcore_conf {
 	uint16_t n_rx_queue;
+	uint16_t n_tx_port;
 	struct lcore_rx_queue rx_queue_list[MAX_RX_QUEUE_PER_LCORE];
+	uint8_t tx_port_id[RTE_MAX_ETHPORTS];
+	struct lcore_tx_queue tx_queue[RTE_MAX_ETHPORTS];
 } __rte_cache_aligned;
 
 
@@ -157,6 +151,9 @@ static int numa_on = 1; /**< NUMA is enabled by default. */
 
 volatile bool force_quit;
 
+/* Number of TX retries on back-pressure before dropping, 0 by default */
+static unsigned tx_retry;
+
 /* MAC updating enabled by default */
 static int mac_updating = 0;
 static int burst_size = 0;
@@ -174,6 +171,72 @@ static uint32_t dst_ports[RTE_MAX_ETHPORTS];
 
 struct lcore_conf lcore_conf[RTE_MAX_LCORE];
 
+/*
+ * Per lcore forwarding statistics. Written by the owning lcore only and
+ * read by the master lcore when printing, hence no locking.
+ */
+struct lcore_stats {
+	uint64_t rx_pkts;
+	uint64_t tx_pkts;
+	uint64_t drop_pkts;
+	uint64_t rx_cycles;
+	uint64_t proc_cycles;
+	uint64_t tx_cycles;
+	uint64_t polls;
+	uint64_t empty_polls;
+	uint64_t burst_hist[BURST_HIST_SIZE];
+} __rte_cache_aligned;
+
+#define LCORE_STATS_NB \
+	(offsetof(struct lcore_stats, burst_hist) / sizeof(uint64_t) + \
+	 BURST_HIST_SIZE)
+
+static struct lcore_stats lcore_stats[RTE_MAX_LCORE];
+
+/* Metric names, in struct lcore_stats order. */
+static const char * const lcore_stats_names[LCORE_STATS_NB] = {
+	"rx_packets",
+	"tx_packets",
+	"dropped_packets",
+	"rx_cycles",
+	"proc_cycles",
+	"tx_cycles",
+	"polls",
+	"empty_polls",
+	"burst_0",
+	"burst_1",
+	"burst_2_3",
+	"burst_4_7",
+	"burst_8_15",
+	"burst_16_31",
+	"burst_32_63",
+	"burst_64_127",
+	"burst_128_255",
+	"burst_256",
+};
+
+/* First librte_metrics key of every lcore, -1 if not registered. */
+static int lcore_metrics_key[RTE_MAX_LCORE];
+
+#define POOL_STATS_NB \
+	(sizeof(struct rte_mempool_cache_stats) / sizeof(uint64_t))
+
+/* Mbuf pool cache metric names, in struct rte_mempool_cache_stats order. */
+static const char * const pool_stats_names[POOL_STATS_NB] = {
+	"cache_get_hits",
+	"cache_get_misses",
+	"cache_put_hits",
+	"cache_put_misses",
+	"cache_refills",
+	"cache_flushes",
+};
+
+/* First librte_metrics key of every mbuf pool, -1 if not registered. */
+static int pool_metrics_key[NB_SOCKETS];
+
+/* Statistics printout period in seconds, 0 disables it. */
+static uint64_t timer_period = 10;
+
 struct lcore_params {
 	uint8_t port_id;
 	uint8_t queue_id;
@@ -354,15 +417,19 @@ print_usage(const char *prgname)
 	printf("%s [EAL options] --"
 		" -p PORTMASK"
 		" [-P]"
+		" [-T PERIOD]"
 		" --config (port,queue,lcore)[,(port,queue,lcore)]"
 		" [--enable-jumbo [--max-pkt-len PKTLEN]]"
+		" [--tx-retry N]"
 		"  -p PORTMASK: Hexadecimal bitmask of ports to configure\n"
 		"  -P : Enable promiscuous mode\n"
 		"  -b BURST: Burst size\n"
+		"  -T PERIOD: statistics will be refreshed each PERIOD seconds (0 to disable, 10 default)\n"
 		"  --config (port,queue,lcore): Rx queue configuration\n"
 		"  --enable-jumbo: Enable jumbo frames\n"
 		"  --max-pkt-len: Under the premise of enabling jumbo,\n"
 		"                 maximum packet length in decimal (64-9600)\n"
+		"  --tx-retry N: Retry a TX burst up to N times on back-pressure before dropping (0 default)\n"
 		"  --[no-]mac-updating: Enable or disable MAC addresses updating (disabled by default)\n"
 		"      When enabled:\n"
 		"       - The source MAC address is replaced by the TX port MAC address\n"
@@ -404,6 +471,38 @@ parse_portmask(const char *portmask)
 	return pm;
 }
 
+static int
+parse_timer_period(const char *q_arg)
+{
+	char *end = NULL;
+	long n;
+
+	/* parse number string */
+	n = strtol(q_arg, &end, 10);
+	if ((q_arg[0] == '\0') || (end == NULL) || (*end != '\0'))
+		return -1;
+	if (n < 0 || n >= MAX_TIMER_PERIOD)
+		return -1;
+
+	return n;
+}
+
+static int
+parse_tx_retry(const char *q_arg)
+{
+	char *end = NULL;
+	unsigned long n;
+
+	/* parse decimal string */
+	n = strtoul(q_arg, &end, 10);
+	if ((q_arg[0] == '\0') || (end == NULL) || (*end != '\0'))
+		return -1;
+	if (n > INT_MAX)
+		return -1;
+
+	return n;
+}
+
 static int
 parse_config(const char *q_arg)
 {
@@ -464,12 +563,14 @@ static const char short_options[] =
 	"p:"  /* portmask */
 	"P"   /* promiscuous */
 	"b:"  /* burst size */
+	"T:"  /* timer period */
 	;
 
 #define CMD_LINE_OPT_CONFIG "config"
  #define CMD_LINE_OPT_ENABLE_JUMBO "enable-jumbo"
 #define CMD_LINE_OPT_MAC_UPDATING "mac-updating"
 #define CMD_LINE_OPT_NO_MAC_UPDATING "no-mac-updating"
+#define CMD_LINE_OPT_TX_RETRY "tx-retry"
 
 enum {
 	/* long options mapped to a short option */
@@ -481,6 +582,7 @@ enum {
  	CMD_LINE_OPT_ENABLE_JUMBO_NUM,
 	CMD_LINE_OPT_MAC_UPDATING_NUM,
 	CMD_LINE_OPT_NO_MAC_UPDATING_NUM,
+	CMD_LINE_OPT_TX_RETRY_NUM,
 };
 
 static const struct option lgopts[] = {
@@ -488,6 +590,7 @@ static const struct option lgopts[] = {
  	{CMD_LINE_OPT_ENABLE_JUMBO, 0, 0, CMD_LINE_OPT_ENABLE_JUMBO_NUM},
 	{CMD_LINE_OPT_MAC_UPDATING, 0, 0, CMD_LINE_OPT_MAC_UPDATING_NUM},
 	{CMD_LINE_OPT_NO_MAC_UPDATING, 0, 0, CMD_LINE_OPT_NO_MAC_UPDATING_NUM},
+	{CMD_LINE_OPT_TX_RETRY, 1, 0, CMD_LINE_OPT_TX_RETRY_NUM},
 	{NULL, 0, 0, 0}
 };
 
@@ -551,6 +654,17 @@ parse_args(int argc, char **argv)
 			printf("Burst Size: %d\n", burst_size);
 			break;
 
+		/* timer period */
+		case 'T':
+			ret = parse_timer_period(optarg);
+			if (ret < 0) {
+				printf("invalid timer period\n");
+				print_usage(prgname);
+				return -1;
+			}
+			timer_period = ret;
+			break;
+
 
 		/* long options */
 		case CMD_LINE_OPT_CONFIG_NUM:
@@ -598,6 +712,16 @@ parse_args(int argc, char **argv)
 			mac_updating = 0;
 			break;
 
+		case CMD_LINE_OPT_TX_RETRY_NUM:
+			ret = parse_tx_retry(optarg);
+			if (ret < 0) {
+				printf("invalid tx retry count\n");
+				print_usage(prgname);
+				return -1;
+			}
+			tx_retry = ret;
+			break;
+
 		default:
 			print_usage(prgname);
 			return -1;
@@ -641,26 +765,225 @@ mac_update(struct rte_mbuf *m, unsigned dest_portid)
 	ether_addr_copy(&ports_eth_addr[dest_portid], &eth->s_addr);
 }
 
+/* Map a RX burst size to its histogram bucket. */
+static inline unsigned
+burst_hist_idx(unsigned nb_rx)
+{
+	return nb_rx ? 32 - __builtin_clz(nb_rx) : 0;
+}
+
+/* Register the per lcore statistics with librte_metrics. */
+static void
+lcore_stats_metrics_init(void)
+{
+	char names[LCORE_STATS_NB][RTE_METRICS_MAX_NAME_LEN];
+	const char *name_ptrs[LCORE_STATS_NB];
+	unsigned lcore_id, i;
+	int ret;
+
+	rte_metrics_init(rte_socket_id());
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		lcore_metrics_key[lcore_id] = -1;
+		if (lcore_conf[lcore_id].n_rx_queue == 0)
+			continue;
+
+		for (i = 0; i < LCORE_STATS_NB; i++) {
+			snprintf(names[i], sizeof(names[i]), "lcore%u_%s",
+				 lcore_id, lcore_stats_names[i]);
+			name_ptrs[i] = names[i];
+		}
+
+		ret = rte_metrics_reg_names(name_ptrs, LCORE_STATS_NB);
+		if (ret < 0) {
+			RTE_LOG(WARNING, L2FWD,
+				"Cannot register metrics for lcore %u: %d\n",
+				lcore_id, ret);
+			continue;
+		}
+		lcore_metrics_key[lcore_id] = ret;
+	}
+}
+
+/* Register the cache statistics of the mbuf pools with librte_metrics. */
+static void
+pool_stats_metrics_init(void)
+{
+	char names[POOL_STATS_NB][RTE_METRICS_MAX_NAME_LEN];
+	const char *name_ptrs[POOL_STATS_NB];
+	unsigned socketid, i;
+	int ret;
+
+	for (socketid = 0; socketid < NB_SOCKETS; socketid++) {
+		pool_metrics_key[socketid] = -1;
+		if (pktmbuf_pool[socketid] == NULL)
+			continue;
+
+		for (i = 0; i < POOL_STATS_NB; i++) {
+			snprintf(names[i], sizeof(names[i]), "%s_%s",
+				 pktmbuf_pool[socketid]->name,
+				 pool_stats_names[i]);
+			name_ptrs[i] = names[i];
+		}
+
+		ret = rte_metrics_reg_names(name_ptrs, POOL_STATS_NB);
+		if (ret < 0) {
+			RTE_LOG(WARNING, L2FWD,
+				"Cannot register metrics for %s: %d\n",
+				pktmbuf_pool[socketid]->name, ret);
+			continue;
+		}
+		pool_metrics_key[socketid] = ret;
+	}
+}
+
+/*
+ * Print the per lcore and mbuf pool cache statistics and publish them
+ * through librte_metrics.
+ */
+static void
+print_stats(void)
+{
+	const struct lcore_stats *stats;
+	struct rte_mempool_cache_stats pool_stats;
+	uint64_t pkts, polls;
+	unsigned lcore_id, socketid, i;
+
+	printf("\nLcore statistics ===================================");
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (lcore_conf[lcore_id].n_rx_queue == 0)
+			continue;
+
+		stats = &lcore_stats[lcore_id];
+		pkts = stats->rx_pkts ? stats->rx_pkts : 1;
+		polls = stats->polls ? stats->polls : 1;
+
+		printf("\nlcore %u: received: %"PRIu64", sent: %"PRIu64
+		       ", dropped: %"PRIu64
+		       "\n  cycles/pkt: rx %.1f, processing %.1f, tx %.1f"
+		       "\n  empty polls: %.1f%%\n  burst histogram:",
+		       lcore_id, stats->rx_pkts, stats->tx_pkts,
+		       stats->drop_pkts,
+		       (double)stats->rx_cycles / pkts,
+		       (double)stats->proc_cycles / pkts,
+		       (double)stats->tx_cycles / pkts,
+		       100.0 * stats->empty_polls / polls);
+		for (i = 0; i < BURST_HIST_SIZE; i++)
+			if (stats->burst_hist[i])
+				printf(" %s=%"PRIu64,
+				       lcore_stats_names[LCORE_STATS_NB -
+							 BURST_HIST_SIZE + i] +
+				       strlen("burst_"),
+				       stats->burst_hist[i]);
+
+		if (lcore_metrics_key[lcore_id] >= 0)
+			rte_metrics_update_values(RTE_METRICS_GLOBAL,
+				lcore_metrics_key[lcore_id],
+				(const uint64_t *)stats, LCORE_STATS_NB);
+	}
+
+	for (socketid = 0; socketid < NB_SOCKETS; socketid++) {
+		if (pktmbuf_pool[socketid] == NULL)
+			continue;
+
+		rte_mempool_cache_stats_get(pktmbuf_pool[socketid],
+					    &pool_stats);
+		printf("\n%s cache: get misses: %"PRIu64
+		       ", put misses: %"PRIu64", refills: %"PRIu64
+		       ", flushes: %"PRIu64,
+		       pktmbuf_pool[socketid]->name, pool_stats.get_misses,
+		       pool_stats.put_misses, pool_stats.refills,
+		       pool_stats.flushes);
+
+		if (pool_metrics_key[socketid] >= 0)
+			rte_metrics_update_values(RTE_METRICS_GLOBAL,
+				pool_metrics_key[socketid],
+				(const uint64_t *)&pool_stats, POOL_STATS_NB);
+	}
+	printf("\n====================================================\n");
+}
+
+/*
+ * TX buffer error callback: retry the unsent packets up to tx_retry times
+ * and drop whatever the queue still does not accept.
+ */
+static void
+tx_buffer_unsent_cb(struct rte_mbuf **unsent, uint16_t count, void *userdata)
+{
+	struct lcore_tx_queue *txq = userdata;
+	uint16_t sent = 0;
+	unsigned retry;
+
+	for (retry = 0; retry < tx_retry && sent < count; retry++)
+		sent += rte_eth_tx_burst(txq->port_id, txq->queue_id,
+					 &unsent[sent], count - sent);
+
+	txq->stats->tx_pkts += sent;
+	txq->stats->drop_pkts += count - sent;
+
+	for (; sent < count; sent++)
+		rte_pktmbuf_free(unsent[sent]);
+}
+
+/* Set up the TX buffer of an lcore towards a destination port. */
+static void
+init_lcore_tx_queue(unsigned lcore_id, uint8_t portid, int socketid)
+{
+	struct lcore_conf *qconf = &lcore_conf[lcore_id];
+	struct lcore_tx_queue *txq = &qconf->tx_queue[portid];
+	int ret;
+
+	if (txq->buffer != NULL)
+		return;
+
+	txq->buffer = rte_zmalloc_socket("tx_buffer",
+			RTE_ETH_TX_BUFFER_SIZE(burst_size), 0, socketid);
+	if (txq->buffer == NULL)
+		rte_exit(EXIT_FAILURE,
+			"Cannot allocate buffer for tx on port %u\n", portid);
+
+	rte_eth_tx_buffer_init(txq->buffer, burst_size);
+
+	ret = rte_eth_tx_buffer_set_err_callback(txq->buffer,
+			tx_buffer_unsent_cb, txq);
+	if (ret < 0)
+		rte_exit(EXIT_FAILURE,
+			"Cannot set error callback for tx buffer on port %u\n",
+			portid);
+
+	txq->stats = &lcore_stats[lcore_id];
+	txq->port_id = portid;
+	qconf->tx_port_id[qconf->n_tx_port++] = portid;
+}
+
 /* main processing loop */
 static int
 main_loop(__attribute__((unused)) void *dummy)
 {
 	struct rte_mbuf *pkts_burst[MAX_PKT_BURST];
 	struct rte_mbuf *m;
-	unsigned lcore_id, drop_pkts = 0, rx_pkts = 0, tx_pkts = 0;
-	uint64_t prev_tsc, diff_tsc, cur_tsc;
+	struct lcore_stats *stats;
+	struct lcore_tx_queue *txq;
+	unsigned lcore_id;
+	uint64_t prev_tsc, timer_tsc, drain_prev_tsc, t_rx, t_proc, t_tx, t_end;
 	int i, j, nb_rx;
 	int sent, nbq = 0;
-	uint8_t portid, queueid, dst_port;//, burst = MAX_PKT_BURST;
+	uint8_t portid, queueid, dst_port;
 	struct lcore_conf *qconf;
-	const uint64_t drain_tsc = (rte_get_tsc_hz() + US_PER_S - 1) * 5 + US_PER_S*rte_lcore_id();
-
-	prev_tsc = 0;
+	const uint64_t drain_tsc = (rte_get_tsc_hz() + US_PER_S - 1) /
+		US_PER_S * BURST_TX_DRAIN_US;
 
 	lcore_id = rte_lcore_id();
 	qconf = &lcore_conf[lcore_id];
+	stats = &lcore_stats[lcore_id];
 
-	if (qconf->n_rx_queue == 0) {
+	/* Only the master lcore refreshes statistics. */
+	timer_tsc = 0;
+	if (lcore_id == rte_get_master_lcore())
+		timer_tsc = timer_period * rte_get_timer_hz();
+
+	if (qconf->n_rx_queue == 0 && timer_tsc == 0) {
 		RTE_LOG(INFO, L2FWD, "lcore %u has nothing to do\n", lcore_id);
 		return 0;
 	}
@@ -678,19 +1001,31 @@ main_loop(__attribute__((unused)) void *dummy)
 	const int burst = burst_size;
 	RTE_LOG(INFO, L2FWD, "entering main loop on lcore %u, burst: %d\n", lcore_id, burst);
 
+	prev_tsc = rte_rdtsc();
+	drain_prev_tsc = prev_tsc;
+	t_rx = prev_tsc;
+
 	while (!force_quit) {
-		cur_tsc = rte_rdtsc() + US_PER_S*lcore_id;
 
 		/*
 		 * TX burst queue drain
 		 */
-		diff_tsc = cur_tsc - prev_tsc;
-		if (unlikely(diff_tsc > drain_tsc)) {
+		if (unlikely(t_rx - drain_prev_tsc > drain_tsc)) {
+			for (i = 0; i < qconf->n_tx_port; ++i) {
+				txq = &qconf->tx_queue[qconf->tx_port_id[i]];
+				stats->tx_pkts += rte_eth_tx_buffer_flush(
+					txq->port_id, txq->queue_id,
+					txq->buffer);
+			}
+			drain_prev_tsc = t_rx;
+		}
 
-			prev_tsc = cur_tsc;
-			if (unlikely(drop_pkts))
-				printf("Core%d: Receved: %u packets, Sent: %u packets, Dropped: %u packets\n",
-					lcore_id, rx_pkts, tx_pkts, drop_pkts);
+		/*
+		 * Statistics printout
+		 */
+		if (unlikely(timer_tsc && t_rx - prev_tsc > timer_tsc)) {
+			print_stats();
+			prev_tsc = t_rx;
 		}
 
 		/*
@@ -701,9 +1036,8 @@ main_loop(__attribute__((unused)) void *dummy)
 			queueid = qconf->rx_queue_list[i].queue_id;
 			dst_port = qconf->rx_queue_list[i].dest_port_id;
 
-START_COUNT_CYCLES
 			nb_rx = rte_eth_rx_burst(portid, queueid, pkts_burst, burst);
-STOP_N_REPORT_COUNT_CYCLES((unsigned int)nb_rx,50000000)
+			t_proc = rte_rdtsc();
 
 			if (mac_updating) {
 				for (j = 0; j < nb_rx; j++) {
@@ -712,19 +1046,36 @@ STOP_N_REPORT_COUNT_CYCLES((unsigned int)nb_rx,50000000)
 					mac_update(m, dst_port);
 				}
 			}
-//START_COUNT_CYCLES
-			sent = rte_eth_tx_burst(dst_port, queueid, pkts_burst, nb_rx);
-//STOP_N_REPORT_COUNT_CYCLES((unsigned int)nb_rx,50000000)
-
-			if (unlikely(sent < nb_rx)) {
-				do {
-					rte_pktmbuf_free(pkts_burst[sent]);
-				} while (++sent < nb_rx);
-			}
-			rx_pkts += nb_rx;
-			tx_pkts += sent;
-			drop_pkts += (nb_rx - sent);
+			t_tx = rte_rdtsc();
+
+			txq = &qconf->tx_queue[dst_port];
+			for (j = 0, sent = 0; j < nb_rx; j++)
+				sent += rte_eth_tx_buffer(dst_port,
+							  txq->queue_id,
+							  txq->buffer,
+							  pkts_burst[j]);
+			stats->tx_pkts += sent;
+			t_end = rte_rdtsc();
+
+			stats->rx_cycles += t_proc - t_rx;
+			stats->proc_cycles += t_tx - t_proc;
+			stats->tx_cycles += t_end - t_tx;
+			stats->polls++;
+			stats->empty_polls += (nb_rx == 0);
+			stats->burst_hist[burst_hist_idx(nb_rx)]++;
+			stats->rx_pkts += nb_rx;
+			t_rx = t_end;
 		}
+
+		if (qconf->n_rx_queue == 0)
+			t_rx = rte_rdtsc();
+	}
+
+	/* Send what is left in the TX buffers before the ports are stopped. */
+	for (i = 0; i < qconf->n_tx_port; ++i) {
+		txq = &qconf->tx_queue[qconf->tx_port_id[i]];
+		stats->tx_pkts += rte_eth_tx_buffer_flush(txq->port_id,
+				txq->queue_id, txq->buffer);
 	}
 
 	return 0;
@@ -853,6 +1204,8 @@ main(int argc, char **argv)
 	uint32_t n_tx_queue, nb_lcores;
 	uint8_t portid, nb_rx_queue, queue, socketid;
 
+	RTE_BUILD_BUG_ON(MAX_PKT_BURST != 1 << (BURST_HIST_SIZE - 2));
+
 	rte_set_application_usage_hook(print_usage);
 
 	/* init EAL */
@@ -951,6 +1304,7 @@ main(int argc, char **argv)
 					"port=%d\n", ret, portid);
 
 			qconf = &lcore_conf[lcore_id];
+			qconf->tx_queue[portid].queue_id = queueid;
 			queueid++;
 
 		}
@@ -974,6 +1328,9 @@ main(int argc, char **argv)
 			else
 				socketid = 0;
 
+			init_lcore_tx_queue(lcore_id, dst_ports[portid],
+					    socketid);
+
 			printf("rxq=%d,%d,%d ", portid, queueid, socketid);
 			fflush(stdout);
 
@@ -1035,6 +1392,9 @@ main(int argc, char **argv)
 
 	check_all_ports_link_status((uint8_t)nb_ports, enabled_port_mask);
 
+	lcore_stats_metrics_init();
+	pool_stats_metrics_init();
+
 	ret = 0;
 	/* launch per-lcore init on every lcore */
 	rte_eal_mp_remote_launch(main_loop, NULL, CALL_MASTER);
@@ -1045,6 +1405,8 @@ main(int argc, char **argv)
 		}
 	}
 
+	print_stats();
+
 	/* stop ports */
 	for (portid = 0; portid < nb_ports; portid++) {
 		if ((enabled_port_mask & (1 << portid)) == 0)
@@ -122,8 +122,10 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	void *k = NULL;
 	void *buckets = NULL;
 	char ring_name[RTE_RING_NAMESIZE];
+	uint32_t *tbl_chng_cnt = NULL;
 	unsigned num_key_slots;
 	unsigned hw_trans_mem_support = 0;
+	unsigned readwrite_concur_lf_support = 0;
 	unsigned i;
 
 	hash_list = RTE_TAILQ_CAST(rte_hash_tailq.head, rte_hash_list);
@@ -147,6 +149,17 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	if (params->extra_flag & RTE_HASH_EXTRA_FLAGS_TRANS_MEM_SUPPORT)
 		hw_trans_mem_support = 1;
 
+	if (params->extra_flag & RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF) {
+		/* Lock-free lookups only support a single writer */
+		if (params->extra_flag & RTE_HASH_EXTRA_FLAGS_MULTI_WRITER_ADD) {
+			rte_errno = EINVAL;
+			RTE_LOG(ERR, HASH, "rte_hash_create lock-free reader "
+				"concurrency is not supported with multi-writer\n");
+			return NULL;
+		}
+		readwrite_concur_lf_support = 1;
+	}
+
 	/* Store all keys and leave the first entry as a dummy entry for lookup_bulk */
 	if (hw_trans_mem_support)
 		/*
@@ -223,6 +236,15 @@ rte_hash_create(const struct rte_hash_parameters *params)
 		goto err_unlock;
 	}
 
+	if (readwrite_concur_lf_support) {
+		tbl_chng_cnt = rte_zmalloc_socket(NULL, sizeof(uint32_t),
+				RTE_CACHE_LINE_SIZE, params->socket_id);
+		if (tbl_chng_cnt == NULL) {
+			RTE_LOG(ERR, HASH, "memory allocation failed\n");
+			goto err_unlock;
+		}
+	}
+
 /*
  * If x86 architecture is used, select appropriate compare function,
  * which may use x86 intrinsics, otherwise use memcmp
@@ -283,6 +305,8 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	h->key_store = k;
 	h->free_slots = r;
 	h->hw_trans_mem_support = hw_trans_mem_support;
+	h->readwrite_concur_lf_support = readwrite_concur_lf_support;
+	h->tbl_chng_cnt = tbl_chng_cnt;
 
 #if defined(RTE_ARCH_X86)
 	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2))
@@ -326,6 +350,7 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	rte_free(h);
 	rte_free(buckets);
 	rte_free(k);
+	rte_free(tbl_chng_cnt);
 	return NULL;
 }
 
@@ -365,6 +390,7 @@ rte_hash_free(struct rte_hash *h)
 	rte_ring_free(h->free_slots);
 	rte_free(h->key_store);
 	rte_free(h->buckets);
+	rte_free(h->tbl_chng_cnt);
 	rte_free(h);
 	rte_free(te);
 }
@@ -388,6 +414,42 @@ rte_hash_secondary_hash(const hash_sig_t primary_hash)
 	return primary_hash ^ ((tag + 1) * alt_bits_xor);
 }
 
+/*
+ * Called by the writer before it overwrites an entry which was copied to
+ * its alternative location: a lock-free reader may have looked for that
+ * key in the alternative bucket before the copy, and now miss it in the
+ * original one. Such readers see the counter change and search again.
+ */
+static inline void
+tbl_chng_cnt_inc(const struct rte_hash *h)
+{
+	if (h->readwrite_concur_lf_support) {
+		/* the copy is visible before the counter */
+		rte_smp_wmb();
+		(*h->tbl_chng_cnt)++;
+		/* the counter is visible before the overwrite */
+		rte_smp_wmb();
+	}
+}
+
+/* Read the change counter before a lock-free search */
+static inline uint32_t
+tbl_chng_cnt_read(const struct rte_hash *h)
+{
+	uint32_t cnt = *(volatile uint32_t *)h->tbl_chng_cnt;
+
+	rte_smp_rmb();
+	return cnt;
+}
+
+/* Check after a lock-free search whether keys were moved meanwhile */
+static inline int
+tbl_chng_cnt_changed(const struct rte_hash *h, uint32_t cnt)
+{
+	rte_smp_rmb();
+	return *(volatile uint32_t *)h->tbl_chng_cnt != cnt;
+}
+
 void
 rte_hash_reset(struct rte_hash *h)
 {
@@ -474,6 +536,8 @@ make_space_bucket(const struct rte_hash *h, struct rte_hash_bucket *bkt)
 	bkt->flag[i] = 0;
 	nr_pushes = 0;
 	if (ret >= 0) {
+		/* the entry at next_bkt[i]->key_idx[ret] was pushed */
+		tbl_chng_cnt_inc(h);
 		next_bkt[i]->sig_alt[ret] = bkt->sig_current[i];
 		next_bkt[i]->sig_current[ret] = bkt->sig_alt[i];
 		next_bkt[i]->key_idx[ret] = bkt->key_idx[i];
@@ -600,6 +664,10 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 	rte_memcpy(new_k->key, key, h->key_len);
 	new_k->pdata = data;
 
+	/* Lock-free readers must see the key before its bucket entry */
+	if (h->readwrite_concur_lf_support)
+		rte_smp_wmb();
+
 #if defined(RTE_ARCH_X86) /* currently only x86 support HTM */
 	if (h->add_key == ADD_KEY_MULTIWRITER_TM) {
 		ret = rte_hash_cuckoo_insert_mw_tm(prim_bkt,
@@ -646,6 +714,8 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 		 */
 		ret = make_space_bucket(h, prim_bkt);
 		if (ret >= 0) {
+			/* the entry at prim_bkt->key_idx[ret] was pushed */
+			tbl_chng_cnt_inc(h);
 			prim_bkt->sig_current[ret] = sig;
 			prim_bkt->sig_alt[ret] = alt_hash;
 			prim_bkt->key_idx[ret] = new_idx;
@@ -707,10 +777,10 @@ rte_hash_add_key_data(const struct rte_hash *h, const void *key, void *data)
 		return ret;
 }
 static inline int32_t
-__rte_hash_lookup_with_hash(const struct rte_hash *h, const void *key,
+search_buckets(const struct rte_hash *h, const void *key,
 					hash_sig_t sig, void **data)
 {
-	uint32_t bucket_idx;
+	uint32_t bucket_idx, key_idx;
 	hash_sig_t alt_hash;
 	unsigned i;
 	struct rte_hash_bucket *bkt;
@@ -719,12 +789,17 @@ __rte_hash_lookup_with_hash(const struct rte_hash *h, const void *key,
 	bucket_idx = sig & h->bucket_bitmask;
 	bkt = &h->buckets[bucket_idx];
 
+	/*
+	 * The key index is read once: a lock-free reader may otherwise see
+	 * it change between the check and the use.
+	 */
+
 	/* Check if key is in primary location */
 	for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
-		if (bkt->sig_current[i] == sig &&
-				bkt->key_idx[i] != EMPTY_SLOT) {
+		key_idx = bkt->key_idx[i];
+		if (bkt->sig_current[i] == sig && key_idx != EMPTY_SLOT) {
 			k = (struct rte_hash_key *) ((char *)keys +
-					bkt->key_idx[i] * h->key_entry_size);
+					key_idx * h->key_entry_size);
 			if (rte_hash_cmp_eq(key, k->key, h) == 0) {
 				if (data != NULL)
 					*data = k->pdata;
@@ -732,7 +807,7 @@ __rte_hash_lookup_with_hash(const struct rte_hash *h, const void *key,
 				 * Return index where key is stored,
 				 * substracting the first dummy index
 				 */
-				return bkt->key_idx[i] - 1;
+				return key_idx - 1;
 			}
 		}
 	}
@@ -744,10 +819,11 @@ __rte_hash_lookup_with_hash(const struct rte_hash *h, const void *key,
 
 	/* Check if key is in secondary location */
 	for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
+		key_idx = bkt->key_idx[i];
 		if (bkt->sig_current[i] == alt_hash &&
-				bkt->sig_alt[i] == sig) {
+				bkt->sig_alt[i] == sig && key_idx != EMPTY_SLOT) {
 			k = (struct rte_hash_key *) ((char *)keys +
-					bkt->key_idx[i] * h->key_entry_size);
+					key_idx * h->key_entry_size);
 			if (rte_hash_cmp_eq(key, k->key, h) == 0) {
 				if (data != NULL)
 					*data = k->pdata;
@@ -755,7 +831,7 @@ __rte_hash_lookup_with_hash(const struct rte_hash *h, const void *key,
 				 * Return index where key is stored,
 				 * substracting the first dummy index
 				 */
-				return bkt->key_idx[i] - 1;
+				return key_idx - 1;
 			}
 		}
 	}
@@ -763,6 +839,25 @@ __rte_hash_lookup_with_hash(const struct rte_hash *h, const void *key,
 	return -ENOENT;
 }
 
+static inline int32_t
+__rte_hash_lookup_with_hash(const struct rte_hash *h, const void *key,
+					hash_sig_t sig, void **data)
+{
+	uint32_t cnt;
+	int32_t ret;
+
+	if (!h->readwrite_concur_lf_support)
+		return search_buckets(h, key, sig, data);
+
+	/* A miss may be due to a key moved by the writer, search again */
+	do {
+		cnt = tbl_chng_cnt_read(h);
+		ret = search_buckets(h, key, sig, data);
+	} while (ret == -ENOENT && tbl_chng_cnt_changed(h, cnt));
+
+	return ret;
+}
+
 int32_t
 rte_hash_lookup_with_hash(const struct rte_hash *h,
 			const void *key, hash_sig_t sig)
@@ -793,14 +888,13 @@ rte_hash_lookup_data(const struct rte_hash *h, const void *key, void **data)
 	return __rte_hash_lookup_with_hash(h, key, rte_hash_hash(h, key), data);
 }
 
+/* Put the slot of a removed key back in the cache/ring */
 static inline void
-remove_entry(const struct rte_hash *h, struct rte_hash_bucket *bkt, unsigned i)
+free_slot(const struct rte_hash *h, uint32_t key_idx)
 {
 	unsigned lcore_id, n_slots;
 	struct lcore_cache *cached_free_slots;
 
-	bkt->sig_current[i] = NULL_SIGNATURE;
-	bkt->sig_alt[i] = NULL_SIGNATURE;
 	if (h->hw_trans_mem_support) {
 		lcore_id = rte_lcore_id();
 		cached_free_slots = &h->local_free_slots[lcore_id];
@@ -814,14 +908,28 @@ remove_entry(const struct rte_hash *h, struct rte_hash_bucket *bkt, unsigned i)
 		}
 		/* Put index of new free slot in cache. */
 		cached_free_slots->objs[cached_free_slots->len] =
-				(void *)((uintptr_t)bkt->key_idx[i]);
+				(void *)((uintptr_t)key_idx);
 		cached_free_slots->len++;
 	} else {
 		rte_ring_sp_enqueue(h->free_slots,
-				(void *)((uintptr_t)bkt->key_idx[i]));
+				(void *)((uintptr_t)key_idx));
 	}
 }
 
+static inline void
+remove_entry(const struct rte_hash *h, struct rte_hash_bucket *bkt, unsigned i)
+{
+	bkt->sig_current[i] = NULL_SIGNATURE;
+	bkt->sig_alt[i] = NULL_SIGNATURE;
+
+	/*
+	 * Lock-free readers may still access the key: its slot is freed by
+	 * rte_hash_free_key_with_position() once they are done.
+	 */
+	if (!h->readwrite_concur_lf_support)
+		free_slot(h, bkt->key_idx[i]);
+}
+
 static inline int32_t
 __rte_hash_del_key_with_hash(const struct rte_hash *h, const void *key,
 						hash_sig_t sig)
@@ -899,6 +1007,19 @@ rte_hash_del_key(const struct rte_hash *h, const void *key)
 	return __rte_hash_del_key_with_hash(h, key, rte_hash_hash(h, key));
 }
 
+int
+rte_hash_free_key_with_position(const struct rte_hash *h,
+				const int32_t position)
+{
+	RETURN_IF_TRUE(((h == NULL) || (position < 0) ||
+			((uint32_t)position >= h->entries) ||
+			!h->readwrite_concur_lf_support), -EINVAL);
+
+	/* Add the first dummy index back to the position */
+	free_slot(h, (uint32_t)position + 1);
+	return 0;
+}
+
 int
 rte_hash_get_key_with_position(const struct rte_hash *h, const int32_t position,
 			       void **key)
@@ -988,6 +1109,7 @@ __rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
 	const struct rte_hash_bucket *secondary_bkt[RTE_HASH_LOOKUP_BULK_MAX];
 	uint32_t prim_hitmask[RTE_HASH_LOOKUP_BULK_MAX] = {0};
 	uint32_t sec_hitmask[RTE_HASH_LOOKUP_BULK_MAX] = {0};
+	uint32_t cnt = 0;
 
 	/* Prefetch first keys */
 	for (i = 0; i < PREFETCH_OFFSET && i < num_keys; i++)
@@ -1022,6 +1144,10 @@ __rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
 		rte_prefetch0(secondary_bkt[i]);
 	}
 
+retry:
+	if (h->readwrite_concur_lf_support)
+		cnt = tbl_chng_cnt_read(h);
+
 	/* Compare signatures and prefetch key slot of first hit */
 	for (i = 0; i < num_keys; i++) {
 		compare_signatures(&prim_hitmask[i], &sec_hitmask[i],
@@ -1104,6 +1230,16 @@ __rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
 		continue;
 	}
 
+	/* Misses may be due to keys moved by the writer, search again */
+	if (h->readwrite_concur_lf_support &&
+			__builtin_popcountll(hits) != num_keys &&
+			tbl_chng_cnt_changed(h, cnt)) {
+		hits = 0;
+		memset(prim_hitmask, 0, sizeof(prim_hitmask));
+		memset(sec_hitmask, 0, sizeof(sec_hitmask));
+		goto retry;
+	}
+
 	if (hit_mask != NULL)
 		*hit_mask = hits;
 }
@@ -1133,7 +1269,7 @@ rte_hash_lookup_bulk_data(const struct rte_hash *h, const void **keys,
 	__rte_hash_lookup_bulk(h, keys, num_keys, positions, hit_mask, data);
 
 	/* Return number of hits */
-	return __builtin_popcountl(*hit_mask);
+	return __builtin_popcountll(*hit_mask);
 }
 
 int32_t
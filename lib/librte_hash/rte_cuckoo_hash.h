@@ -213,6 +213,12 @@ struct rte_hash {
 	uint32_t bucket_bitmask;
 	/**< Bitmask for getting bucket index from hash signature. */
 	uint32_t key_entry_size;         /**< Size of each key entry. */
+	uint8_t readwrite_concur_lf_support;
+	/**< Lock-free lookups concurrent with a single writer */
+	uint32_t *tbl_chng_cnt;
+	/**< Number of key moves by the writer, checked by lock-free readers
+	 * after a miss.
+	 */
 
 	void *key_store;                /**< Table storing all keys and data */
 	struct rte_hash_bucket *buckets;
@@ -63,6 +63,13 @@ extern "C" {
 /** Default behavior of insertion, single writer/multi writer */
 #define RTE_HASH_EXTRA_FLAGS_MULTI_WRITER_ADD 0x02
 
+/**
+ * Lock-free lookups concurrent with a single writer. The key slots freed
+ * by a delete are not reused before rte_hash_free_key_with_position() is
+ * called, once no reader can still access them.
+ */
+#define RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF 0x04
+
 /** Signature of key that is stored internally. */
 typedef uint32_t hash_sig_t;
 
@@ -235,6 +242,8 @@ rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key, hash_sig_t
  * Remove a key from an existing hash table.
  * This operation is not multi-thread safe
  * and should only be called from one thread.
+ * With RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF, the slot of the key is
+ * not freed, see rte_hash_free_key_with_position().
  *
  * @param h
  *   Hash table to remove the key from.
@@ -254,6 +263,8 @@ rte_hash_del_key(const struct rte_hash *h, const void *key);
  * Remove a key from an existing hash table.
  * This operation is not multi-thread safe
  * and should only be called from one thread.
+ * With RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF, the slot of the key is
+ * not freed, see rte_hash_free_key_with_position().
  *
  * @param h
  *   Hash table to remove the key from.
@@ -271,6 +282,26 @@ rte_hash_del_key(const struct rte_hash *h, const void *key);
 int32_t
 rte_hash_del_key_with_hash(const struct rte_hash *h, const void *key, hash_sig_t sig);
 
+/**
+ * Free the slot of a key deleted from a hash table created with
+ * RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF, so that it can store a new key.
+ * It must only be called once all the lookups which started before the
+ * delete are over, since they may still read the key and its data.
+ * This operation is not multi-thread safe
+ * and should only be called from the writer thread.
+ *
+ * @param h
+ *   Hash table the key was deleted from.
+ * @param position
+ *   Position returned when the key was deleted.
+ * @return
+ *   - 0 if freed successfully
+ *   - -EINVAL if the parameters are invalid.
+ */
+int
+rte_hash_free_key_with_position(const struct rte_hash *h,
+				const int32_t position);
+
 /**
  * Find a key in the hash table given the position.
  * This operation is multi-thread safe.
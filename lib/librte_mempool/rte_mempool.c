@@ -39,6 +39,7 @@
 #include <unistd.h>
 #include <inttypes.h>
 #include <errno.h>
+#include <pthread.h>
 #include <sys/queue.h>
 #include <sys/mman.h>
 
@@ -348,17 +349,22 @@ rte_mempool_populate_phys(struct rte_mempool *mp, char *vaddr,
 	phys_addr_t paddr, size_t len, rte_mempool_memchunk_free_cb_t *free_cb,
 	void *opaque)
 {
-	unsigned total_elt_sz;
-	unsigned i = 0;
-	size_t off;
 	struct rte_mempool_memhdr *memhdr;
 	int ret;
 
 	/* create the internal ring if not already done */
 	if ((mp->flags & MEMPOOL_F_POOL_CREATED) == 0) {
+		struct rte_mempool_info info;
+
 		ret = rte_mempool_ops_alloc(mp);
 		if (ret != 0)
 			return ret;
+		ret = rte_mempool_ops_get_info(mp, &info);
+		if (ret != 0) {
+			rte_mempool_ops_free(mp);
+			return ret;
+		}
+		mp->contig_block_size = info.contig_block_size;
 		mp->flags |= MEMPOOL_F_POOL_CREATED;
 	}
 
@@ -366,8 +372,6 @@ rte_mempool_populate_phys(struct rte_mempool *mp, char *vaddr,
 	if (mp->populated_size >= mp->size)
 		return -ENOSPC;
 
-	total_elt_sz = mp->header_size + mp->elt_size + mp->trailer_size;
-
 	memhdr = rte_zmalloc("MEMPOOL_MEMHDR", sizeof(*memhdr), 0);
 	if (memhdr == NULL)
 		return -ENOMEM;
@@ -379,12 +383,39 @@ rte_mempool_populate_phys(struct rte_mempool *mp, char *vaddr,
 	memhdr->free_cb = free_cb;
 	memhdr->opaque = opaque;
 
+	ret = rte_mempool_ops_populate(mp, mp->size - mp->populated_size,
+		vaddr, paddr, len);
+	/* not enough room to store one object */
+	if (ret <= 0) {
+		rte_free(memhdr);
+		return ret < 0 ? ret : -EINVAL;
+	}
+
+	STAILQ_INSERT_TAIL(&mp->mem_list, memhdr, next);
+	mp->nb_mem_chunks++;
+	return ret;
+}
+
+/* Default way to lay out the objects in a memory chunk: one after the
+ * other, from the first aligned address. Return the number of objects
+ * added.
+ */
+int
+rte_mempool_op_populate_default(struct rte_mempool *mp, unsigned int max_objs,
+	char *vaddr, phys_addr_t paddr, size_t len)
+{
+	unsigned total_elt_sz;
+	unsigned i = 0;
+	size_t off;
+
+	total_elt_sz = mp->header_size + mp->elt_size + mp->trailer_size;
+
 	if (mp->flags & MEMPOOL_F_NO_CACHE_ALIGN)
 		off = RTE_PTR_ALIGN_CEIL(vaddr, 8) - vaddr;
 	else
 		off = RTE_PTR_ALIGN_CEIL(vaddr, RTE_CACHE_LINE_SIZE) - vaddr;
 
-	while (off + total_elt_sz <= len && mp->populated_size < mp->size) {
+	while (off + total_elt_sz <= len && i < max_objs) {
 		off += mp->header_size;
 		if (paddr == RTE_BAD_PHYS_ADDR)
 			mempool_add_elem(mp, (char *)vaddr + off,
@@ -395,12 +426,6 @@ rte_mempool_populate_phys(struct rte_mempool *mp, char *vaddr,
 		i++;
 	}
 
-	/* not enough room to store one object */
-	if (i == 0)
-		return -EINVAL;
-
-	STAILQ_INSERT_TAIL(&mp->mem_list, memhdr, next);
-	mp->nb_mem_chunks++;
 	return i;
 }
 
@@ -518,7 +543,7 @@ rte_mempool_populate_default(struct rte_mempool *mp)
 	int mz_flags = RTE_MEMZONE_1GB|RTE_MEMZONE_SIZE_HINT_ONLY;
 	char mz_name[RTE_MEMZONE_NAMESIZE];
 	const struct rte_memzone *mz;
-	size_t size, total_elt_sz, align, pg_sz, pg_shift;
+	size_t size, align, pg_sz, pg_shift;
 	phys_addr_t paddr;
 	unsigned mz_id, n;
 	int ret;
@@ -541,9 +566,8 @@ rte_mempool_populate_default(struct rte_mempool *mp)
 		align = pg_sz;
 	}
 
-	total_elt_sz = mp->header_size + mp->elt_size + mp->trailer_size;
 	for (mz_id = 0, n = mp->size; n > 0; mz_id++, n -= ret) {
-		size = rte_mempool_xmem_size(n, total_elt_sz, pg_shift);
+		size = rte_mempool_ops_calc_mem_size(mp, n, pg_shift);
 
 		ret = snprintf(mz_name, sizeof(mz_name),
 			RTE_MEMPOOL_MZ_FORMAT "_%d", mp->name, mz_id);
@@ -595,12 +619,11 @@ rte_mempool_populate_default(struct rte_mempool *mp)
 static size_t
 get_anon_size(const struct rte_mempool *mp)
 {
-	size_t size, total_elt_sz, pg_sz, pg_shift;
+	size_t size, pg_sz, pg_shift;
 
 	pg_sz = getpagesize();
 	pg_shift = rte_bsf32(pg_sz);
-	total_elt_sz = mp->header_size + mp->elt_size + mp->trailer_size;
-	size = rte_mempool_xmem_size(mp->size, total_elt_sz, pg_shift);
+	size = rte_mempool_ops_calc_mem_size(mp, mp->size, pg_shift);
 
 	return size;
 }
@@ -654,6 +677,20 @@ rte_mempool_populate_anon(struct rte_mempool *mp)
 	return 0;
 }
 
+/* detach the per-thread caches from a mempool being freed */
+static void
+mempool_thread_caches_detach(struct rte_mempool *mp)
+{
+	struct rte_mempool_thread_cache *tc;
+
+	rte_rwlock_write_lock(RTE_EAL_MEMPOOL_RWLOCK);
+	while ((tc = TAILQ_FIRST(&mp->thread_caches)) != NULL) {
+		TAILQ_REMOVE(&mp->thread_caches, tc, next);
+		tc->mp = NULL;
+	}
+	rte_rwlock_write_unlock(RTE_EAL_MEMPOOL_RWLOCK);
+}
+
 /* free a mempool */
 void
 rte_mempool_free(struct rte_mempool *mp)
@@ -678,6 +715,7 @@ rte_mempool_free(struct rte_mempool *mp)
 	}
 	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
 
+	mempool_thread_caches_detach(mp);
 	rte_mempool_free_memchunks(mp);
 	rte_mempool_ops_free(mp);
 	rte_memzone_free(mp->mz);
@@ -689,6 +727,96 @@ mempool_cache_init(struct rte_mempool_cache *cache, uint32_t size)
 	cache->size = size;
 	cache->flushthresh = CALC_CACHE_FLUSHTHRESH(size);
 	cache->len = 0;
+	cache->adapt_countdown = RTE_MEMPOOL_CACHE_ADAPT_PERIOD;
+	cache->adapt_burst = 0;
+	cache->min_size = size;
+	cache->max_size = size;
+	cache->adapt_misses = 0;
+	memset(&cache->stats, 0, sizeof(cache->stats));
+}
+
+/* let a cache resize itself within [min_size, max_size] */
+static void
+mempool_cache_set_bounds(struct rte_mempool_cache *cache, uint32_t min_size,
+	uint32_t max_size)
+{
+	cache->min_size = min_size;
+	cache->max_size = max_size;
+	cache->size = RTE_MAX(RTE_MIN(cache->size, max_size), min_size);
+	cache->flushthresh = CALC_CACHE_FLUSHTHRESH(cache->size);
+	cache->adapt_countdown = RTE_MEMPOOL_CACHE_ADAPT_PERIOD;
+	cache->adapt_misses = cache->stats.get_misses +
+		cache->stats.put_misses;
+}
+
+/* Make a user-owned cache adaptive. */
+int
+rte_mempool_cache_set_adaptive(struct rte_mempool_cache *cache,
+	uint32_t min_size, uint32_t max_size)
+{
+	if (cache == NULL || min_size == 0 || min_size > max_size ||
+			max_size > RTE_MEMPOOL_CACHE_MAX_SIZE)
+		return -EINVAL;
+
+	mempool_cache_set_bounds(cache, min_size, max_size);
+	return 0;
+}
+
+/*
+ * Make the default per-lcore caches of a mempool adaptive. The caches of
+ * other lcores are written without synchronization, so the mempool must be
+ * idle.
+ */
+int
+rte_mempool_set_adaptive_cache(struct rte_mempool *mp, uint32_t min_size,
+	uint32_t max_size)
+{
+	unsigned lcore_id;
+
+	if (mp->cache_size == 0 || min_size == 0 || min_size > max_size ||
+			max_size > RTE_MEMPOOL_CACHE_MAX_SIZE ||
+			CALC_CACHE_FLUSHTHRESH(max_size) > mp->size)
+		return -EINVAL;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+		mempool_cache_set_bounds(&mp->local_cache[lcore_id],
+			min_size, max_size);
+	return 0;
+}
+
+static void
+mempool_cache_stats_add(struct rte_mempool_cache_stats *stats,
+	const struct rte_mempool_cache_stats *cs)
+{
+	stats->get_hits += cs->get_hits;
+	stats->get_misses += cs->get_misses;
+	stats->put_hits += cs->put_hits;
+	stats->put_misses += cs->put_misses;
+	stats->refills += cs->refills;
+	stats->flushes += cs->flushes;
+}
+
+/* Sum the statistics of the per-lcore and per-thread caches of a mempool. */
+void
+rte_mempool_cache_stats_get(const struct rte_mempool *mp,
+	struct rte_mempool_cache_stats *stats)
+{
+	const struct rte_mempool_thread_cache *tc;
+	unsigned lcore_id;
+
+	memset(stats, 0, sizeof(*stats));
+
+	rte_rwlock_read_lock(RTE_EAL_MEMPOOL_RWLOCK);
+	TAILQ_FOREACH(tc, &mp->thread_caches, next)
+		mempool_cache_stats_add(stats, &tc->cache.stats);
+	rte_rwlock_read_unlock(RTE_EAL_MEMPOOL_RWLOCK);
+
+	if (mp->cache_size == 0)
+		return;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+		mempool_cache_stats_add(stats,
+			&mp->local_cache[lcore_id].stats);
 }
 
 /*
@@ -730,6 +858,150 @@ rte_mempool_cache_free(struct rte_mempool_cache *cache)
 	rte_free(cache);
 }
 
+/* per-thread caches of the non-EAL threads */
+RTE_DEFINE_PER_LCORE(struct rte_mempool_thread_cache_table,
+	_mempool_thread_caches);
+
+/* releases the caches of a thread when it exits */
+static pthread_key_t mempool_thread_cache_key;
+static pthread_once_t mempool_thread_cache_once = PTHREAD_ONCE_INIT;
+static int mempool_thread_cache_key_ret;
+
+/* flush a per-thread cache in its mempool, if any, and release it */
+static void
+mempool_thread_cache_release(struct rte_mempool_thread_cache *tc)
+{
+	rte_rwlock_write_lock(RTE_EAL_MEMPOOL_RWLOCK);
+	if (tc->mp != NULL) {
+		rte_mempool_cache_flush(&tc->cache, tc->mp);
+		TAILQ_REMOVE(&tc->mp->thread_caches, tc, next);
+		tc->mp = NULL;
+	}
+	rte_rwlock_write_unlock(RTE_EAL_MEMPOOL_RWLOCK);
+
+	rte_free(tc);
+}
+
+/* release all the caches of a table */
+static void
+mempool_thread_cache_table_release(struct rte_mempool_thread_cache_table *table)
+{
+	while (table->count > 0)
+		mempool_thread_cache_release(table->tc[--table->count]);
+}
+
+/* release the caches of a table whose mempool was freed */
+static void
+mempool_thread_cache_table_reclaim(struct rte_mempool_thread_cache_table *table)
+{
+	unsigned int i = 0;
+
+	rte_rwlock_read_lock(RTE_EAL_MEMPOOL_RWLOCK);
+	while (i < table->count) {
+		if (table->tc[i]->mp == NULL) {
+			rte_free(table->tc[i]);
+			table->tc[i] = table->tc[--table->count];
+		} else {
+			i++;
+		}
+	}
+	rte_rwlock_read_unlock(RTE_EAL_MEMPOOL_RWLOCK);
+}
+
+/* thread exit: release the caches the thread did not unregister */
+static void
+mempool_thread_cache_destructor(void *arg)
+{
+	mempool_thread_cache_table_release(arg);
+}
+
+static void
+mempool_thread_cache_key_create(void)
+{
+	mempool_thread_cache_key_ret = pthread_key_create(
+		&mempool_thread_cache_key, mempool_thread_cache_destructor);
+}
+
+/* Register a per-thread cache of a mempool for the calling thread. */
+int
+rte_mempool_thread_cache_register(struct rte_mempool *mp, uint32_t size)
+{
+	struct rte_mempool_thread_cache_table *table =
+		&RTE_PER_LCORE(_mempool_thread_caches);
+	struct rte_mempool_thread_cache *tc;
+
+	if (size == 0)
+		size = mp->cache_size;
+
+	if (rte_lcore_id() != LCORE_ID_ANY || size == 0 ||
+			size > RTE_MEMPOOL_CACHE_MAX_SIZE ||
+			CALC_CACHE_FLUSHTHRESH(size) > mp->size)
+		return -EINVAL;
+
+	mempool_thread_cache_table_reclaim(table);
+
+	if (__mempool_thread_cache(mp) != NULL)
+		return -EEXIST;
+
+	if (table->count == RTE_MEMPOOL_THREAD_CACHE_MAX)
+		return -ENOSPC;
+
+	pthread_once(&mempool_thread_cache_once,
+		mempool_thread_cache_key_create);
+	if (mempool_thread_cache_key_ret != 0 ||
+			pthread_setspecific(mempool_thread_cache_key, table) != 0) {
+		RTE_LOG(ERR, MEMPOOL, "Cannot set mempool thread cache key.\n");
+		return -ENOMEM;
+	}
+
+	tc = rte_zmalloc_socket("MEMPOOL_THREAD_CACHE", sizeof(*tc),
+		RTE_CACHE_LINE_SIZE, mp->socket_id);
+	if (tc == NULL) {
+		RTE_LOG(ERR, MEMPOOL, "Cannot allocate mempool thread cache.\n");
+		return -ENOMEM;
+	}
+
+	mempool_cache_init(&tc->cache, size);
+
+	rte_rwlock_write_lock(RTE_EAL_MEMPOOL_RWLOCK);
+	tc->mp = mp;
+	TAILQ_INSERT_TAIL(&mp->thread_caches, tc, next);
+	rte_rwlock_write_unlock(RTE_EAL_MEMPOOL_RWLOCK);
+
+	table->tc[table->count++] = tc;
+	return 0;
+}
+
+/* Unregister the per-thread cache of a mempool of the calling thread. */
+int
+rte_mempool_thread_cache_unregister(struct rte_mempool *mp)
+{
+	struct rte_mempool_thread_cache_table *table =
+		&RTE_PER_LCORE(_mempool_thread_caches);
+	unsigned int i;
+
+	mempool_thread_cache_table_reclaim(table);
+
+	for (i = 0; i < table->count; i++) {
+		if (table->tc[i]->mp == mp)
+			break;
+	}
+	if (i == table->count)
+		return -ENOENT;
+
+	mempool_thread_cache_release(table->tc[i]);
+	table->tc[i] = table->tc[--table->count];
+	return 0;
+}
+
+/* Unregister all the per-thread caches of the calling thread. */
+void
+rte_mempool_thread_cache_unregister_all(void)
+{
+	mempool_thread_cache_table_release(
+		&RTE_PER_LCORE(_mempool_thread_caches));
+}
+
 /* create an empty mempool */
 struct rte_mempool *
 rte_mempool_create_empty(const char *name, unsigned n, unsigned elt_size,
@@ -829,6 +1101,7 @@ rte_mempool_create_empty(const char *name, unsigned n, unsigned elt_size,
 	mp->private_data_size = private_data_size;
 	STAILQ_INIT(&mp->elt_list);
 	STAILQ_INIT(&mp->mem_list);
+	TAILQ_INIT(&mp->thread_caches);
 
 	/*
 	 * local_cache pointer is set even if cache_size is zero.
@@ -970,6 +1243,21 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 	return NULL;
 }
 
+/* return the number of objects in the per-thread caches of a mempool */
+static unsigned int
+mempool_thread_cache_count(const struct rte_mempool *mp)
+{
+	const struct rte_mempool_thread_cache *tc;
+	unsigned int count = 0;
+
+	rte_rwlock_read_lock(RTE_EAL_MEMPOOL_RWLOCK);
+	TAILQ_FOREACH(tc, &mp->thread_caches, next)
+		count += tc->cache.len;
+	rte_rwlock_read_unlock(RTE_EAL_MEMPOOL_RWLOCK);
+
+	return count;
+}
+
 /* Return the number of entries in the mempool */
 unsigned int
 rte_mempool_avail_count(const struct rte_mempool *mp)
@@ -978,12 +1266,12 @@ rte_mempool_avail_count(const struct rte_mempool *mp)
 	unsigned lcore_id;
 
 	count = rte_mempool_ops_get_count(mp);
+	count += mempool_thread_cache_count(mp);
 
-	if (mp->cache_size == 0)
-		return count;
-
-	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
-		count += mp->local_cache[lcore_id].len;
+	if (mp->cache_size != 0) {
+		for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+			count += mp->local_cache[lcore_id].len;
+	}
 
 	/*
 	 * due to race condition (access to len is not locked), the
@@ -1001,25 +1289,62 @@ rte_mempool_in_use_count(const struct rte_mempool *mp)
 	return mp->size - rte_mempool_avail_count(mp);
 }
 
+/* dump the statistics of a cache, if it was used */
+static void
+rte_mempool_dump_cache_stats(FILE *f, const char *name, unsigned idx,
+	const struct rte_mempool_cache *cache)
+{
+	const struct rte_mempool_cache_stats *cs = &cache->stats;
+
+	if (cs->get_hits + cs->get_misses +
+			cs->put_hits + cs->put_misses == 0)
+		return;
+	fprintf(f, "    %s[%u]: size=%"PRIu32" min=%"PRIu32" max=%"PRIu32"\n",
+		name, idx, cache->size, cache->min_size, cache->max_size);
+	fprintf(f, "      get_hits=%"PRIu64" get_misses=%"PRIu64
+		" refills=%"PRIu64"\n",
+		cs->get_hits, cs->get_misses, cs->refills);
+	fprintf(f, "      put_hits=%"PRIu64" put_misses=%"PRIu64
+		" flushes=%"PRIu64"\n",
+		cs->put_hits, cs->put_misses, cs->flushes);
+}
+
 /* dump the cache status */
 static unsigned
 rte_mempool_dump_cache(FILE *f, const struct rte_mempool *mp)
 {
+	const struct rte_mempool_thread_cache *tc;
 	unsigned lcore_id;
 	unsigned count = 0;
 	unsigned cache_count;
+	unsigned i = 0;
 
 	fprintf(f, "  internal cache infos:\n");
 	fprintf(f, "    cache_size=%"PRIu32"\n", mp->cache_size);
 
+	rte_rwlock_read_lock(RTE_EAL_MEMPOOL_RWLOCK);
+	TAILQ_FOREACH(tc, &mp->thread_caches, next) {
+		count += tc->cache.len;
+		rte_mempool_dump_cache_stats(f, "thread_cache_stats", i++,
+			&tc->cache);
+	}
+	rte_rwlock_read_unlock(RTE_EAL_MEMPOOL_RWLOCK);
+	fprintf(f, "    thread_cache_count=%u\n", count);
+
 	if (mp->cache_size == 0)
 		return count;
 
 	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
-		cache_count = mp->local_cache[lcore_id].len;
+		const struct rte_mempool_cache *cache =
+			&mp->local_cache[lcore_id];
+
+		cache_count = cache->len;
 		fprintf(f, "    cache_count[%u]=%"PRIu32"\n",
 			lcore_id, cache_count);
 		count += cache_count;
+
+		rte_mempool_dump_cache_stats(f, "cache_stats", lcore_id,
+			cache);
 	}
 	fprintf(f, "    total_cache_count=%u\n", count);
 	return count;
@@ -1188,6 +1513,7 @@ rte_mempool_dump(FILE *f, struct rte_mempool *mp)
 	       mp->header_size + mp->elt_size + mp->trailer_size);
 
 	fprintf(f, "  private_data_size=%"PRIu32"\n", mp->private_data_size);
+	fprintf(f, "  contig_block_size=%"PRIu32"\n", mp->contig_block_size);
 
 	STAILQ_FOREACH(memhdr, &mp->mem_list, next)
 		mem_len += memhdr->len;
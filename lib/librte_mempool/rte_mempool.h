@@ -101,6 +101,24 @@ struct rte_mempool_debug_stats {
 } __rte_cache_aligned;
 #endif
 
+/**
+ * A structure that stores the access statistics of a mempool cache. Hits
+ * are served by the cache only, misses reach the common pool. Misses,
+ * refills and flushes are always counted, hits only when
+ * CONFIG_RTE_LIBRTE_MEMPOOL_CACHE_STATS is enabled.
+ */
+struct rte_mempool_cache_stats {
+	uint64_t get_hits;   /**< Gets served from the cache. */
+	uint64_t get_misses; /**< Gets which went to the common pool. */
+	uint64_t put_hits;   /**< Puts kept in the cache. */
+	uint64_t put_misses; /**< Puts which went to the common pool. */
+	uint64_t refills;    /**< Bulk refills of the cache from the pool. */
+	uint64_t flushes;    /**< Bulk flushes of the cache to the pool. */
+};
+
+/** Number of cache accesses between two resizes of an adaptive cache. */
+#define RTE_MEMPOOL_CACHE_ADAPT_PERIOD 1024
+
 /**
  * A structure that stores a per-core object cache.
  */
@@ -108,6 +126,12 @@ struct rte_mempool_cache {
 	uint32_t size;	      /**< Size of the cache */
 	uint32_t flushthresh; /**< Threshold before we flush excess elements */
 	uint32_t len;	      /**< Current cache count */
+	uint32_t adapt_countdown; /**< Accesses before the next resize */
+	uint32_t adapt_burst; /**< Largest access since the last resize */
+	uint32_t min_size;    /**< Lower bound of the size, if adaptive */
+	uint32_t max_size;    /**< Upper bound of the size, if adaptive */
+	uint64_t adapt_misses; /**< Misses counted at the last resize */
+	struct rte_mempool_cache_stats stats; /**< Access statistics */
 	/*
 	 * Cache is allocated to this size to allow it to overflow in certain
 	 * cases to avoid needless emptying of cache.
@@ -209,6 +233,33 @@ struct rte_mempool_memhdr {
 	void *opaque;            /**< Argument passed to the free callback */
 };
 
+/**
+ * A mempool cache owned by a registered non-EAL thread. It is linked in
+ * the list of its mempool, and referenced by the table of its thread.
+ */
+struct rte_mempool_thread_cache {
+	TAILQ_ENTRY(rte_mempool_thread_cache) next; /**< Next in mempool list */
+	struct rte_mempool *mp; /**< Mempool of the cache, NULL once freed */
+	struct rte_mempool_cache cache; /**< The per-thread cache */
+};
+
+/**
+ * A list of per-thread caches.
+ */
+TAILQ_HEAD(rte_mempool_thread_cache_list, rte_mempool_thread_cache);
+
+/**
+ * The per-thread caches of a registered non-EAL thread.
+ */
+struct rte_mempool_thread_cache_table {
+	unsigned int count; /**< Number of registered caches */
+	/** The registered caches, one per mempool. */
+	struct rte_mempool_thread_cache *tc[RTE_MEMPOOL_THREAD_CACHE_MAX];
+};
+
+RTE_DECLARE_PER_LCORE(struct rte_mempool_thread_cache_table,
+	_mempool_thread_caches); /**< Per thread caches of non-EAL threads. */
+
 /**
  * The RTE mempool structure.
  */
@@ -245,8 +296,15 @@ struct rte_mempool {
 	 * this mempool.
 	 */
 	int32_t ops_index;
+	/**
+	 * Number of objects in the contiguous blocks of the handler, the
+	 * caches are refilled by whole blocks. 0 if not supported.
+	 */
+	uint32_t contig_block_size;
 
 	struct rte_mempool_cache *local_cache; /**< Per-lcore local cache */
+	/** Caches of the registered non-EAL threads. */
+	struct rte_mempool_thread_cache_list thread_caches;
 
 	uint32_t populated_size;         /**< Number of populated objects. */
 	struct rte_mempool_objhdr_list elt_list; /**< List of objects in pool */
@@ -288,6 +346,20 @@ struct rte_mempool {
 #define __MEMPOOL_STAT_ADD(mp, name, n) do {} while(0)
 #endif
 
+/**
+ * @internal When cache statistics are enabled, count a cache hit.
+ *
+ * @param cache
+ *   Pointer to the mempool cache.
+ * @param name
+ *   Name of the statistics field to increment in the cache.
+ */
+#ifdef RTE_LIBRTE_MEMPOOL_CACHE_STATS
+#define __MEMPOOL_CACHE_STAT_INC(cache, name) ((cache)->stats.name++)
+#else
+#define __MEMPOOL_CACHE_STAT_INC(cache, name) do {} while (0)
+#endif
+
 /**
  * Calculate the size of the mempool header.
  *
@@ -389,6 +461,45 @@ typedef int (*rte_mempool_dequeue_t)(struct rte_mempool *mp,
  */
 typedef unsigned (*rte_mempool_get_count)(const struct rte_mempool *mp);
 
+/**
+ * Return the size of the memory needed to store obj_num objects of the
+ * mempool, in pages of (1 << pg_shift) bytes, or in a single physically
+ * contiguous area if pg_shift is 0. The default is rte_mempool_xmem_size().
+ */
+typedef size_t (*rte_mempool_calc_mem_size_t)(const struct rte_mempool *mp,
+		uint32_t obj_num, uint32_t pg_shift);
+
+/**
+ * Lay out at most max_objs objects in a virtually and physically contiguous
+ * memory chunk and add them to the pool, see
+ * rte_mempool_op_populate_default(). Return the number of objects added,
+ * or a negative value on error.
+ */
+typedef int (*rte_mempool_populate_t)(struct rte_mempool *mp,
+		unsigned int max_objs, char *vaddr, phys_addr_t paddr,
+		size_t len);
+
+/**
+ * Additional information about the mempool, filled by the handler.
+ */
+struct rte_mempool_info {
+	/** Number of objects in a contiguous block, 0 if not supported. */
+	unsigned int contig_block_size;
+};
+
+/**
+ * Get some additional information about the external pool.
+ */
+typedef int (*rte_mempool_get_info_t)(const struct rte_mempool *mp,
+		struct rte_mempool_info *info);
+
+/**
+ * Dequeue n blocks of contiguous objects from the external pool and
+ * store a pointer to the first object of each block in first_obj_table.
+ */
+typedef int (*rte_mempool_dequeue_contig_blocks_t)(struct rte_mempool *mp,
+		void **first_obj_table, unsigned int n);
+
 /** Structure defining mempool operations structure */
 struct rte_mempool_ops {
 	char name[RTE_MEMPOOL_OPS_NAMESIZE]; /**< Name of mempool ops struct. */
@@ -397,6 +508,14 @@ struct rte_mempool_ops {
 	rte_mempool_enqueue_t enqueue;   /**< Enqueue an object. */
 	rte_mempool_dequeue_t dequeue;   /**< Dequeue an object. */
 	rte_mempool_get_count get_count; /**< Get qty of available objs. */
+	/** Optional: get size of the memory to store objects. */
+	rte_mempool_calc_mem_size_t calc_mem_size;
+	/** Optional: lay out objects in a memory chunk. */
+	rte_mempool_populate_t populate;
+	/** Optional: get additional information about the pool. */
+	rte_mempool_get_info_t get_info;
+	/** Optional: dequeue blocks of contiguous objects. */
+	rte_mempool_dequeue_contig_blocks_t dequeue_contig_blocks;
 } __rte_cache_aligned;
 
 #define RTE_MEMPOOL_MAX_OPS_IDX 16  /**< Max registered ops structs */
@@ -497,6 +616,32 @@ rte_mempool_ops_enqueue_bulk(struct rte_mempool *mp, void * const *obj_table,
 	return ops->enqueue(mp, obj_table, n);
 }
 
+/**
+ * @internal wrapper for mempool_ops dequeue_contig_blocks callback.
+ *
+ * @param mp
+ *   Pointer to the memory pool.
+ * @param first_obj_table
+ *   Pointer to a table of void * pointers (first objects of the blocks).
+ * @param n
+ *   Number of blocks to get.
+ * @return
+ *   - 0: Success; got n blocks.
+ *   - -ENOTSUP: The handler does not support contiguous blocks.
+ *   - <0: Error; code of dequeue function.
+ */
+static inline int
+rte_mempool_ops_dequeue_contig_blocks(struct rte_mempool *mp,
+		void **first_obj_table, unsigned int n)
+{
+	struct rte_mempool_ops *ops;
+
+	ops = rte_mempool_get_ops(mp->ops_index);
+	if (ops->dequeue_contig_blocks == NULL)
+		return -ENOTSUP;
+	return ops->dequeue_contig_blocks(mp, first_obj_table, n);
+}
+
 /**
  * @internal wrapper for mempool_ops get_count callback.
  *
@@ -517,6 +662,81 @@ rte_mempool_ops_get_count(const struct rte_mempool *mp);
 void
 rte_mempool_ops_free(struct rte_mempool *mp);
 
+/**
+ * @internal wrapper for mempool_ops calc_mem_size callback.
+ *
+ * @param mp
+ *   Pointer to the memory pool.
+ * @param obj_num
+ *   Number of objects to store.
+ * @param pg_shift
+ *   LOG2 of the page size, or 0 for a physically contiguous area.
+ * @return
+ *   The size of the memory needed to store obj_num objects.
+ */
+size_t
+rte_mempool_ops_calc_mem_size(const struct rte_mempool *mp,
+		uint32_t obj_num, uint32_t pg_shift);
+
+/**
+ * @internal wrapper for mempool_ops populate callback.
+ *
+ * @param mp
+ *   Pointer to the memory pool.
+ * @param max_objs
+ *   Maximum number of objects to add.
+ * @param vaddr
+ *   Virtual address of the memory chunk.
+ * @param paddr
+ *   Physical address of the chunk, or RTE_BAD_PHYS_ADDR.
+ * @param len
+ *   Length of the memory chunk.
+ * @return
+ *   The number of objects added, or a negative value on error.
+ */
+int
+rte_mempool_ops_populate(struct rte_mempool *mp, unsigned int max_objs,
+		char *vaddr, phys_addr_t paddr, size_t len);
+
+/**
+ * Get some additional information about the mempool handler.
+ *
+ * @param mp
+ *   Pointer to the memory pool.
+ * @param info
+ *   Pointer to the structure to fill.
+ * @return
+ *   - 0: Success; info is filled.
+ *   - <0: Error; code of get_info function.
+ */
+int
+rte_mempool_ops_get_info(const struct rte_mempool *mp,
+		struct rte_mempool_info *info);
+
+/**
+ * Default way to lay out objects in a memory chunk.
+ *
+ * Objects are placed one after the other from the first cache line of the
+ * chunk and added to the pool. A handler implementing the populate
+ * callback may call it on each part of the chunk it reserves for objects.
+ *
+ * @param mp
+ *   Pointer to the memory pool.
+ * @param max_objs
+ *   Maximum number of objects to add.
+ * @param vaddr
+ *   Virtual address of the memory chunk.
+ * @param paddr
+ *   Physical address of the chunk, or RTE_BAD_PHYS_ADDR.
+ * @param len
+ *   Length of the memory chunk.
+ * @return
+ *   The number of objects added.
+ */
+int
+rte_mempool_op_populate_default(struct rte_mempool *mp, unsigned int max_objs,
+		char *vaddr, phys_addr_t paddr, size_t len);
+
 /**
  * Set the ops of a mempool.
  *
@@ -985,6 +1205,67 @@ rte_mempool_cache_create(uint32_t size, int socket_id);
 void
 rte_mempool_cache_free(struct rte_mempool_cache *cache);
 
+/**
+ * Let a mempool cache resize itself within the given bounds.
+ *
+ * The size of an adaptive cache is reevaluated every
+ * RTE_MEMPOOL_CACHE_ADAPT_PERIOD accesses from its recent miss rate: it
+ * grows when too many gets and puts reach the common pool, and shrinks
+ * back when nearly all of them are served by the cache.
+ *
+ * The cache must not be in use while its bounds are changed.
+ *
+ * @param cache
+ *   A pointer to the mempool cache.
+ * @param min_size
+ *   The minimum size of the cache, at least 1.
+ * @param max_size
+ *   The maximum size of the cache, at most RTE_MEMPOOL_CACHE_MAX_SIZE.
+ * @return
+ *   0 on success, -EINVAL if the bounds are invalid.
+ */
+int
+rte_mempool_cache_set_adaptive(struct rte_mempool_cache *cache,
+	uint32_t min_size, uint32_t max_size);
+
+/**
+ * Let the default per-lcore caches of a mempool resize themselves within
+ * the given bounds. See rte_mempool_cache_set_adaptive().
+ *
+ * The caches of all lcores are updated without synchronization, so this
+ * must only be called while no thread gets objects from or puts objects
+ * to the mempool, typically right after its creation.
+ *
+ * @param mp
+ *   A pointer to the mempool structure, created with a cache.
+ * @param min_size
+ *   The minimum size of the caches, at least 1.
+ * @param max_size
+ *   The maximum size of the caches, with the same limits as the
+ *   cache_size parameter of rte_mempool_create().
+ * @return
+ *   0 on success, -EINVAL if the mempool has no cache or the bounds are
+ *   invalid.
+ */
+int
+rte_mempool_set_adaptive_cache(struct rte_mempool *mp, uint32_t min_size,
+	uint32_t max_size);
+
+/**
+ * Get the accumulated statistics of the default per-lcore caches of a
+ * mempool. The counters are updated locklessly by their lcore, so the
+ * result is only a snapshot when the mempool is in use. The hit counters
+ * are zero unless CONFIG_RTE_LIBRTE_MEMPOOL_CACHE_STATS is enabled.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param stats
+ *   A pointer to the structure filled with the sum of the statistics.
+ */
+void
+rte_mempool_cache_stats_get(const struct rte_mempool *mp,
+	struct rte_mempool_cache_stats *stats);
+
 /**
  * Flush a user-owned mempool cache to the specified mempool.
  *
@@ -1001,28 +1282,135 @@ rte_mempool_cache_flush(struct rte_mempool_cache *cache,
 	cache->len = 0;
 }
 
+/**
+ * Register a per-thread cache of a mempool for the calling non-EAL thread.
+ *
+ * EAL lcores use the per-lcore caches of the mempool. Other threads go to
+ * the common pool on each access, unless they register their own cache:
+ * it is then returned by rte_mempool_default_cache() for LCORE_ID_ANY, so
+ * the gets and puts of the thread are cached, like on an EAL lcore.
+ *
+ * The cache is owned by the thread. It is flushed and released when the
+ * thread exits, or earlier with rte_mempool_thread_cache_unregister() or
+ * rte_mempool_thread_cache_unregister_all(). Freeing the mempool first is
+ * allowed, the cache is then only released, at the latest on the next
+ * registration or unregistration of the thread.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param size
+ *   The size of the cache, with the same limits as the cache_size
+ *   parameter of rte_mempool_create(). If 0, the size of the per-lcore
+ *   caches of the mempool is used.
+ * @return
+ *   0 on success, or a negative value:
+ *   - -EINVAL: called from an EAL lcore, or invalid size.
+ *   - -EEXIST: the thread already has a cache for this mempool.
+ *   - -ENOSPC: the thread has RTE_MEMPOOL_THREAD_CACHE_MAX caches.
+ *   - -ENOMEM: the cache cannot be allocated.
+ */
+int
+rte_mempool_thread_cache_register(struct rte_mempool *mp, uint32_t size);
+
+/**
+ * Flush and release the per-thread cache of a mempool of the calling
+ * non-EAL thread.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @return
+ *   0 on success, -ENOENT if the thread has no cache for this mempool.
+ */
+int
+rte_mempool_thread_cache_unregister(struct rte_mempool *mp);
+
+/**
+ * Flush and release all the per-thread caches of the calling non-EAL
+ * thread.
+ */
+void
+rte_mempool_thread_cache_unregister_all(void);
+
+/**
+ * @internal Get the cache of a mempool registered by the calling thread.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @return
+ *   A pointer to the mempool cache or NULL if not registered.
+ */
+static inline struct rte_mempool_cache *
+__mempool_thread_cache(const struct rte_mempool *mp)
+{
+	struct rte_mempool_thread_cache_table *table =
+		&RTE_PER_LCORE(_mempool_thread_caches);
+	unsigned int i;
+
+	for (i = 0; i < table->count; i++) {
+		if (table->tc[i]->mp == mp)
+			return &table->tc[i]->cache;
+	}
+	return NULL;
+}
+
 /**
  * Get a pointer to the per-lcore default mempool cache.
  *
  * @param mp
  *   A pointer to the mempool structure.
  * @param lcore_id
- *   The logical core id.
+ *   The logical core id, or LCORE_ID_ANY for the cache registered by the
+ *   calling non-EAL thread.
  * @return
- *   A pointer to the mempool cache or NULL if disabled or non-EAL thread.
+ *   A pointer to the mempool cache or NULL if disabled or non-EAL thread
+ *   without a registered cache.
  */
 static inline struct rte_mempool_cache *__attribute__((always_inline))
 rte_mempool_default_cache(struct rte_mempool *mp, unsigned lcore_id)
 {
-	if (mp->cache_size == 0)
-		return NULL;
+	if (unlikely(lcore_id >= RTE_MAX_LCORE))
+		return __mempool_thread_cache(mp);
 
-	if (lcore_id >= RTE_MAX_LCORE)
+	if (mp->cache_size == 0)
 		return NULL;
 
 	return &mp->local_cache[lcore_id];
 }
 
+/**
+ * @internal Resize an adaptive cache according to its miss rate over the
+ * last RTE_MEMPOOL_CACHE_ADAPT_PERIOD accesses: double its size when more
+ * than 1/32 of the accesses missed, halve it when less than 1/256 did and
+ * the halved cache still holds two of the largest bursts seen meanwhile.
+ * The size of a fixed cache is bounded to itself and never changes.
+ *
+ * @param cache
+ *   A pointer to a mempool cache structure.
+ */
+static inline void
+__mempool_cache_adapt(struct rte_mempool_cache *cache)
+{
+	uint64_t misses = cache->stats.get_misses + cache->stats.put_misses;
+	uint64_t window = misses - cache->adapt_misses;
+	uint32_t size = cache->size;
+
+	if (window * 32 > RTE_MEMPOOL_CACHE_ADAPT_PERIOD)
+		size = RTE_MIN(size * 2, cache->max_size);
+	else if (window * 256 < RTE_MEMPOOL_CACHE_ADAPT_PERIOD &&
+			size / 2 > cache->adapt_burst * 2)
+		size = RTE_MAX(size / 2, cache->min_size);
+
+	cache->adapt_misses = misses;
+	cache->adapt_burst = 0;
+	cache->adapt_countdown = RTE_MEMPOOL_CACHE_ADAPT_PERIOD;
+
+	/* the excess objects are flushed by the next put */
+	if (size != cache->size) {
+		cache->size = size;
+		cache->flushthresh = size + size / 2;
+	}
+}
+
 /**
  * @internal Put several objects back in the mempool; used internally.
  * @param mp
@@ -1047,9 +1435,20 @@ __mempool_generic_put(struct rte_mempool *mp, void * const *obj_table,
 	/* increment stat now, adding in mempool always success */
 	__MEMPOOL_STAT_ADD(mp, put, n);
 
-	/* No cache provided or if put would overflow mem allocated for cache */
-	if (unlikely(cache == NULL || n > RTE_MEMPOOL_CACHE_MAX_SIZE))
+	/* No cache provided */
+	if (unlikely(cache == NULL))
+		goto ring_enqueue;
+
+	if (unlikely(--cache->adapt_countdown == 0))
+		__mempool_cache_adapt(cache);
+	if (unlikely(n > cache->adapt_burst))
+		cache->adapt_burst = n;
+
+	/* If put would overflow mem allocated for cache */
+	if (unlikely(n > RTE_MEMPOOL_CACHE_MAX_SIZE)) {
+		cache->stats.put_misses++;
 		goto ring_enqueue;
+	}
 
 	cache_objs = &cache->objs[cache->len];
 
@@ -1069,6 +1468,10 @@ __mempool_generic_put(struct rte_mempool *mp, void * const *obj_table,
 		rte_mempool_ops_enqueue_bulk(mp, &cache->objs[cache->size],
 				cache->len - cache->size);
 		cache->len = cache->size;
+		cache->stats.put_misses++;
+		cache->stats.flushes++;
+	} else {
+		__MEMPOOL_CACHE_STAT_INC(cache, put_hits);
 	}
 
 	return;
@@ -1175,9 +1578,20 @@ __mempool_generic_get(struct rte_mempool *mp, void **obj_table,
 	uint32_t index, len;
 	void **cache_objs;
 
-	/* No cache provided or cannot be satisfied from cache */
-	if (unlikely(cache == NULL || n >= cache->size))
+	/* No cache provided */
+	if (unlikely(cache == NULL))
+		goto ring_dequeue;
+
+	if (unlikely(--cache->adapt_countdown == 0))
+		__mempool_cache_adapt(cache);
+	if (unlikely(n > cache->adapt_burst))
+		cache->adapt_burst = n;
+
+	/* Cannot be satisfied from cache */
+	if (unlikely(n >= cache->size)) {
+		cache->stats.get_misses++;
 		goto ring_dequeue;
+	}
 
 	cache_objs = cache->objs;
 
@@ -1185,6 +1599,17 @@ __mempool_generic_get(struct rte_mempool *mp, void **obj_table,
 	if (cache->len < n) {
 		/* No. Backfill the cache first, and then fill from it */
 		uint32_t req = n + (cache->size - cache->len);
+		uint32_t bsz = mp->contig_block_size;
+
+		cache->stats.get_misses++;
+
+		/* Refill by whole blocks of contiguous objects, if it fits */
+		if (bsz > 1) {
+			uint32_t breq = (req + bsz - 1) / bsz * bsz;
+
+			if (cache->len + breq <= RTE_DIM(cache->objs))
+				req = breq;
+		}
 
 		/* How many do we require i.e. number to fill the cache + the request */
 		ret = rte_mempool_ops_dequeue_bulk(mp,
@@ -1200,6 +1625,9 @@ __mempool_generic_get(struct rte_mempool *mp, void **obj_table,
 		}
 
 		cache->len += req;
+		cache->stats.refills++;
+	} else {
+		__MEMPOOL_CACHE_STAT_INC(cache, get_hits);
 	}
 
 	/* Now fill in the response ... */
@@ -1315,6 +1743,40 @@ rte_mempool_get(struct rte_mempool *mp, void **obj_p)
 	return rte_mempool_get_bulk(mp, obj_p, 1);
 }
 
+/**
+ * Get contiguous blocks of objects from the mempool.
+ *
+ * The blocks are taken from the common pool, bypassing the caches. Each
+ * block holds mp->contig_block_size objects laid out one after the other,
+ * a pointer to the first object of each block is returned. The objects
+ * are freed one by one with rte_mempool_put() or rte_mempool_put_bulk().
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param first_obj_table
+ *   A pointer to a table of void * pointers (first objects) to fill.
+ * @param n
+ *   The number of blocks to get from the mempool.
+ * @return
+ *   - 0: Success; blocks taken.
+ *   - -ENOBUFS: Not enough blocks in the mempool; no block is retrieved.
+ *   - -ENOTSUP: The mempool handler does not support contiguous blocks.
+ */
+static inline int __attribute__((always_inline))
+rte_mempool_get_contig_blocks(struct rte_mempool *mp,
+			      void **first_obj_table, unsigned int n)
+{
+	int ret;
+
+	ret = rte_mempool_ops_dequeue_contig_blocks(mp, first_obj_table, n);
+	if (ret == 0)
+		__MEMPOOL_STAT_ADD(mp, get_success, n * mp->contig_block_size);
+	else if (ret != -ENOTSUP)
+		__MEMPOOL_STAT_ADD(mp, get_fail, n * mp->contig_block_size);
+
+	return ret;
+}
+
 /**
  * Return the number of entries in the mempool.
  *
@@ -85,6 +85,10 @@ rte_mempool_register_ops(const struct rte_mempool_ops *h)
 	ops->enqueue = h->enqueue;
 	ops->dequeue = h->dequeue;
 	ops->get_count = h->get_count;
+	ops->calc_mem_size = h->calc_mem_size;
+	ops->populate = h->populate;
+	ops->get_info = h->get_info;
+	ops->dequeue_contig_blocks = h->dequeue_contig_blocks;
 
 	rte_spinlock_unlock(&rte_mempool_ops_table.sl);
 
@@ -123,6 +127,52 @@ rte_mempool_ops_get_count(const struct rte_mempool *mp)
 	return ops->get_count(mp);
 }
 
+/* wrapper to get the memory size needed to store objects. */
+size_t
+rte_mempool_ops_calc_mem_size(const struct rte_mempool *mp,
+	uint32_t obj_num, uint32_t pg_shift)
+{
+	struct rte_mempool_ops *ops;
+	size_t total_elt_sz;
+
+	ops = rte_mempool_get_ops(mp->ops_index);
+	if (ops->calc_mem_size != NULL)
+		return ops->calc_mem_size(mp, obj_num, pg_shift);
+
+	total_elt_sz = mp->header_size + mp->elt_size + mp->trailer_size;
+	return rte_mempool_xmem_size(obj_num, total_elt_sz, pg_shift);
+}
+
+/* wrapper to lay out objects in a memory chunk. */
+int
+rte_mempool_ops_populate(struct rte_mempool *mp, unsigned int max_objs,
+	char *vaddr, phys_addr_t paddr, size_t len)
+{
+	struct rte_mempool_ops *ops;
+
+	ops = rte_mempool_get_ops(mp->ops_index);
+	if (ops->populate != NULL)
+		return ops->populate(mp, max_objs, vaddr, paddr, len);
+
+	return rte_mempool_op_populate_default(mp, max_objs, vaddr, paddr,
+		len);
+}
+
+/* wrapper to get additional information about an external mempool. */
+int
+rte_mempool_ops_get_info(const struct rte_mempool *mp,
+	struct rte_mempool_info *info)
+{
+	struct rte_mempool_ops *ops;
+
+	memset(info, 0, sizeof(*info));
+
+	ops = rte_mempool_get_ops(mp->ops_index);
+	if (ops->get_info == NULL)
+		return 0;
+	return ops->get_info(mp, info);
+}
+
 /* sets mempool ops previously registered by rte_mempool_register_ops. */
 int
 rte_mempool_set_ops_byname(struct rte_mempool *mp, const char *name,
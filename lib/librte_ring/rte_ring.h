@@ -82,8 +82,11 @@
  * - Bulk dequeue.
  * - Bulk enqueue.
  *
- * Note: the ring implementation is not preemptable. A lcore must not
- * be interrupted by another task that uses the same ring.
+ * Note: the default MP/MC implementation is not preemptable. A lcore must
+ * not be interrupted by another task that uses the same ring. Rings shared
+ * by more threads than there are cores can use the relaxed tail sync
+ * (RTS) or head/tail sync (HTS) modes instead, see rte_ring_rts.h and
+ * rte_ring_hts.h.
  *
  */
 
@@ -101,6 +104,7 @@ extern "C" {
 #include <rte_atomic.h>
 #include <rte_branch_prediction.h>
 #include <rte_memzone.h>
+#include <rte_debug.h>
 
 #define RTE_TAILQ_RING_NAME "RTE_RING"
 
@@ -124,11 +128,60 @@ struct rte_memzone; /* forward declaration, so as not to require memzone.h */
 #define CONS_ALIGN RTE_CACHE_LINE_SIZE
 #endif
 
+/** prod/cons sync types */
+enum rte_ring_sync_type {
+	RTE_RING_SYNC_MT,     /**< multi-thread safe (default mode) */
+	RTE_RING_SYNC_ST,     /**< single thread only */
+	RTE_RING_SYNC_MT_RTS, /**< multi-thread relaxed tail sync */
+	RTE_RING_SYNC_MT_HTS, /**< multi-thread head/tail sync */
+};
+
 /* structure to hold a pair of head/tail values and other metadata */
 struct rte_ring_headtail {
 	volatile uint32_t head;  /**< Prod/consumer head. */
 	volatile uint32_t tail;  /**< Prod/consumer tail. */
-	uint32_t single;         /**< True if single prod/cons */
+	RTE_STD_C11
+	union {
+		/** Sync type of prod/cons. */
+		enum rte_ring_sync_type sync_type;
+		/** Kept for compatibility, __IS_SP/__IS_SC only when sync_type
+		 *  is RTE_RING_SYNC_ST. */
+		uint32_t single;
+	};
+};
+
+/* head or tail of a RTS prod/cons: position and update counter */
+union __rte_ring_rts_poscnt {
+	/** raw 8B value to read/write *cnt* and *pos* as one atomic op */
+	uint64_t raw;
+	struct {
+		uint32_t cnt; /**< head/tail reference counter */
+		uint32_t pos; /**< head/tail position */
+	} val;
+};
+
+/* relaxed tail sync (RTS) prod/cons metadata, see rte_ring_rts.h */
+struct rte_ring_rts_headtail {
+	volatile union __rte_ring_rts_poscnt tail;
+	enum rte_ring_sync_type sync_type;  /**< sync type of prod/cons */
+	uint32_t htd_max;   /**< max allowed distance between head/tail */
+	volatile union __rte_ring_rts_poscnt head;
+};
+
+/* head and tail of a HTS prod/cons */
+union __rte_ring_hts_pos {
+	/** raw 8B value to read/write *head* and *tail* as one atomic op */
+	uint64_t raw;
+	struct {
+		uint32_t head; /**< head position */
+		uint32_t tail; /**< tail position */
+	} pos;
+};
+
+/* head/tail sync (HTS) prod/cons metadata, see rte_ring_hts.h */
+struct rte_ring_hts_headtail {
+	volatile union __rte_ring_hts_pos ht;
+	enum rte_ring_sync_type sync_type;  /**< sync type of prod/cons */
 };
 
 /**
@@ -154,15 +207,38 @@ struct rte_ring {
 	uint32_t size;           /**< Size of ring. */
 	uint32_t mask;           /**< Mask (size-1) of ring. */
 
+	/*
+	 * The tail and sync_type fields are at the same offset in the three
+	 * layouts, so that the tail of the other side and the sync type can
+	 * always be read through prod/cons.
+	 */
 	/** Ring producer status. */
-	struct rte_ring_headtail prod __rte_aligned(PROD_ALIGN);
+	RTE_STD_C11
+	union {
+		struct rte_ring_headtail prod;
+		struct rte_ring_hts_headtail hts_prod;
+		struct rte_ring_rts_headtail rts_prod;
+	} __rte_aligned(PROD_ALIGN);
 
 	/** Ring consumer status. */
-	struct rte_ring_headtail cons __rte_aligned(CONS_ALIGN);
+	RTE_STD_C11
+	union {
+		struct rte_ring_headtail cons;
+		struct rte_ring_hts_headtail hts_cons;
+		struct rte_ring_rts_headtail rts_cons;
+	} __rte_aligned(CONS_ALIGN);
 };
 
 #define RING_F_SP_ENQ 0x0001 /**< The default enqueue is "single-producer". */
 #define RING_F_SC_DEQ 0x0002 /**< The default dequeue is "single-consumer". */
+/** The default enqueue is "MP RTS", see rte_ring_rts.h. */
+#define RING_F_MP_RTS_ENQ 0x0008
+/** The default dequeue is "MC RTS", see rte_ring_rts.h. */
+#define RING_F_MC_RTS_DEQ 0x0010
+/** The default enqueue is "MP HTS", see rte_ring_hts.h. */
+#define RING_F_MP_HTS_ENQ 0x0020
+/** The default dequeue is "MC HTS", see rte_ring_hts.h. */
+#define RING_F_MC_HTS_DEQ 0x0040
 #define RTE_RING_SZ_MASK  (unsigned)(0x0fffffff) /**< Ring size mask */
 
 /* @internal defines for passing to the enqueue dequeue worker functions */
@@ -218,6 +294,12 @@ ssize_t rte_ring_get_memsize(unsigned count);
  *    - RING_F_SC_DEQ: If this flag is set, the default behavior when
  *      using ``rte_ring_dequeue()`` or ``rte_ring_dequeue_bulk()``
  *      is "single-consumer". Otherwise, it is "multi-consumers".
+ *    - RING_F_MP_RTS_ENQ/RING_F_MP_HTS_ENQ: the default enqueue is
+ *      "multi-producers" with relaxed tail sync, respectively head/tail
+ *      sync. At most one of the three enqueue flags can be given.
+ *    - RING_F_MC_RTS_DEQ/RING_F_MC_HTS_DEQ: the default dequeue is
+ *      "multi-consumers" with relaxed tail sync, respectively head/tail
+ *      sync. At most one of the three dequeue flags can be given.
  * @return
  *   0 on success, or a negative value on error.
  */
@@ -253,12 +335,18 @@ int rte_ring_init(struct rte_ring *r, const char *name, unsigned count,
  *    - RING_F_SC_DEQ: If this flag is set, the default behavior when
  *      using ``rte_ring_dequeue()`` or ``rte_ring_dequeue_bulk()``
  *      is "single-consumer". Otherwise, it is "multi-consumers".
+ *    - RING_F_MP_RTS_ENQ/RING_F_MP_HTS_ENQ: the default enqueue is
+ *      "multi-producers" with relaxed tail sync, respectively head/tail
+ *      sync. At most one of the three enqueue flags can be given.
+ *    - RING_F_MC_RTS_DEQ/RING_F_MC_HTS_DEQ: the default dequeue is
+ *      "multi-consumers" with relaxed tail sync, respectively head/tail
+ *      sync. At most one of the three dequeue flags can be given.
  * @return
  *   On success, the pointer to the new allocated ring. NULL on error with
  *    rte_errno set appropriately. Possible errno values include:
  *    - E_RTE_NO_CONFIG - function could not get pointer to rte_config structure
  *    - E_RTE_SECONDARY - function was called from a secondary process instance
- *    - EINVAL - count provided is not a power of 2
+ *    - EINVAL - count provided is not a power of 2, or invalid flags
  *    - ENOSPC - the maximum number of memzones has already been allocated
  *    - EEXIST - a memzone with the same name already exists
  *    - ENOMEM - no appropriate memory area found in which to create memzone
@@ -572,6 +660,9 @@ __rte_ring_do_dequeue(struct rte_ring *r, void **obj_table,
 	return n;
 }
 
+#include "rte_ring_hts.h"
+#include "rte_ring_rts.h"
+
 /**
  * Enqueue several objects on the ring (multi-producers safe).
  *
@@ -624,7 +715,7 @@ rte_ring_sp_enqueue_bulk(struct rte_ring *r, void * const *obj_table,
 /**
  * Enqueue several objects on a ring.
  *
- * This function calls the multi-producer or the single-producer
+ * This function calls the multi-producer, single-producer, RTS or HTS
  * version depending on the default behavior that was specified at
  * ring creation time (see flags).
  *
@@ -644,8 +735,20 @@ static inline unsigned int __attribute__((always_inline))
 rte_ring_enqueue_bulk(struct rte_ring *r, void * const *obj_table,
 		      unsigned int n, unsigned int *free_space)
 {
-	return __rte_ring_do_enqueue(r, obj_table, n, RTE_RING_QUEUE_FIXED,
-			r->prod.single, free_space);
+	switch (r->prod.sync_type) {
+	case RTE_RING_SYNC_MT:
+		return rte_ring_mp_enqueue_bulk(r, obj_table, n, free_space);
+	case RTE_RING_SYNC_ST:
+		return rte_ring_sp_enqueue_bulk(r, obj_table, n, free_space);
+	case RTE_RING_SYNC_MT_RTS:
+		return rte_ring_mp_rts_enqueue_bulk(r, obj_table, n, free_space);
+	case RTE_RING_SYNC_MT_HTS:
+		return rte_ring_mp_hts_enqueue_bulk(r, obj_table, n, free_space);
+	}
+
+	/* valid ring should never reach this point */
+	RTE_ASSERT(0);
+	return 0;
 }
 
 /**
@@ -759,7 +862,7 @@ rte_ring_sc_dequeue_bulk(struct rte_ring *r, void **obj_table,
 /**
  * Dequeue several objects from a ring.
  *
- * This function calls the multi-consumers or the single-consumer
+ * This function calls the multi-consumers, single-consumer, RTS or HTS
  * version, depending on the default behaviour that was specified at
  * ring creation time (see flags).
  *
@@ -779,8 +882,20 @@ static inline unsigned int __attribute__((always_inline))
 rte_ring_dequeue_bulk(struct rte_ring *r, void **obj_table, unsigned int n,
 		unsigned int *available)
 {
-	return __rte_ring_do_dequeue(r, obj_table, n, RTE_RING_QUEUE_FIXED,
-				r->cons.single, available);
+	switch (r->cons.sync_type) {
+	case RTE_RING_SYNC_MT:
+		return rte_ring_mc_dequeue_bulk(r, obj_table, n, available);
+	case RTE_RING_SYNC_ST:
+		return rte_ring_sc_dequeue_bulk(r, obj_table, n, available);
+	case RTE_RING_SYNC_MT_RTS:
+		return rte_ring_mc_rts_dequeue_bulk(r, obj_table, n, available);
+	case RTE_RING_SYNC_MT_HTS:
+		return rte_ring_mc_hts_dequeue_bulk(r, obj_table, n, available);
+	}
+
+	/* valid ring should never reach this point */
+	RTE_ASSERT(0);
+	return 0;
 }
 
 /**
@@ -996,7 +1111,7 @@ rte_ring_sp_enqueue_burst(struct rte_ring *r, void * const *obj_table,
 /**
  * Enqueue several objects on a ring.
  *
- * This function calls the multi-producer or the single-producer
+ * This function calls the multi-producer, single-producer, RTS or HTS
  * version depending on the default behavior that was specified at
  * ring creation time (see flags).
  *
@@ -1016,8 +1131,20 @@ static inline unsigned __attribute__((always_inline))
 rte_ring_enqueue_burst(struct rte_ring *r, void * const *obj_table,
 		      unsigned int n, unsigned int *free_space)
 {
-	return __rte_ring_do_enqueue(r, obj_table, n, RTE_RING_QUEUE_VARIABLE,
-			r->prod.single, free_space);
+	switch (r->prod.sync_type) {
+	case RTE_RING_SYNC_MT:
+		return rte_ring_mp_enqueue_burst(r, obj_table, n, free_space);
+	case RTE_RING_SYNC_ST:
+		return rte_ring_sp_enqueue_burst(r, obj_table, n, free_space);
+	case RTE_RING_SYNC_MT_RTS:
+		return rte_ring_mp_rts_enqueue_burst(r, obj_table, n, free_space);
+	case RTE_RING_SYNC_MT_HTS:
+		return rte_ring_mp_hts_enqueue_burst(r, obj_table, n, free_space);
+	}
+
+	/* valid ring should never reach this point */
+	RTE_ASSERT(0);
+	return 0;
 }
 
 /**
@@ -1076,7 +1203,7 @@ rte_ring_sc_dequeue_burst(struct rte_ring *r, void **obj_table,
 /**
  * Dequeue multiple objects from a ring up to a maximum number.
  *
- * This function calls the multi-consumers or the single-consumer
+ * This function calls the multi-consumers, single-consumer, RTS or HTS
  * version, depending on the default behaviour that was specified at
  * ring creation time (see flags).
  *
@@ -1096,9 +1223,20 @@ static inline unsigned __attribute__((always_inline))
 rte_ring_dequeue_burst(struct rte_ring *r, void **obj_table,
 		unsigned int n, unsigned int *available)
 {
-	return __rte_ring_do_dequeue(r, obj_table, n,
-				RTE_RING_QUEUE_VARIABLE,
-				r->cons.single, available);
+	switch (r->cons.sync_type) {
+	case RTE_RING_SYNC_MT:
+		return rte_ring_mc_dequeue_burst(r, obj_table, n, available);
+	case RTE_RING_SYNC_ST:
+		return rte_ring_sc_dequeue_burst(r, obj_table, n, available);
+	case RTE_RING_SYNC_MT_RTS:
+		return rte_ring_mc_rts_dequeue_burst(r, obj_table, n, available);
+	case RTE_RING_SYNC_MT_HTS:
+		return rte_ring_mc_hts_dequeue_burst(r, obj_table, n, available);
+	}
+
+	/* valid ring should never reach this point */
+	RTE_ASSERT(0);
+	return 0;
 }
 
 #ifdef __cplusplus
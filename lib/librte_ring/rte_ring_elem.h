@@ -0,0 +1,994 @@
+/*
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Semihalf. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Semihalf nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_RING_ELEM_H_
+#define _RTE_RING_ELEM_H_
+
+/**
+ * @file
+ * RTE Ring with user defined element size
+ *
+ * Variant of the ring API which stores elements of a fixed, user defined
+ * size (a multiple of 4 bytes) by value instead of void * pointers. Small
+ * messages can then be passed between lcores without allocating and
+ * referencing them from a mempool.
+ *
+ * The ring structure, the head/tail handling and the MP/MC/SP/SC
+ * semantics are the ones of rte_ring.h. The element size is not stored in
+ * the ring: the same value must be given at creation time and to every
+ * enqueue/dequeue call. Pointer rings are element rings of
+ * sizeof(void *) bytes.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "rte_ring.h"
+
+/**
+ * Calculate the memory size needed for a ring with given element size
+ *
+ * This function returns the number of bytes needed for a ring, given
+ * the number of elements in it and the size of the element. This value
+ * is the sum of the size of the structure rte_ring and the size of the
+ * memory needed for storing the elements. The value is aligned to a cache
+ * line size.
+ *
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4.
+ * @param count
+ *   The number of elements in the ring (must be a power of 2).
+ * @return
+ *   - The memory size needed for the ring on success.
+ *   - -EINVAL if esize is not a multiple of 4 or count is not a power of 2.
+ */
+ssize_t rte_ring_get_memsize_elem(unsigned int esize, unsigned int count);
+
+/**
+ * Create a new ring named *name* that stores elements with given size.
+ *
+ * This function uses ``memzone_reserve()`` to allocate memory. Then it
+ * calls rte_ring_init() to initialize an empty ring.
+ *
+ * The new ring size is set to *count*, which must be a power of
+ * two. Water marking is disabled by default. The real usable ring size
+ * is *count-1* instead of *count* to differentiate a free ring from an
+ * empty ring.
+ *
+ * The ring is added in RTE_TAILQ_RING list.
+ *
+ * @param name
+ *   The name of the ring.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4.
+ * @param count
+ *   The number of elements in the ring (must be a power of 2).
+ * @param socket_id
+ *   The *socket_id* argument is the socket identifier in case of
+ *   NUMA. The value can be *SOCKET_ID_ANY* if there is no NUMA
+ *   constraint for the reserved zone.
+ * @param flags
+ *   An OR of RING_F_SP_ENQ and RING_F_SC_DEQ, see rte_ring_create().
+ * @return
+ *   On success, the pointer to the new allocated ring. NULL on error with
+ *    rte_errno set appropriately. Possible errno values include:
+ *    - E_RTE_NO_CONFIG - function could not get pointer to rte_config structure
+ *    - E_RTE_SECONDARY - function was called from a secondary process instance
+ *    - EINVAL - esize is not a multiple of 4 or count is not a power of 2
+ *    - ENOSPC - the maximum number of memzones has already been allocated
+ *    - EEXIST - a memzone with the same name already exists
+ *    - ENOMEM - no appropriate memory area found in which to create memzone
+ */
+struct rte_ring *rte_ring_create_elem(const char *name, unsigned int esize,
+		unsigned int count, int socket_id, unsigned int flags);
+
+/* the actual enqueue of elements on the ring.
+ * ring and obj are arrays of 32 or 64 bit words, idx, size and n are
+ * counted in those words. */
+#define ENQUEUE_ELEMS(ring, obj, idx, size, n) do { \
+	unsigned int i; \
+	if (likely(idx + n < size)) { \
+		for (i = 0; i < (n & (~(unsigned)0x3)); i += 4, idx += 4) { \
+			ring[idx] = obj[i]; \
+			ring[idx + 1] = obj[i + 1]; \
+			ring[idx + 2] = obj[i + 2]; \
+			ring[idx + 3] = obj[i + 3]; \
+		} \
+		switch (n & 0x3) { \
+		case 3: \
+			ring[idx++] = obj[i++]; /* fallthrough */ \
+		case 2: \
+			ring[idx++] = obj[i++]; /* fallthrough */ \
+		case 1: \
+			ring[idx++] = obj[i++]; \
+		} \
+	} else { \
+		for (i = 0; idx < size; i++, idx++) \
+			ring[idx] = obj[i]; \
+		for (idx = 0; i < n; i++, idx++) \
+			ring[idx] = obj[i]; \
+	} \
+} while (0)
+
+/* the actual copy of elements from the ring to obj_table.
+ * ring and obj are arrays of 32 or 64 bit words, idx, size and n are
+ * counted in those words. */
+#define DEQUEUE_ELEMS(ring, obj, idx, size, n) do { \
+	unsigned int i; \
+	if (likely(idx + n < size)) { \
+		for (i = 0; i < (n & (~(unsigned)0x3)); i += 4, idx += 4) { \
+			obj[i] = ring[idx]; \
+			obj[i + 1] = ring[idx + 1]; \
+			obj[i + 2] = ring[idx + 2]; \
+			obj[i + 3] = ring[idx + 3]; \
+		} \
+		switch (n & 0x3) { \
+		case 3: \
+			obj[i++] = ring[idx++]; /* fallthrough */ \
+		case 2: \
+			obj[i++] = ring[idx++]; /* fallthrough */ \
+		case 1: \
+			obj[i++] = ring[idx++]; \
+		} \
+	} else { \
+		for (i = 0; idx < size; i++, idx++) \
+			obj[i] = ring[idx]; \
+		for (idx = 0; i < n; i++, idx++) \
+			obj[i] = ring[idx]; \
+	} \
+} while (0)
+
+/**
+ * @internal Copy *n* elements of *esize* bytes from obj_table to the ring
+ * slots starting at *head*. Elements which are a multiple of 8 bytes are
+ * moved as 64 bit words, all others as 32 bit words. As esize is a
+ * compile time constant in the callers, the unused path is optimized out.
+ */
+static inline __attribute__((always_inline)) void
+__rte_ring_enqueue_elems(struct rte_ring *r, uint32_t head,
+		const void *obj_table, unsigned int esize, unsigned int n)
+{
+	uint32_t idx = head & r->mask;
+
+	if ((esize & 0x7) == 0) {
+		const unsigned int scale = esize / sizeof(uint64_t);
+		uint64_t *ring = (uint64_t *)&r[1];
+		const uint64_t *obj = (const uint64_t *)obj_table;
+		uint32_t nr_idx = idx * scale;
+		const uint32_t nr_size = r->size * scale;
+		const uint32_t nr_n = n * scale;
+
+		ENQUEUE_ELEMS(ring, obj, nr_idx, nr_size, nr_n);
+	} else {
+		const unsigned int scale = esize / sizeof(uint32_t);
+		uint32_t *ring = (uint32_t *)&r[1];
+		const uint32_t *obj = (const uint32_t *)obj_table;
+		uint32_t nr_idx = idx * scale;
+		const uint32_t nr_size = r->size * scale;
+		const uint32_t nr_n = n * scale;
+
+		ENQUEUE_ELEMS(ring, obj, nr_idx, nr_size, nr_n);
+	}
+}
+
+/**
+ * @internal Copy *n* elements of *esize* bytes from the ring slots
+ * starting at *head* to obj_table.
+ */
+static inline __attribute__((always_inline)) void
+__rte_ring_dequeue_elems(struct rte_ring *r, uint32_t head,
+		void *obj_table, unsigned int esize, unsigned int n)
+{
+	uint32_t idx = head & r->mask;
+
+	if ((esize & 0x7) == 0) {
+		const unsigned int scale = esize / sizeof(uint64_t);
+		const uint64_t *ring = (const uint64_t *)&r[1];
+		uint64_t *obj = (uint64_t *)obj_table;
+		uint32_t nr_idx = idx * scale;
+		const uint32_t nr_size = r->size * scale;
+		const uint32_t nr_n = n * scale;
+
+		DEQUEUE_ELEMS(ring, obj, nr_idx, nr_size, nr_n);
+	} else {
+		const unsigned int scale = esize / sizeof(uint32_t);
+		const uint32_t *ring = (const uint32_t *)&r[1];
+		uint32_t *obj = (uint32_t *)obj_table;
+		uint32_t nr_idx = idx * scale;
+		const uint32_t nr_size = r->size * scale;
+		const uint32_t nr_n = n * scale;
+
+		DEQUEUE_ELEMS(ring, obj, nr_idx, nr_size, nr_n);
+	}
+}
+
+/**
+ * @internal Enqueue several elements on the ring
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4 and
+ *   match the value used when creating the ring.
+ * @param n
+ *   The number of elements to add in the ring from the obj_table.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED:    Enqueue a fixed number of items from a ring
+ *   RTE_RING_QUEUE_VARIABLE: Enqueue as many items as possible from ring
+ * @param is_sp
+ *   Indicates whether to use single producer or multi-producer head update
+ * @param free_space
+ *   returns the amount of space after the enqueue operation has finished
+ * @return
+ *   Actual number of elements enqueued.
+ *   If behavior == RTE_RING_QUEUE_FIXED, this will be 0 or n only.
+ */
+static inline __attribute__((always_inline)) unsigned int
+__rte_ring_do_enqueue_elem(struct rte_ring *r, const void *obj_table,
+		unsigned int esize, unsigned int n,
+		enum rte_ring_queue_behavior behavior, int is_sp,
+		unsigned int *free_space)
+{
+	uint32_t prod_head, prod_next;
+	uint32_t free_entries;
+
+	n = __rte_ring_move_prod_head(r, is_sp, n, behavior,
+			&prod_head, &prod_next, &free_entries);
+	if (n == 0)
+		goto end;
+
+	__rte_ring_enqueue_elems(r, prod_head, obj_table, esize, n);
+	rte_smp_wmb();
+
+	update_tail(&r->prod, prod_head, prod_next, is_sp);
+end:
+	if (free_space != NULL)
+		*free_space = free_entries - n;
+	return n;
+}
+
+/**
+ * @internal Dequeue several elements from the ring
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements that will be filled.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4 and
+ *   match the value used when creating the ring.
+ * @param n
+ *   The number of elements to pull from the ring.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED:    Dequeue a fixed number of items from a ring
+ *   RTE_RING_QUEUE_VARIABLE: Dequeue as many items as possible from ring
+ * @param is_sc
+ *   Indicates whether to use single consumer or multi-consumer head update
+ * @param available
+ *   returns the number of remaining ring entries after the dequeue has finished
+ * @return
+ *   - Actual number of elements dequeued.
+ *     If behavior == RTE_RING_QUEUE_FIXED, this will be 0 or n only.
+ */
+static inline __attribute__((always_inline)) unsigned int
+__rte_ring_do_dequeue_elem(struct rte_ring *r, void *obj_table,
+		unsigned int esize, unsigned int n,
+		enum rte_ring_queue_behavior behavior, int is_sc,
+		unsigned int *available)
+{
+	uint32_t cons_head, cons_next;
+	uint32_t entries;
+
+	n = __rte_ring_move_cons_head(r, is_sc, n, behavior,
+			&cons_head, &cons_next, &entries);
+	if (n == 0)
+		goto end;
+
+	__rte_ring_dequeue_elems(r, cons_head, obj_table, esize, n);
+	rte_smp_rmb();
+
+	update_tail(&r->cons, cons_head, cons_next, is_sc);
+
+end:
+	if (available != NULL)
+		*available = entries - n;
+	return n;
+}
+
+/**
+ * @internal Enqueue several elements on the HTS ring,
+ * see __rte_ring_do_enqueue_elem().
+ */
+static inline __attribute__((always_inline)) unsigned int
+__rte_ring_do_hts_enqueue_elem(struct rte_ring *r, const void *obj_table,
+		unsigned int esize, unsigned int n,
+		enum rte_ring_queue_behavior behavior, unsigned int *free_space)
+{
+	uint32_t head;
+	uint32_t free_entries;
+
+	n = __rte_ring_hts_move_prod_head(r, n, behavior,
+			&head, &free_entries);
+	if (n == 0)
+		goto end;
+
+	__rte_ring_enqueue_elems(r, head, obj_table, esize, n);
+	rte_smp_wmb();
+
+	__rte_ring_hts_update_tail(&r->hts_prod, head, n);
+end:
+	if (free_space != NULL)
+		*free_space = free_entries - n;
+	return n;
+}
+
+/**
+ * @internal Dequeue several elements from the HTS ring,
+ * see __rte_ring_do_dequeue_elem().
+ */
+static inline __attribute__((always_inline)) unsigned int
+__rte_ring_do_hts_dequeue_elem(struct rte_ring *r, void *obj_table,
+		unsigned int esize, unsigned int n,
+		enum rte_ring_queue_behavior behavior, unsigned int *available)
+{
+	uint32_t head;
+	uint32_t entries;
+
+	n = __rte_ring_hts_move_cons_head(r, n, behavior,
+			&head, &entries);
+	if (n == 0)
+		goto end;
+
+	__rte_ring_dequeue_elems(r, head, obj_table, esize, n);
+	rte_smp_rmb();
+
+	__rte_ring_hts_update_tail(&r->hts_cons, head, n);
+end:
+	if (available != NULL)
+		*available = entries - n;
+	return n;
+}
+
+/**
+ * @internal Enqueue several elements on the RTS ring,
+ * see __rte_ring_do_enqueue_elem().
+ */
+static inline __attribute__((always_inline)) unsigned int
+__rte_ring_do_rts_enqueue_elem(struct rte_ring *r, const void *obj_table,
+		unsigned int esize, unsigned int n,
+		enum rte_ring_queue_behavior behavior, unsigned int *free_space)
+{
+	uint32_t head;
+	uint32_t free_entries;
+
+	n = __rte_ring_rts_move_prod_head(r, n, behavior,
+			&head, &free_entries);
+	if (n == 0)
+		goto end;
+
+	__rte_ring_enqueue_elems(r, head, obj_table, esize, n);
+	rte_smp_wmb();
+
+	__rte_ring_rts_update_tail(&r->rts_prod);
+end:
+	if (free_space != NULL)
+		*free_space = free_entries - n;
+	return n;
+}
+
+/**
+ * @internal Dequeue several elements from the RTS ring,
+ * see __rte_ring_do_dequeue_elem().
+ */
+static inline __attribute__((always_inline)) unsigned int
+__rte_ring_do_rts_dequeue_elem(struct rte_ring *r, void *obj_table,
+		unsigned int esize, unsigned int n,
+		enum rte_ring_queue_behavior behavior, unsigned int *available)
+{
+	uint32_t head;
+	uint32_t entries;
+
+	n = __rte_ring_rts_move_cons_head(r, n, behavior,
+			&head, &entries);
+	if (n == 0)
+		goto end;
+
+	__rte_ring_dequeue_elems(r, head, obj_table, esize, n);
+	rte_smp_rmb();
+
+	__rte_ring_rts_update_tail(&r->rts_cons);
+end:
+	if (available != NULL)
+		*available = entries - n;
+	return n;
+}
+
+/**
+ * @internal Enqueue several elements on the ring, using the producer sync
+ * mode specified at ring creation time (see flags).
+ */
+static inline __attribute__((always_inline)) unsigned int
+__rte_ring_do_enqueue_elem_default(struct rte_ring *r, const void *obj_table,
+		unsigned int esize, unsigned int n,
+		enum rte_ring_queue_behavior behavior, unsigned int *free_space)
+{
+	switch (r->prod.sync_type) {
+	case RTE_RING_SYNC_MT:
+		return __rte_ring_do_enqueue_elem(r, obj_table, esize, n,
+				behavior, __IS_MP, free_space);
+	case RTE_RING_SYNC_ST:
+		return __rte_ring_do_enqueue_elem(r, obj_table, esize, n,
+				behavior, __IS_SP, free_space);
+	case RTE_RING_SYNC_MT_RTS:
+		return __rte_ring_do_rts_enqueue_elem(r, obj_table, esize, n,
+				behavior, free_space);
+	case RTE_RING_SYNC_MT_HTS:
+		return __rte_ring_do_hts_enqueue_elem(r, obj_table, esize, n,
+				behavior, free_space);
+	}
+
+	/* valid ring should never reach this point */
+	RTE_ASSERT(0);
+	return 0;
+}
+
+/**
+ * @internal Dequeue several elements from the ring, using the consumer
+ * sync mode specified at ring creation time (see flags).
+ */
+static inline __attribute__((always_inline)) unsigned int
+__rte_ring_do_dequeue_elem_default(struct rte_ring *r, void *obj_table,
+		unsigned int esize, unsigned int n,
+		enum rte_ring_queue_behavior behavior, unsigned int *available)
+{
+	switch (r->cons.sync_type) {
+	case RTE_RING_SYNC_MT:
+		return __rte_ring_do_dequeue_elem(r, obj_table, esize, n,
+				behavior, __IS_MC, available);
+	case RTE_RING_SYNC_ST:
+		return __rte_ring_do_dequeue_elem(r, obj_table, esize, n,
+				behavior, __IS_SC, available);
+	case RTE_RING_SYNC_MT_RTS:
+		return __rte_ring_do_rts_dequeue_elem(r, obj_table, esize, n,
+				behavior, available);
+	case RTE_RING_SYNC_MT_HTS:
+		return __rte_ring_do_hts_dequeue_elem(r, obj_table, esize, n,
+				behavior, available);
+	}
+
+	/* valid ring should never reach this point */
+	RTE_ASSERT(0);
+	return 0;
+}
+
+/**
+ * Enqueue several elements on the ring (multi-producers safe).
+ *
+ * This function uses a "compare and set" instruction to move the
+ * producer index atomically.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4 and
+ *   match the value used when creating the ring.
+ * @param n
+ *   The number of elements to add in the ring from the obj_table.
+ * @param free_space
+ *   if non-NULL, returns the amount of space in the ring after the
+ *   enqueue operation has finished.
+ * @return
+ *   The number of elements enqueued, either 0 or n
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_ring_mp_enqueue_bulk_elem(struct rte_ring *r, const void *obj_table,
+		unsigned int esize, unsigned int n, unsigned int *free_space)
+{
+	return __rte_ring_do_enqueue_elem(r, obj_table, esize, n,
+			RTE_RING_QUEUE_FIXED, __IS_MP, free_space);
+}
+
+/**
+ * Enqueue several elements on a ring (NOT multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4 and
+ *   match the value used when creating the ring.
+ * @param n
+ *   The number of elements to add in the ring from the obj_table.
+ * @param free_space
+ *   if non-NULL, returns the amount of space in the ring after the
+ *   enqueue operation has finished.
+ * @return
+ *   The number of elements enqueued, either 0 or n
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_ring_sp_enqueue_bulk_elem(struct rte_ring *r, const void *obj_table,
+		unsigned int esize, unsigned int n, unsigned int *free_space)
+{
+	return __rte_ring_do_enqueue_elem(r, obj_table, esize, n,
+			RTE_RING_QUEUE_FIXED, __IS_SP, free_space);
+}
+
+/**
+ * Enqueue several elements on a ring.
+ *
+ * This function calls the multi-producer, single-producer, RTS or HTS
+ * version depending on the default behavior that was specified at
+ * ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4 and
+ *   match the value used when creating the ring.
+ * @param n
+ *   The number of elements to add in the ring from the obj_table.
+ * @param free_space
+ *   if non-NULL, returns the amount of space in the ring after the
+ *   enqueue operation has finished.
+ * @return
+ *   The number of elements enqueued, either 0 or n
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_ring_enqueue_bulk_elem(struct rte_ring *r, const void *obj_table,
+		unsigned int esize, unsigned int n, unsigned int *free_space)
+{
+	return __rte_ring_do_enqueue_elem_default(r, obj_table, esize, n,
+			RTE_RING_QUEUE_FIXED, free_space);
+}
+
+/**
+ * Enqueue one element on a ring (multi-producers safe).
+ *
+ * This function uses a "compare and set" instruction to move the
+ * producer index atomically.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj
+ *   A pointer to the element to be added.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4 and
+ *   match the value used when creating the ring.
+ * @return
+ *   - 0: Success; element enqueued.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue; no element is enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_mp_enqueue_elem(struct rte_ring *r, const void *obj,
+		unsigned int esize)
+{
+	return rte_ring_mp_enqueue_bulk_elem(r, obj, esize, 1, NULL) ?
+		0 : -ENOBUFS;
+}
+
+/**
+ * Enqueue one element on a ring (NOT multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj
+ *   A pointer to the element to be added.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4 and
+ *   match the value used when creating the ring.
+ * @return
+ *   - 0: Success; element enqueued.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue; no element is enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_sp_enqueue_elem(struct rte_ring *r, const void *obj,
+		unsigned int esize)
+{
+	return rte_ring_sp_enqueue_bulk_elem(r, obj, esize, 1, NULL) ?
+		0 : -ENOBUFS;
+}
+
+/**
+ * Enqueue one element on a ring.
+ *
+ * This function calls the multi-producer or the single-producer
+ * version depending on the default behavior that was specified at
+ * ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj
+ *   A pointer to the element to be added.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4 and
+ *   match the value used when creating the ring.
+ * @return
+ *   - 0: Success; element enqueued.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue; no element is enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_enqueue_elem(struct rte_ring *r, const void *obj,
+		unsigned int esize)
+{
+	return rte_ring_enqueue_bulk_elem(r, obj, esize, 1, NULL) ?
+		0 : -ENOBUFS;
+}
+
+/**
+ * Dequeue several elements from a ring (multi-consumers safe).
+ *
+ * This function uses a "compare and set" instruction to move the
+ * consumer index atomically.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements that will be filled.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4 and
+ *   match the value used when creating the ring.
+ * @param n
+ *   The number of elements to dequeue from the ring to the obj_table.
+ * @param available
+ *   If non-NULL, returns the number of remaining ring entries after the
+ *   dequeue has finished.
+ * @return
+ *   The number of elements dequeued, either 0 or n
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_ring_mc_dequeue_bulk_elem(struct rte_ring *r, void *obj_table,
+		unsigned int esize, unsigned int n, unsigned int *available)
+{
+	return __rte_ring_do_dequeue_elem(r, obj_table, esize, n,
+			RTE_RING_QUEUE_FIXED, __IS_MC, available);
+}
+
+/**
+ * Dequeue several elements from a ring (NOT multi-consumers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements that will be filled.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4 and
+ *   match the value used when creating the ring.
+ * @param n
+ *   The number of elements to dequeue from the ring to the obj_table.
+ * @param available
+ *   If non-NULL, returns the number of remaining ring entries after the
+ *   dequeue has finished.
+ * @return
+ *   The number of elements dequeued, either 0 or n
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_ring_sc_dequeue_bulk_elem(struct rte_ring *r, void *obj_table,
+		unsigned int esize, unsigned int n, unsigned int *available)
+{
+	return __rte_ring_do_dequeue_elem(r, obj_table, esize, n,
+			RTE_RING_QUEUE_FIXED, __IS_SC, available);
+}
+
+/**
+ * Dequeue several elements from a ring.
+ *
+ * This function calls the multi-consumers, single-consumer, RTS or HTS
+ * version depending on the default behavior that was specified at
+ * ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements that will be filled.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4 and
+ *   match the value used when creating the ring.
+ * @param n
+ *   The number of elements to dequeue from the ring to the obj_table.
+ * @param available
+ *   If non-NULL, returns the number of remaining ring entries after the
+ *   dequeue has finished.
+ * @return
+ *   The number of elements dequeued, either 0 or n
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_ring_dequeue_bulk_elem(struct rte_ring *r, void *obj_table,
+		unsigned int esize, unsigned int n, unsigned int *available)
+{
+	return __rte_ring_do_dequeue_elem_default(r, obj_table, esize, n,
+			RTE_RING_QUEUE_FIXED, available);
+}
+
+/**
+ * Dequeue one element from a ring (multi-consumers safe).
+ *
+ * This function uses a "compare and set" instruction to move the
+ * consumer index atomically.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_p
+ *   A pointer to the element that will be filled.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4 and
+ *   match the value used when creating the ring.
+ * @return
+ *   - 0: Success, element dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue, no element is
+ *     dequeued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_mc_dequeue_elem(struct rte_ring *r, void *obj_p,
+		unsigned int esize)
+{
+	return rte_ring_mc_dequeue_bulk_elem(r, obj_p, esize, 1, NULL) ?
+		0 : -ENOENT;
+}
+
+/**
+ * Dequeue one element from a ring (NOT multi-consumers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_p
+ *   A pointer to the element that will be filled.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4 and
+ *   match the value used when creating the ring.
+ * @return
+ *   - 0: Success, element dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue, no element is
+ *     dequeued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_sc_dequeue_elem(struct rte_ring *r, void *obj_p,
+		unsigned int esize)
+{
+	return rte_ring_sc_dequeue_bulk_elem(r, obj_p, esize, 1, NULL) ?
+		0 : -ENOENT;
+}
+
+/**
+ * Dequeue one element from a ring.
+ *
+ * This function calls the multi-consumers or the single-consumer
+ * version depending on the default behavior that was specified at
+ * ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_p
+ *   A pointer to the element that will be filled.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4 and
+ *   match the value used when creating the ring.
+ * @return
+ *   - 0: Success, element dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue, no element is
+ *     dequeued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_dequeue_elem(struct rte_ring *r, void *obj_p,
+		unsigned int esize)
+{
+	return rte_ring_dequeue_bulk_elem(r, obj_p, esize, 1, NULL) ?
+		0 : -ENOENT;
+}
+
+/**
+ * Enqueue several elements on the ring (multi-producers safe).
+ *
+ * This function uses a "compare and set" instruction to move the
+ * producer index atomically.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4 and
+ *   match the value used when creating the ring.
+ * @param n
+ *   The number of elements to add in the ring from the obj_table.
+ * @param free_space
+ *   if non-NULL, returns the amount of space in the ring after the
+ *   enqueue operation has finished.
+ * @return
+ *   - n: Actual number of elements enqueued.
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_ring_mp_enqueue_burst_elem(struct rte_ring *r, const void *obj_table,
+		unsigned int esize, unsigned int n, unsigned int *free_space)
+{
+	return __rte_ring_do_enqueue_elem(r, obj_table, esize, n,
+			RTE_RING_QUEUE_VARIABLE, __IS_MP, free_space);
+}
+
+/**
+ * Enqueue several elements on a ring (NOT multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4 and
+ *   match the value used when creating the ring.
+ * @param n
+ *   The number of elements to add in the ring from the obj_table.
+ * @param free_space
+ *   if non-NULL, returns the amount of space in the ring after the
+ *   enqueue operation has finished.
+ * @return
+ *   - n: Actual number of elements enqueued.
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_ring_sp_enqueue_burst_elem(struct rte_ring *r, const void *obj_table,
+		unsigned int esize, unsigned int n, unsigned int *free_space)
+{
+	return __rte_ring_do_enqueue_elem(r, obj_table, esize, n,
+			RTE_RING_QUEUE_VARIABLE, __IS_SP, free_space);
+}
+
+/**
+ * Enqueue several elements on a ring.
+ *
+ * This function calls the multi-producer, single-producer, RTS or HTS
+ * version depending on the default behavior that was specified at
+ * ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4 and
+ *   match the value used when creating the ring.
+ * @param n
+ *   The number of elements to add in the ring from the obj_table.
+ * @param free_space
+ *   if non-NULL, returns the amount of space in the ring after the
+ *   enqueue operation has finished.
+ * @return
+ *   - n: Actual number of elements enqueued.
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_ring_enqueue_burst_elem(struct rte_ring *r, const void *obj_table,
+		unsigned int esize, unsigned int n, unsigned int *free_space)
+{
+	return __rte_ring_do_enqueue_elem_default(r, obj_table, esize, n,
+			RTE_RING_QUEUE_VARIABLE, free_space);
+}
+
+/**
+ * Dequeue several elements from a ring (multi-consumers safe). When the
+ * request objects are more than the available objects, only dequeue the
+ * actual number of elements.
+ *
+ * This function uses a "compare and set" instruction to move the
+ * consumer index atomically.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements that will be filled.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4 and
+ *   match the value used when creating the ring.
+ * @param n
+ *   The number of elements to dequeue from the ring to the obj_table.
+ * @param available
+ *   If non-NULL, returns the number of remaining ring entries after the
+ *   dequeue has finished.
+ * @return
+ *   - n: Actual number of elements dequeued, 0 if ring is empty
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_ring_mc_dequeue_burst_elem(struct rte_ring *r, void *obj_table,
+		unsigned int esize, unsigned int n, unsigned int *available)
+{
+	return __rte_ring_do_dequeue_elem(r, obj_table, esize, n,
+			RTE_RING_QUEUE_VARIABLE, __IS_MC, available);
+}
+
+/**
+ * Dequeue several elements from a ring (NOT multi-consumers safe). When
+ * the request objects are more than the available objects, only dequeue
+ * the actual number of elements.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements that will be filled.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4 and
+ *   match the value used when creating the ring.
+ * @param n
+ *   The number of elements to dequeue from the ring to the obj_table.
+ * @param available
+ *   If non-NULL, returns the number of remaining ring entries after the
+ *   dequeue has finished.
+ * @return
+ *   - n: Actual number of elements dequeued, 0 if ring is empty
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_ring_sc_dequeue_burst_elem(struct rte_ring *r, void *obj_table,
+		unsigned int esize, unsigned int n, unsigned int *available)
+{
+	return __rte_ring_do_dequeue_elem(r, obj_table, esize, n,
+			RTE_RING_QUEUE_VARIABLE, __IS_SC, available);
+}
+
+/**
+ * Dequeue multiple elements from a ring up to a maximum number.
+ *
+ * This function calls the multi-consumers, single-consumer, RTS or HTS
+ * version depending on the default behavior that was specified at
+ * ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements that will be filled.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4 and
+ *   match the value used when creating the ring.
+ * @param n
+ *   The number of elements to dequeue from the ring to the obj_table.
+ * @param available
+ *   If non-NULL, returns the number of remaining ring entries after the
+ *   dequeue has finished.
+ * @return
+ *   - n: Actual number of elements dequeued, 0 if ring is empty
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_ring_dequeue_burst_elem(struct rte_ring *r, void *obj_table,
+		unsigned int esize, unsigned int n, unsigned int *available)
+{
+	return __rte_ring_do_dequeue_elem_default(r, obj_table, esize, n,
+			RTE_RING_QUEUE_VARIABLE, available);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RING_ELEM_H_ */
@@ -0,0 +1,330 @@
+/*
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Semihalf. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Semihalf nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef _RTE_RING_HTS_H_
+#define _RTE_RING_HTS_H_
+
+/**
+ * @file
+ * RTE Ring head/tail sync (HTS) mode
+ *
+ * It is not recommended to include this file directly,
+ * include <rte_ring.h> instead.
+ *
+ * In the default MP/MC mode several threads move the head concurrently and
+ * then update the tail in the same order, each one spinning until the
+ * previous ones are done. A thread preempted between the two steps stalls
+ * all the threads which moved the head after it, even those which are
+ * only waiting for their turn.
+ *
+ * In HTS mode a producer (consumer) moves the head only when head and tail
+ * are equal, i.e. when no other enqueue (dequeue) is in progress, and
+ * head and tail are read and updated together with a 64-bit compare and
+ * set. At most one thread at a time is between head move and tail update:
+ * the waiting threads own no part of the ring, so preempting one of them
+ * delays nobody else. It also keeps head and tail in sync, which allows
+ * the zero-copy API of rte_ring_peek.h on multi-thread rings.
+ *
+ * Select it with the RING_F_MP_HTS_ENQ/RING_F_MC_HTS_DEQ creation flags,
+ * the rte_ring_enqueue*()/rte_ring_dequeue*() functions then use it.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @internal Wait until head and tail of *ht* are equal, i.e. until the
+ * operation in progress, if any, is done. *p* holds the last value read.
+ */
+static inline __attribute__((always_inline)) void
+__rte_ring_hts_head_wait(const struct rte_ring_hts_headtail *ht,
+		union __rte_ring_hts_pos *p)
+{
+	while (p->pos.head != p->pos.tail) {
+		rte_pause();
+		p->raw = ht->ht.raw;
+	}
+}
+
+/**
+ * @internal Publish the *num* objects enqueued/dequeued from *old_tail*:
+ * head and tail are in sync again and the next operation can start.
+ */
+static inline __attribute__((always_inline)) void
+__rte_ring_hts_update_tail(struct rte_ring_hts_headtail *ht,
+		uint32_t old_tail, uint32_t num)
+{
+	ht->ht.pos.tail = old_tail + num;
+}
+
+/**
+ * @internal This function updates the producer head for enqueue,
+ * see __rte_ring_move_prod_head().
+ */
+static inline __attribute__((always_inline)) unsigned int
+__rte_ring_hts_move_prod_head(struct rte_ring *r, unsigned int num,
+		enum rte_ring_queue_behavior behavior, uint32_t *old_head,
+		uint32_t *free_entries)
+{
+	const uint32_t mask = r->mask;
+	union __rte_ring_hts_pos np, op;
+	unsigned int n;
+
+	do {
+		/* Reset n to the initial burst count */
+		n = num;
+
+		/* wait for the enqueue in progress, if any */
+		op.raw = r->hts_prod.ht.raw;
+		__rte_ring_hts_head_wait(&r->hts_prod, &op);
+
+		/* read the consumer tail after our head */
+		rte_smp_rmb();
+
+		/* the subtraction is done modulo 32 bits, see
+		 * __rte_ring_move_prod_head() */
+		*free_entries = mask + r->cons.tail - op.pos.head;
+
+		/* check that we have enough room in ring */
+		if (unlikely(n > *free_entries))
+			n = (behavior == RTE_RING_QUEUE_FIXED) ?
+					0 : *free_entries;
+
+		if (n == 0)
+			break;
+
+		np.pos.tail = op.pos.tail;
+		np.pos.head = op.pos.head + n;
+	} while (unlikely(rte_atomic64_cmpset(&r->hts_prod.ht.raw,
+			op.raw, np.raw) == 0));
+
+	*old_head = op.pos.head;
+	return n;
+}
+
+/**
+ * @internal This function updates the consumer head for dequeue,
+ * see __rte_ring_move_cons_head().
+ */
+static inline __attribute__((always_inline)) unsigned int
+__rte_ring_hts_move_cons_head(struct rte_ring *r, unsigned int num,
+		enum rte_ring_queue_behavior behavior, uint32_t *old_head,
+		uint32_t *entries)
+{
+	union __rte_ring_hts_pos np, op;
+	unsigned int n;
+
+	do {
+		/* Restore n as it may change every loop */
+		n = num;
+
+		/* wait for the dequeue in progress, if any */
+		op.raw = r->hts_cons.ht.raw;
+		__rte_ring_hts_head_wait(&r->hts_cons, &op);
+
+		/* read the producer tail after our head */
+		rte_smp_rmb();
+
+		/* the subtraction is done modulo 32 bits, see
+		 * __rte_ring_move_cons_head() */
+		*entries = r->prod.tail - op.pos.head;
+
+		/* Set the actual entries for dequeue */
+		if (n > *entries)
+			n = (behavior == RTE_RING_QUEUE_FIXED) ? 0 : *entries;
+
+		if (unlikely(n == 0))
+			break;
+
+		np.pos.tail = op.pos.tail;
+		np.pos.head = op.pos.head + n;
+	} while (unlikely(rte_atomic64_cmpset(&r->hts_cons.ht.raw,
+			op.raw, np.raw) == 0));
+
+	*old_head = op.pos.head;
+	return n;
+}
+
+/**
+ * @internal Enqueue several objects on the HTS ring,
+ * see __rte_ring_do_enqueue().
+ */
+static inline __attribute__((always_inline)) unsigned int
+__rte_ring_do_hts_enqueue(struct rte_ring *r, void * const *obj_table,
+		unsigned int n, enum rte_ring_queue_behavior behavior,
+		unsigned int *free_space)
+{
+	uint32_t head;
+	uint32_t free_entries;
+
+	n = __rte_ring_hts_move_prod_head(r, n, behavior,
+			&head, &free_entries);
+	if (n == 0)
+		goto end;
+
+	ENQUEUE_PTRS(r, &r[1], head, obj_table, n, void *);
+	rte_smp_wmb();
+
+	__rte_ring_hts_update_tail(&r->hts_prod, head, n);
+end:
+	if (free_space != NULL)
+		*free_space = free_entries - n;
+	return n;
+}
+
+/**
+ * @internal Dequeue several objects from the HTS ring,
+ * see __rte_ring_do_dequeue().
+ */
+static inline __attribute__((always_inline)) unsigned int
+__rte_ring_do_hts_dequeue(struct rte_ring *r, void **obj_table,
+		unsigned int n, enum rte_ring_queue_behavior behavior,
+		unsigned int *available)
+{
+	uint32_t head;
+	uint32_t entries;
+
+	n = __rte_ring_hts_move_cons_head(r, n, behavior,
+			&head, &entries);
+	if (n == 0)
+		goto end;
+
+	DEQUEUE_PTRS(r, &r[1], head, obj_table, n, void *);
+	rte_smp_rmb();
+
+	__rte_ring_hts_update_tail(&r->hts_cons, head, n);
+end:
+	if (available != NULL)
+		*available = entries - n;
+	return n;
+}
+
+/**
+ * Enqueue several objects on the HTS ring (multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @param free_space
+ *   if non-NULL, returns the amount of space in the ring after the
+ *   enqueue operation has finished.
+ * @return
+ *   The number of objects enqueued, either 0 or n
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_ring_mp_hts_enqueue_bulk(struct rte_ring *r, void * const *obj_table,
+			 unsigned int n, unsigned int *free_space)
+{
+	return __rte_ring_do_hts_enqueue(r, obj_table, n,
+			RTE_RING_QUEUE_FIXED, free_space);
+}
+
+/**
+ * Dequeue several objects from the HTS ring (multi-consumers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @param available
+ *   If non-NULL, returns the number of remaining ring entries after the
+ *   dequeue has finished.
+ * @return
+ *   The number of objects dequeued, either 0 or n
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_ring_mc_hts_dequeue_bulk(struct rte_ring *r, void **obj_table,
+		unsigned int n, unsigned int *available)
+{
+	return __rte_ring_do_hts_dequeue(r, obj_table, n,
+			RTE_RING_QUEUE_FIXED, available);
+}
+
+/**
+ * Enqueue up to *n* objects on the HTS ring (multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @param free_space
+ *   if non-NULL, returns the amount of space in the ring after the
+ *   enqueue operation has finished.
+ * @return
+ *   - n: Actual number of objects enqueued.
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_ring_mp_hts_enqueue_burst(struct rte_ring *r, void * const *obj_table,
+			 unsigned int n, unsigned int *free_space)
+{
+	return __rte_ring_do_hts_enqueue(r, obj_table, n,
+			RTE_RING_QUEUE_VARIABLE, free_space);
+}
+
+/**
+ * Dequeue up to *n* objects from the HTS ring (multi-consumers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @param available
+ *   If non-NULL, returns the number of remaining ring entries after the
+ *   dequeue has finished.
+ * @return
+ *   - n: Actual number of objects dequeued, 0 if ring is empty
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_ring_mc_hts_dequeue_burst(struct rte_ring *r, void **obj_table,
+		unsigned int n, unsigned int *available)
+{
+	return __rte_ring_do_hts_dequeue(r, obj_table, n,
+			RTE_RING_QUEUE_VARIABLE, available);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RING_HTS_H_ */
@@ -0,0 +1,412 @@
+/*
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Semihalf. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Semihalf nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_RING_PEEK_H_
+#define _RTE_RING_PEEK_H_
+
+/**
+ * @file
+ * RTE Ring zero-copy API
+ *
+ * Split enqueue and dequeue in two phases, so that objects are written to
+ * or read from the ring slots in place instead of being copied through a
+ * caller array:
+ *
+ * - enqueue: rte_ring_enqueue_zc_bulk_start() reserves up to N slots and
+ *   returns their address, the caller fills them and publishes the first
+ *   M <= N of them with rte_ring_enqueue_zc_finish().
+ * - dequeue: rte_ring_dequeue_zc_bulk_start() returns the address of up to
+ *   N objects at the head of the ring, the caller inspects them and
+ *   removes the first M <= N of them with rte_ring_dequeue_zc_finish().
+ *   The other objects stay in the ring, so a consumer can peek at the head
+ *   and decide whether to take it.
+ *
+ * The reserved area may wrap around the end of the ring, in which case it
+ * is described by two pointers, see struct rte_ring_zc_data.
+ *
+ * Only rings whose producer (respectively consumer) side is single thread
+ * or in head/tail sync mode, i.e. created with RING_F_SP_ENQ or
+ * RING_F_MP_HTS_ENQ (respectively RING_F_SC_DEQ or RING_F_MC_HTS_DEQ),
+ * support the zero-copy API on that side: the start functions return 0 for
+ * the other rings. Between start and finish the ring is owned by the
+ * caller: on a single thread ring no other enqueue (respectively dequeue)
+ * must be issued, on a HTS ring the other threads wait for the finish.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <rte_debug.h>
+
+#include "rte_ring_elem.h"
+
+/**
+ * Ring slots reserved by a zero-copy start function.
+ */
+struct rte_ring_zc_data {
+	void *ptr1;      /**< Address of the first reserved slot. */
+	void *ptr2;      /**< Address of the ring start if the reserved area
+			  *   wraps around, NULL otherwise. */
+	unsigned int n1; /**< Number of elements at ptr1, the remaining
+			  *   ones are at ptr2. */
+};
+
+/**
+ * @internal Fill *zcd* with the location of *n* ring slots of *esize* bytes
+ * starting at index *head*.
+ */
+static inline __attribute__((always_inline)) void
+__rte_ring_get_zc_data(struct rte_ring *r, uint32_t head, unsigned int esize,
+		unsigned int n, struct rte_ring_zc_data *zcd)
+{
+	const uint32_t idx = head & r->mask;
+	uint8_t *ring = (uint8_t *)&r[1];
+
+	zcd->ptr1 = ring + (size_t)idx * esize;
+	if (likely(idx + n <= r->size)) {
+		zcd->n1 = n;
+		zcd->ptr2 = NULL;
+	} else {
+		zcd->n1 = r->size - idx;
+		zcd->ptr2 = ring;
+	}
+}
+
+/**
+ * @internal Reserve up to *n* slots for a zero-copy enqueue.
+ */
+static inline __attribute__((always_inline)) unsigned int
+__rte_ring_do_enqueue_zc_elem_start(struct rte_ring *r, unsigned int esize,
+		unsigned int n, enum rte_ring_queue_behavior behavior,
+		struct rte_ring_zc_data *zcd, unsigned int *free_space)
+{
+	uint32_t prod_head, prod_next;
+	uint32_t free_entries;
+
+	switch (r->prod.sync_type) {
+	case RTE_RING_SYNC_ST:
+		n = __rte_ring_move_prod_head(r, __IS_SP, n, behavior,
+				&prod_head, &prod_next, &free_entries);
+		break;
+	case RTE_RING_SYNC_MT_HTS:
+		n = __rte_ring_hts_move_prod_head(r, n, behavior,
+				&prod_head, &free_entries);
+		break;
+	default:
+		n = 0;
+		free_entries = 0;
+		goto end;
+	}
+
+	if (n != 0)
+		__rte_ring_get_zc_data(r, prod_head, esize, n, zcd);
+end:
+	if (free_space != NULL)
+		*free_space = free_entries - n;
+	return n;
+}
+
+/**
+ * @internal Reserve up to *n* objects for a zero-copy dequeue.
+ */
+static inline __attribute__((always_inline)) unsigned int
+__rte_ring_do_dequeue_zc_elem_start(struct rte_ring *r, unsigned int esize,
+		unsigned int n, enum rte_ring_queue_behavior behavior,
+		struct rte_ring_zc_data *zcd, unsigned int *available)
+{
+	uint32_t cons_head, cons_next;
+	uint32_t entries;
+
+	switch (r->cons.sync_type) {
+	case RTE_RING_SYNC_ST:
+		n = __rte_ring_move_cons_head(r, __IS_SC, n, behavior,
+				&cons_head, &cons_next, &entries);
+		break;
+	case RTE_RING_SYNC_MT_HTS:
+		n = __rte_ring_hts_move_cons_head(r, n, behavior,
+				&cons_head, &entries);
+		break;
+	default:
+		n = 0;
+		entries = 0;
+		goto end;
+	}
+
+	if (n != 0) {
+		__rte_ring_get_zc_data(r, cons_head, esize, n, zcd);
+		/* objects are read by the caller after the producer tail */
+		rte_smp_rmb();
+	}
+end:
+	if (available != NULL)
+		*available = entries - n;
+	return n;
+}
+
+/**
+ * Start a zero-copy enqueue of exactly *n* elements of *esize* bytes.
+ *
+ * @param r
+ *   A pointer to the ring structure, created with RING_F_SP_ENQ or
+ *   RING_F_MP_HTS_ENQ.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4 and
+ *   match the value used when creating the ring.
+ * @param n
+ *   The number of elements to reserve in the ring.
+ * @param zcd
+ *   Filled with the location of the reserved slots when the return value
+ *   is not 0.
+ * @param free_space
+ *   if non-NULL, returns the amount of space in the ring after the
+ *   reservation.
+ * @return
+ *   The number of reserved slots, either 0 or n
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_ring_enqueue_zc_bulk_elem_start(struct rte_ring *r, unsigned int esize,
+		unsigned int n, struct rte_ring_zc_data *zcd,
+		unsigned int *free_space)
+{
+	return __rte_ring_do_enqueue_zc_elem_start(r, esize, n,
+			RTE_RING_QUEUE_FIXED, zcd, free_space);
+}
+
+/**
+ * Start a zero-copy enqueue of up to *n* elements of *esize* bytes.
+ *
+ * @param r
+ *   A pointer to the ring structure, created with RING_F_SP_ENQ or
+ *   RING_F_MP_HTS_ENQ.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4 and
+ *   match the value used when creating the ring.
+ * @param n
+ *   The maximum number of elements to reserve in the ring.
+ * @param zcd
+ *   Filled with the location of the reserved slots when the return value
+ *   is not 0.
+ * @param free_space
+ *   if non-NULL, returns the amount of space in the ring after the
+ *   reservation.
+ * @return
+ *   - n: Actual number of reserved slots.
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_ring_enqueue_zc_burst_elem_start(struct rte_ring *r, unsigned int esize,
+		unsigned int n, struct rte_ring_zc_data *zcd,
+		unsigned int *free_space)
+{
+	return __rte_ring_do_enqueue_zc_elem_start(r, esize, n,
+			RTE_RING_QUEUE_VARIABLE, zcd, free_space);
+}
+
+/**
+ * Start a zero-copy enqueue of exactly *n* objects.
+ *
+ * @see rte_ring_enqueue_zc_bulk_elem_start()
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_ring_enqueue_zc_bulk_start(struct rte_ring *r, unsigned int n,
+		struct rte_ring_zc_data *zcd, unsigned int *free_space)
+{
+	return rte_ring_enqueue_zc_bulk_elem_start(r, sizeof(void *), n,
+			zcd, free_space);
+}
+
+/**
+ * Start a zero-copy enqueue of up to *n* objects.
+ *
+ * @see rte_ring_enqueue_zc_burst_elem_start()
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_ring_enqueue_zc_burst_start(struct rte_ring *r, unsigned int n,
+		struct rte_ring_zc_data *zcd, unsigned int *free_space)
+{
+	return rte_ring_enqueue_zc_burst_elem_start(r, sizeof(void *), n,
+			zcd, free_space);
+}
+
+/**
+ * Complete a zero-copy enqueue started with one of the
+ * rte_ring_enqueue_zc_*_start() functions.
+ *
+ * The first *n* reserved slots are made visible to the consumers, the
+ * remaining ones, if any, are released.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param n
+ *   The number of elements to enqueue, not more than the number of slots
+ *   reserved by the start function.
+ */
+static inline void __attribute__((always_inline))
+rte_ring_enqueue_zc_finish(struct rte_ring *r, unsigned int n)
+{
+	const uint32_t tail = r->prod.tail + n;
+
+	RTE_ASSERT(r->prod.head - r->prod.tail >= n);
+
+	/*
+	 * Head and tail are at the same place in the single thread and HTS
+	 * layouts. Rolling the head back is safe for both: a HTS producer
+	 * does not move the head until it is equal to the tail.
+	 */
+	r->prod.head = tail;
+	rte_smp_wmb();
+	r->prod.tail = tail;
+}
+
+/**
+ * Start a zero-copy dequeue of exactly *n* elements of *esize* bytes.
+ *
+ * The elements stay in the ring until rte_ring_dequeue_zc_finish() is
+ * called.
+ *
+ * @param r
+ *   A pointer to the ring structure, created with RING_F_SC_DEQ or
+ *   RING_F_MC_HTS_DEQ.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4 and
+ *   match the value used when creating the ring.
+ * @param n
+ *   The number of elements to peek at.
+ * @param zcd
+ *   Filled with the location of the elements when the return value is
+ *   not 0.
+ * @param available
+ *   If non-NULL, returns the number of remaining ring entries after the
+ *   reserved ones.
+ * @return
+ *   The number of reserved elements, either 0 or n
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_ring_dequeue_zc_bulk_elem_start(struct rte_ring *r, unsigned int esize,
+		unsigned int n, struct rte_ring_zc_data *zcd,
+		unsigned int *available)
+{
+	return __rte_ring_do_dequeue_zc_elem_start(r, esize, n,
+			RTE_RING_QUEUE_FIXED, zcd, available);
+}
+
+/**
+ * Start a zero-copy dequeue of up to *n* elements of *esize* bytes.
+ *
+ * The elements stay in the ring until rte_ring_dequeue_zc_finish() is
+ * called.
+ *
+ * @param r
+ *   A pointer to the ring structure, created with RING_F_SC_DEQ or
+ *   RING_F_MC_HTS_DEQ.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4 and
+ *   match the value used when creating the ring.
+ * @param n
+ *   The maximum number of elements to peek at.
+ * @param zcd
+ *   Filled with the location of the elements when the return value is
+ *   not 0.
+ * @param available
+ *   If non-NULL, returns the number of remaining ring entries after the
+ *   reserved ones.
+ * @return
+ *   - n: Actual number of reserved elements, 0 if ring is empty
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_ring_dequeue_zc_burst_elem_start(struct rte_ring *r, unsigned int esize,
+		unsigned int n, struct rte_ring_zc_data *zcd,
+		unsigned int *available)
+{
+	return __rte_ring_do_dequeue_zc_elem_start(r, esize, n,
+			RTE_RING_QUEUE_VARIABLE, zcd, available);
+}
+
+/**
+ * Start a zero-copy dequeue of exactly *n* objects.
+ *
+ * @see rte_ring_dequeue_zc_bulk_elem_start()
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_ring_dequeue_zc_bulk_start(struct rte_ring *r, unsigned int n,
+		struct rte_ring_zc_data *zcd, unsigned int *available)
+{
+	return rte_ring_dequeue_zc_bulk_elem_start(r, sizeof(void *), n,
+			zcd, available);
+}
+
+/**
+ * Start a zero-copy dequeue of up to *n* objects.
+ *
+ * @see rte_ring_dequeue_zc_burst_elem_start()
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_ring_dequeue_zc_burst_start(struct rte_ring *r, unsigned int n,
+		struct rte_ring_zc_data *zcd, unsigned int *available)
+{
+	return rte_ring_dequeue_zc_burst_elem_start(r, sizeof(void *), n,
+			zcd, available);
+}
+
+/**
+ * Complete a zero-copy dequeue started with one of the
+ * rte_ring_dequeue_zc_*_start() functions.
+ *
+ * The first *n* reserved elements are removed from the ring, the
+ * remaining ones, if any, stay at its head.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param n
+ *   The number of elements to dequeue, not more than the number of
+ *   elements reserved by the start function.
+ */
+static inline void __attribute__((always_inline))
+rte_ring_dequeue_zc_finish(struct rte_ring *r, unsigned int n)
+{
+	const uint32_t tail = r->cons.tail + n;
+
+	RTE_ASSERT(r->cons.head - r->cons.tail >= n);
+
+	/* same layout and rollback as rte_ring_enqueue_zc_finish() */
+	r->cons.head = tail;
+	/* elements must be read before the producer can overwrite them */
+	rte_smp_rmb();
+	r->cons.tail = tail;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RING_PEEK_H_ */
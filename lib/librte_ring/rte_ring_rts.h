@@ -0,0 +1,419 @@
+/*
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Semihalf. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Semihalf nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef _RTE_RING_RTS_H_
+#define _RTE_RING_RTS_H_
+
+/**
+ * @file
+ * RTE Ring relaxed tail sync (RTS) mode
+ *
+ * It is not recommended to include this file directly,
+ * include <rte_ring.h> instead.
+ *
+ * In the default MP/MC mode each producer (consumer) updates the tail in
+ * the order it moved the head, spinning until the previous ones are done,
+ * so a thread preempted in the middle of an enqueue (dequeue) stalls all
+ * the others.
+ *
+ * In RTS mode head and tail carry, next to their position, a counter of
+ * the operations started and finished. A thread done with its copy does
+ * not wait for the others: it increments the tail counter and only the
+ * last thread to finish, i.e. the one which makes both counters equal,
+ * moves the tail position up to the head. To bound the objects kept
+ * invisible by a preempted thread, a new operation is not started while
+ * the head is more than *htd_max* entries ahead of the tail. The default
+ * *htd_max* is an eighth of the ring size, it can be changed with
+ * rte_ring_set_prod_htd_max() and rte_ring_set_cons_htd_max().
+ *
+ * Select it with the RING_F_MP_RTS_ENQ/RING_F_MC_RTS_DEQ creation flags,
+ * the rte_ring_enqueue*()/rte_ring_dequeue*() functions then use it.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @internal Count one more finished operation in the tail of *ht*, and
+ * move the tail position to the head when no other one is in progress.
+ */
+static inline __attribute__((always_inline)) void
+__rte_ring_rts_update_tail(struct rte_ring_rts_headtail *ht)
+{
+	union __rte_ring_rts_poscnt h, ot, nt;
+
+	do {
+		ot.raw = ht->tail.raw;
+		/* the head must be read after the tail */
+		rte_smp_rmb();
+		h.raw = ht->head.raw;
+
+		nt.raw = ot.raw;
+		if (++nt.val.cnt == h.val.cnt)
+			nt.val.pos = h.val.pos;
+	} while (unlikely(rte_atomic64_cmpset(&ht->tail.raw,
+			ot.raw, nt.raw) == 0));
+}
+
+/**
+ * @internal Wait until the head of *ht* is at most htd_max entries ahead
+ * of its tail. *h* holds the last value of the head read.
+ */
+static inline __attribute__((always_inline)) void
+__rte_ring_rts_head_wait(const struct rte_ring_rts_headtail *ht,
+		union __rte_ring_rts_poscnt *h)
+{
+	const uint32_t max = ht->htd_max;
+
+	while (h->val.pos - ht->tail.val.pos > max) {
+		rte_pause();
+		h->raw = ht->head.raw;
+	}
+}
+
+/**
+ * @internal This function updates the producer head for enqueue,
+ * see __rte_ring_move_prod_head().
+ */
+static inline __attribute__((always_inline)) unsigned int
+__rte_ring_rts_move_prod_head(struct rte_ring *r, unsigned int num,
+		enum rte_ring_queue_behavior behavior, uint32_t *old_head,
+		uint32_t *free_entries)
+{
+	const uint32_t mask = r->mask;
+	union __rte_ring_rts_poscnt nh, oh;
+	unsigned int n;
+
+	do {
+		/* Reset n to the initial burst count */
+		n = num;
+
+		/* do not get too far ahead of the tail */
+		oh.raw = r->rts_prod.head.raw;
+		__rte_ring_rts_head_wait(&r->rts_prod, &oh);
+
+		/* read the consumer tail after our head */
+		rte_smp_rmb();
+
+		/* the subtraction is done modulo 32 bits, see
+		 * __rte_ring_move_prod_head() */
+		*free_entries = mask + r->cons.tail - oh.val.pos;
+
+		/* check that we have enough room in ring */
+		if (unlikely(n > *free_entries))
+			n = (behavior == RTE_RING_QUEUE_FIXED) ?
+					0 : *free_entries;
+
+		if (n == 0)
+			break;
+
+		nh.val.pos = oh.val.pos + n;
+		nh.val.cnt = oh.val.cnt + 1;
+	} while (unlikely(rte_atomic64_cmpset(&r->rts_prod.head.raw,
+			oh.raw, nh.raw) == 0));
+
+	*old_head = oh.val.pos;
+	return n;
+}
+
+/**
+ * @internal This function updates the consumer head for dequeue,
+ * see __rte_ring_move_cons_head().
+ */
+static inline __attribute__((always_inline)) unsigned int
+__rte_ring_rts_move_cons_head(struct rte_ring *r, unsigned int num,
+		enum rte_ring_queue_behavior behavior, uint32_t *old_head,
+		uint32_t *entries)
+{
+	union __rte_ring_rts_poscnt nh, oh;
+	unsigned int n;
+
+	do {
+		/* Restore n as it may change every loop */
+		n = num;
+
+		/* do not get too far ahead of the tail */
+		oh.raw = r->rts_cons.head.raw;
+		__rte_ring_rts_head_wait(&r->rts_cons, &oh);
+
+		/* read the producer tail after our head */
+		rte_smp_rmb();
+
+		/* the subtraction is done modulo 32 bits, see
+		 * __rte_ring_move_cons_head() */
+		*entries = r->prod.tail - oh.val.pos;
+
+		/* Set the actual entries for dequeue */
+		if (n > *entries)
+			n = (behavior == RTE_RING_QUEUE_FIXED) ? 0 : *entries;
+
+		if (unlikely(n == 0))
+			break;
+
+		nh.val.pos = oh.val.pos + n;
+		nh.val.cnt = oh.val.cnt + 1;
+	} while (unlikely(rte_atomic64_cmpset(&r->rts_cons.head.raw,
+			oh.raw, nh.raw) == 0));
+
+	*old_head = oh.val.pos;
+	return n;
+}
+
+/**
+ * @internal Enqueue several objects on the RTS ring,
+ * see __rte_ring_do_enqueue().
+ */
+static inline __attribute__((always_inline)) unsigned int
+__rte_ring_do_rts_enqueue(struct rte_ring *r, void * const *obj_table,
+		unsigned int n, enum rte_ring_queue_behavior behavior,
+		unsigned int *free_space)
+{
+	uint32_t head;
+	uint32_t free_entries;
+
+	n = __rte_ring_rts_move_prod_head(r, n, behavior,
+			&head, &free_entries);
+	if (n == 0)
+		goto end;
+
+	ENQUEUE_PTRS(r, &r[1], head, obj_table, n, void *);
+	rte_smp_wmb();
+
+	__rte_ring_rts_update_tail(&r->rts_prod);
+end:
+	if (free_space != NULL)
+		*free_space = free_entries - n;
+	return n;
+}
+
+/**
+ * @internal Dequeue several objects from the RTS ring,
+ * see __rte_ring_do_dequeue().
+ */
+static inline __attribute__((always_inline)) unsigned int
+__rte_ring_do_rts_dequeue(struct rte_ring *r, void **obj_table,
+		unsigned int n, enum rte_ring_queue_behavior behavior,
+		unsigned int *available)
+{
+	uint32_t head;
+	uint32_t entries;
+
+	n = __rte_ring_rts_move_cons_head(r, n, behavior,
+			&head, &entries);
+	if (n == 0)
+		goto end;
+
+	DEQUEUE_PTRS(r, &r[1], head, obj_table, n, void *);
+	rte_smp_rmb();
+
+	__rte_ring_rts_update_tail(&r->rts_cons);
+end:
+	if (available != NULL)
+		*available = entries - n;
+	return n;
+}
+
+/**
+ * Enqueue several objects on the RTS ring (multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @param free_space
+ *   if non-NULL, returns the amount of space in the ring after the
+ *   enqueue operation has finished.
+ * @return
+ *   The number of objects enqueued, either 0 or n
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_ring_mp_rts_enqueue_bulk(struct rte_ring *r, void * const *obj_table,
+			 unsigned int n, unsigned int *free_space)
+{
+	return __rte_ring_do_rts_enqueue(r, obj_table, n,
+			RTE_RING_QUEUE_FIXED, free_space);
+}
+
+/**
+ * Dequeue several objects from the RTS ring (multi-consumers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @param available
+ *   If non-NULL, returns the number of remaining ring entries after the
+ *   dequeue has finished.
+ * @return
+ *   The number of objects dequeued, either 0 or n
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_ring_mc_rts_dequeue_bulk(struct rte_ring *r, void **obj_table,
+		unsigned int n, unsigned int *available)
+{
+	return __rte_ring_do_rts_dequeue(r, obj_table, n,
+			RTE_RING_QUEUE_FIXED, available);
+}
+
+/**
+ * Enqueue up to *n* objects on the RTS ring (multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @param free_space
+ *   if non-NULL, returns the amount of space in the ring after the
+ *   enqueue operation has finished.
+ * @return
+ *   - n: Actual number of objects enqueued.
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_ring_mp_rts_enqueue_burst(struct rte_ring *r, void * const *obj_table,
+			 unsigned int n, unsigned int *free_space)
+{
+	return __rte_ring_do_rts_enqueue(r, obj_table, n,
+			RTE_RING_QUEUE_VARIABLE, free_space);
+}
+
+/**
+ * Dequeue up to *n* objects from the RTS ring (multi-consumers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @param available
+ *   If non-NULL, returns the number of remaining ring entries after the
+ *   dequeue has finished.
+ * @return
+ *   - n: Actual number of objects dequeued, 0 if ring is empty
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_ring_mc_rts_dequeue_burst(struct rte_ring *r, void **obj_table,
+		unsigned int n, unsigned int *available)
+{
+	return __rte_ring_do_rts_dequeue(r, obj_table, n,
+			RTE_RING_QUEUE_VARIABLE, available);
+}
+
+/**
+ * Return the producer max head/tail distance of the RTS ring.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @return
+ *   The max head/tail distance, UINT32_MAX if the producer is not RTS.
+ */
+static inline uint32_t
+rte_ring_get_prod_htd_max(const struct rte_ring *r)
+{
+	if (r->prod.sync_type == RTE_RING_SYNC_MT_RTS)
+		return r->rts_prod.htd_max;
+	return UINT32_MAX;
+}
+
+/**
+ * Set the producer max head/tail distance of the RTS ring.
+ *
+ * A small value keeps the producers close to each other, a large one lets
+ * them go on while a preempted producer holds its slots.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param v
+ *   The new max head/tail distance.
+ * @return
+ *   0 on success, -ENOTSUP if the producer is not RTS.
+ */
+static inline int
+rte_ring_set_prod_htd_max(struct rte_ring *r, uint32_t v)
+{
+	if (r->prod.sync_type != RTE_RING_SYNC_MT_RTS)
+		return -ENOTSUP;
+
+	r->rts_prod.htd_max = v;
+	return 0;
+}
+
+/**
+ * Return the consumer max head/tail distance of the RTS ring.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @return
+ *   The max head/tail distance, UINT32_MAX if the consumer is not RTS.
+ */
+static inline uint32_t
+rte_ring_get_cons_htd_max(const struct rte_ring *r)
+{
+	if (r->cons.sync_type == RTE_RING_SYNC_MT_RTS)
+		return r->rts_cons.htd_max;
+	return UINT32_MAX;
+}
+
+/**
+ * Set the consumer max head/tail distance of the RTS ring.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param v
+ *   The new max head/tail distance.
+ * @return
+ *   0 on success, -ENOTSUP if the consumer is not RTS.
+ */
+static inline int
+rte_ring_set_cons_htd_max(struct rte_ring *r, uint32_t v)
+{
+	if (r->cons.sync_type != RTE_RING_SYNC_MT_RTS)
+		return -ENOTSUP;
+
+	r->rts_cons.htd_max = v;
+	return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RING_RTS_H_ */
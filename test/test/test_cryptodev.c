@@ -40,6 +40,10 @@
 #include <rte_cryptodev.h>
 #include <rte_cryptodev_pmd.h>
 
+#ifdef RTE_LIBRTE_METRICS
+#include <rte_metrics.h>
+#endif
+
 #ifdef RTE_LIBRTE_PMD_CRYPTO_SCHEDULER
 #include <rte_cryptodev_scheduler.h>
 #include <rte_cryptodev_scheduler_operations.h>
@@ -1375,6 +1379,226 @@ test_AES_CBC_HMAC_SHA1_encrypt_digest(void)
 	return TEST_SUCCESS;
 }
 
+#ifdef RTE_LIBRTE_METRICS
+/* Sum the global metrics whose name starts with the given prefix */
+static int
+test_metrics_sum(const char *prefix, uint64_t *sum)
+{
+	struct rte_metric_name *names;
+	struct rte_metric_value *values;
+	int n, i, found = 0;
+
+	n = rte_metrics_get_names(NULL, 0);
+	if (n <= 0)
+		return -1;
+
+	names = rte_malloc(NULL, sizeof(*names) * n, 0);
+	values = rte_malloc(NULL, sizeof(*values) * n, 0);
+	if (names == NULL || values == NULL ||
+	    rte_metrics_get_names(names, n) != n ||
+	    rte_metrics_get_values(RTE_METRICS_GLOBAL, values, n) != n) {
+		rte_free(names);
+		rte_free(values);
+		return -1;
+	}
+
+	*sum = 0;
+	for (i = 0; i < n; i++) {
+		if (strncmp(names[values[i].key].name, prefix,
+				strlen(prefix)) == 0) {
+			*sum += values[i].value;
+			found++;
+		}
+	}
+
+	rte_free(names);
+	rte_free(values);
+	return found;
+}
+
+static int
+test_mrvl_metrics(void)
+{
+	struct crypto_testsuite_params *ts_params = &testsuite_params;
+	struct rte_cryptodev *dev;
+	struct rte_cryptodev_stats stats;
+	char prefix[RTE_METRICS_MAX_NAME_LEN];
+	uint64_t value;
+
+	rte_metrics_init(rte_socket_id());
+
+	TEST_ASSERT_SUCCESS(test_AES_CBC_HMAC_SHA1_encrypt_digest(),
+			"crypto op processing failed");
+
+	/* Metrics are updated when the device stops, not only on stats_get */
+	rte_cryptodev_stop(ts_params->valid_devs[0]);
+
+	dev = rte_cryptodev_pmd_get_dev(ts_params->valid_devs[0]);
+
+	snprintf(prefix, sizeof(prefix), "%s_qp0_inflight", dev->data->name);
+	TEST_ASSERT_EQUAL(test_metrics_sum(prefix, &value), 1,
+			"queue pair metric %s not registered", prefix);
+	TEST_ASSERT_EQUAL(value, 0, "ops left in flight");
+
+	snprintf(prefix, sizeof(prefix), "%s_sessions_started",
+			dev->data->name);
+	TEST_ASSERT_EQUAL(test_metrics_sum(prefix, &value), 1,
+			"device metric %s not registered", prefix);
+	TEST_ASSERT(value > 0, "no session started");
+
+	/* Each dequeued op is counted in one latency bucket */
+	snprintf(prefix, sizeof(prefix), "%s_qp0_lat_", dev->data->name);
+	TEST_ASSERT(test_metrics_sum(prefix, &value) > 0,
+			"latency metrics not registered");
+
+	TEST_ASSERT_SUCCESS(rte_cryptodev_stats_get(ts_params->valid_devs[0],
+			&stats), "rte_cryptodev_stats_get failed");
+	TEST_ASSERT_EQUAL(value, stats.dequeued_count,
+			"latency histogram does not match dequeued ops");
+
+	return TEST_SUCCESS;
+}
+#endif
+
+/* Digest placed past the end of auth data, overlapping the usual ICV place */
+#define DIGEST_OVERLAP_GAP 4
+#define DIGEST_OVERLAP_FILL 0xa5
+
+static int
+test_AES_CBC_HMAC_SHA1_digest_overlap(void)
+{
+	struct crypto_testsuite_params *ts_params = &testsuite_params;
+	struct crypto_unittest_params *ut_params = &unittest_params;
+	uint8_t *gap, *data;
+
+	/* Generate test mbuf data, a gap and space for digest */
+	ut_params->ibuf = setup_test_string(ts_params->mbuf_pool,
+			catch_22_quote,	QUOTE_512_BYTES, 0);
+
+	gap = (uint8_t *)rte_pktmbuf_append(ut_params->ibuf,
+			DIGEST_OVERLAP_GAP + DIGEST_BYTE_LENGTH_SHA1);
+	TEST_ASSERT_NOT_NULL(gap, "no room to append digest");
+	memset(gap, DIGEST_OVERLAP_FILL, DIGEST_OVERLAP_GAP);
+	ut_params->digest = gap + DIGEST_OVERLAP_GAP;
+
+	/* Setup Cipher Parameters */
+	ut_params->cipher_xform.type = RTE_CRYPTO_SYM_XFORM_CIPHER;
+	ut_params->cipher_xform.next = &ut_params->auth_xform;
+
+	ut_params->cipher_xform.cipher.algo = RTE_CRYPTO_CIPHER_AES_CBC;
+	ut_params->cipher_xform.cipher.op = RTE_CRYPTO_CIPHER_OP_ENCRYPT;
+	ut_params->cipher_xform.cipher.key.data = aes_cbc_key;
+	ut_params->cipher_xform.cipher.key.length = CIPHER_KEY_LENGTH_AES_CBC;
+
+	/* Setup HMAC Parameters */
+	ut_params->auth_xform.type = RTE_CRYPTO_SYM_XFORM_AUTH;
+	ut_params->auth_xform.next = NULL;
+
+	ut_params->auth_xform.auth.op = RTE_CRYPTO_AUTH_OP_GENERATE;
+	ut_params->auth_xform.auth.algo = RTE_CRYPTO_AUTH_SHA1_HMAC;
+	ut_params->auth_xform.auth.key.length = HMAC_KEY_LENGTH_SHA1;
+	ut_params->auth_xform.auth.key.data = hmac_sha1_key;
+	ut_params->auth_xform.auth.digest_length = DIGEST_BYTE_LENGTH_SHA1;
+
+	ut_params->sess = rte_cryptodev_sym_session_create(
+			ts_params->valid_devs[0],
+			&ut_params->cipher_xform);
+	TEST_ASSERT_NOT_NULL(ut_params->sess, "Session creation failed");
+
+	ut_params->op = rte_crypto_op_alloc(ts_params->op_mpool,
+			RTE_CRYPTO_OP_TYPE_SYMMETRIC);
+	TEST_ASSERT_NOT_NULL(ut_params->op,
+			"Failed to allocate symmetric crypto operation struct");
+
+	rte_crypto_op_attach_sym_session(ut_params->op, ut_params->sess);
+
+	struct rte_crypto_sym_op *sym_op = ut_params->op->sym;
+
+	sym_op->m_src = ut_params->ibuf;
+
+	sym_op->auth.digest.data = ut_params->digest;
+	sym_op->auth.digest.phys_addr = rte_pktmbuf_mtophys_offset(
+			ut_params->ibuf, QUOTE_512_BYTES + DIGEST_OVERLAP_GAP);
+	sym_op->auth.digest.length = DIGEST_BYTE_LENGTH_SHA1;
+
+	sym_op->auth.data.offset = CIPHER_IV_LENGTH_AES_CBC;
+	sym_op->auth.data.length = QUOTE_512_BYTES;
+
+	sym_op->cipher.iv.data = (uint8_t *)rte_pktmbuf_prepend(ut_params->ibuf,
+			CIPHER_IV_LENGTH_AES_CBC);
+	sym_op->cipher.iv.phys_addr = rte_pktmbuf_mtophys(ut_params->ibuf);
+	sym_op->cipher.iv.length = CIPHER_IV_LENGTH_AES_CBC;
+
+	rte_memcpy(sym_op->cipher.iv.data, aes_cbc_iv,
+			CIPHER_IV_LENGTH_AES_CBC);
+
+	sym_op->cipher.data.offset = CIPHER_IV_LENGTH_AES_CBC;
+	sym_op->cipher.data.length = QUOTE_512_BYTES;
+
+	/* Encrypt and generate digest */
+	TEST_ASSERT_NOT_NULL(process_crypto_request(ts_params->valid_devs[0],
+			ut_params->op), "failed to process sym crypto op");
+
+	TEST_ASSERT_EQUAL(ut_params->op->status, RTE_CRYPTO_OP_STATUS_SUCCESS,
+			"crypto op processing failed");
+
+	data = rte_pktmbuf_mtod_offset(ut_params->ibuf, uint8_t *,
+			CIPHER_IV_LENGTH_AES_CBC);
+
+	TEST_ASSERT_BUFFERS_ARE_EQUAL(data,
+			catch_22_quote_2_512_bytes_AES_CBC_ciphertext,
+			QUOTE_512_BYTES,
+			"ciphertext data not as expected");
+
+	TEST_ASSERT_EQUAL(gap[0], DIGEST_OVERLAP_FILL,
+			"data before digest overwritten");
+	TEST_ASSERT_EQUAL(gap[DIGEST_OVERLAP_GAP - 1], DIGEST_OVERLAP_FILL,
+			"data before digest overwritten");
+
+	TEST_ASSERT_BUFFERS_ARE_EQUAL(ut_params->digest,
+			catch_22_quote_2_512_bytes_AES_CBC_HMAC_SHA1_digest,
+			DIGEST_BYTE_LENGTH_SHA1,
+			"Generated digest data not as expected");
+
+	/* Verify digest and decrypt in place */
+	rte_cryptodev_sym_session_free(ts_params->valid_devs[0],
+			ut_params->sess);
+
+	ut_params->auth_xform.next = &ut_params->cipher_xform;
+	ut_params->auth_xform.auth.op = RTE_CRYPTO_AUTH_OP_VERIFY;
+	ut_params->cipher_xform.next = NULL;
+	ut_params->cipher_xform.cipher.op = RTE_CRYPTO_CIPHER_OP_DECRYPT;
+
+	ut_params->sess = rte_cryptodev_sym_session_create(
+			ts_params->valid_devs[0],
+			&ut_params->auth_xform);
+	TEST_ASSERT_NOT_NULL(ut_params->sess, "Session creation failed");
+
+	ut_params->op->status = RTE_CRYPTO_OP_STATUS_NOT_PROCESSED;
+	rte_crypto_op_attach_sym_session(ut_params->op, ut_params->sess);
+
+	TEST_ASSERT_NOT_NULL(process_crypto_request(ts_params->valid_devs[0],
+			ut_params->op), "failed to process sym crypto op");
+
+	TEST_ASSERT_EQUAL(ut_params->op->status, RTE_CRYPTO_OP_STATUS_SUCCESS,
+			"crypto op processing failed");
+
+	TEST_ASSERT_BUFFERS_ARE_EQUAL(data, catch_22_quote, QUOTE_512_BYTES,
+			"plaintext data not as expected");
+
+	TEST_ASSERT_EQUAL(gap[0], DIGEST_OVERLAP_FILL,
+			"data before digest overwritten");
+	TEST_ASSERT_EQUAL(gap[DIGEST_OVERLAP_GAP - 1], DIGEST_OVERLAP_FILL,
+			"data before digest overwritten");
+
+	TEST_ASSERT_BUFFERS_ARE_EQUAL(ut_params->digest,
+			catch_22_quote_2_512_bytes_AES_CBC_HMAC_SHA1_digest,
+			DIGEST_BYTE_LENGTH_SHA1,
+			"digest data modified");
+
+	return TEST_SUCCESS;
+}
+
 /* ***** AES-CBC / HMAC-SHA512 Hash Tests ***** */
 
 #define HMAC_KEY_LENGTH_SHA512  (DIGEST_BYTE_LENGTH_SHA512)
@@ -8728,6 +8952,11 @@ static struct unit_test_suite cryptodev_mrvl_testsuite  = {
 				test_3DES_chain_mrvl_all),
 		TEST_CASE_ST(ut_setup, ut_teardown,
 				test_3DES_cipheronly_mrvl_all),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+				test_AES_CBC_HMAC_SHA1_digest_overlap),
+#ifdef RTE_LIBRTE_METRICS
+		TEST_CASE_ST(ut_setup, ut_teardown, test_mrvl_metrics),
+#endif
 
 		/** Negative tests */
 		TEST_CASE_ST(ut_setup, ut_teardown,
@@ -460,6 +460,63 @@ static int test_hash_get_key_with_position(void)
 	return 0;
 }
 
+/*
+ * Sequence of operations for freeing key slots with lock-free lookups
+ *
+ *  - create table with lock-free lookups
+ *  - add keys until the key slots are exhausted
+ *  - delete a key
+ *  - add a new key: no slot available
+ *  - free the slot of the deleted key
+ *  - add the new key: the slot is reused
+ *
+ */
+static int test_hash_free_key_with_position(void)
+{
+	struct rte_hash *handle = NULL;
+	struct rte_hash_parameters params;
+	const uint32_t nb_entries = 8; /* smallest table */
+	uint32_t key, nb_keys;
+	int pos, ret;
+
+	memcpy(&params, &ut_params, sizeof(params));
+	params.name = "hash_free_key_w_pos";
+	params.entries = nb_entries;
+	params.key_len = sizeof(key);
+	params.extra_flag = RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF;
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+
+	for (key = 0; key < nb_entries; key++) {
+		if (rte_hash_add_key(handle, &key) < 0)
+			break;
+	}
+	nb_keys = key;
+	RETURN_IF_ERROR(nb_keys == 0, "failed to add any key");
+
+	key = 0;
+	pos = rte_hash_del_key(handle, &key);
+	RETURN_IF_ERROR(pos < 0, "failed to delete key (pos=%d)", pos);
+	ret = rte_hash_lookup(handle, &key);
+	RETURN_IF_ERROR(ret != -ENOENT, "found deleted key (ret=%d)", ret);
+
+	/* the slot of the deleted key is not freed yet */
+	key = nb_keys;
+	ret = rte_hash_add_key(handle, &key);
+	RETURN_IF_ERROR(ret != -ENOSPC, "key slot reused before free");
+
+	ret = rte_hash_free_key_with_position(handle, pos);
+	RETURN_IF_ERROR(ret != 0, "failed to free key slot (ret=%d)", ret);
+
+	ret = rte_hash_add_key(handle, &key);
+	RETURN_IF_ERROR(ret != pos, "failed to reuse freed slot (ret=%d)", ret);
+	ret = rte_hash_lookup(handle, &key);
+	RETURN_IF_ERROR(ret != pos, "failed to find new key (ret=%d)", ret);
+
+	rte_hash_free(handle);
+	return 0;
+}
+
 /*
  * Sequence of operations for find existing hash table
  *
@@ -1074,6 +1131,18 @@ static int test_hash_creation_with_bad_parameters(void)
 		return -1;
 	}
 
+	/* lock-free lookups only support a single writer */
+	memcpy(&params, &ut_params, sizeof(params));
+	params.name = "creation_with_bad_parameters_5";
+	params.extra_flag = RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF |
+		RTE_HASH_EXTRA_FLAGS_MULTI_WRITER_ADD;
+	handle = rte_hash_create(&params);
+	if (handle != NULL) {
+		rte_hash_free(handle);
+		printf("Impossible creating hash sucessfully with lock-free lookups and multi-writer\n");
+		return -1;
+	}
+
 	/* test with same name should fail */
 	memcpy(&params, &ut_params, sizeof(params));
 	params.name = "same_name";
@@ -1486,6 +1555,8 @@ test_hash(void)
 		return -1;
 	if (test_hash_find_existing() < 0)
 		return -1;
+	if (test_hash_free_key_with_position() < 0)
+		return -1;
 	if (test_add_update_delete() < 0)
 		return -1;
 	if (test_five_keys() < 0)
@@ -244,6 +244,198 @@ test_hash_multiwriter(void)
 	return -1;
 }
 
+/*
+ * Lock-free readers with a single writer: the readers look up keys which
+ * stay in the table while the writer adds and deletes other keys, filling
+ * the table enough to move keys along cuckoo paths. No lookup may miss.
+ */
+#define RW_LF_ENTRIES (256 * 1024)
+#define RW_LF_NB_STATIC (RW_LF_ENTRIES / 2)
+#define RW_LF_NB_DYNAMIC (RW_LF_ENTRIES * 2 / 5)
+#define RW_LF_ROUNDS 4
+#define RW_LF_BULK 8
+
+struct rw_lf_reader {
+	volatile uint64_t nb_passes; /* number of quiescent states */
+} __rte_cache_aligned;
+
+struct {
+	struct rte_hash *h;
+	uint32_t *keys;
+	volatile int done;
+	struct rw_lf_reader readers[RTE_MAX_LCORE];
+} tbl_rw_lf_test_params;
+
+static rte_atomic64_t glookups;
+static rte_atomic64_t gmisses;
+
+static int
+test_hash_rw_lf_reader(__attribute__((unused)) void *arg)
+{
+	struct rw_lf_reader *reader =
+		&tbl_rw_lf_test_params.readers[rte_lcore_id()];
+	const void *key_ptrs[RW_LF_BULK];
+	int32_t positions[RW_LF_BULK];
+	uint64_t begin, cycles, lookups = 0, misses = 0;
+	uint32_t i, j;
+
+	begin = rte_rdtsc_precise();
+
+	while (!tbl_rw_lf_test_params.done) {
+		for (i = 0; i < RW_LF_NB_STATIC; i += RW_LF_BULK) {
+			for (j = 0; j < RW_LF_BULK; j++)
+				key_ptrs[j] = &tbl_rw_lf_test_params.keys[i + j];
+			rte_hash_lookup_bulk(tbl_rw_lf_test_params.h,
+					key_ptrs, RW_LF_BULK, positions);
+			for (j = 0; j < RW_LF_BULK; j++)
+				misses += positions[j] < 0;
+			lookups += RW_LF_BULK;
+		}
+		/* no key nor data of the table is referenced here */
+		reader->nb_passes++;
+	}
+
+	cycles = rte_rdtsc_precise() - begin;
+	rte_atomic64_add(&gcycles, cycles);
+	rte_atomic64_add(&glookups, lookups);
+	rte_atomic64_add(&gmisses, misses);
+
+	return 0;
+}
+
+/* wait until every reader went through a quiescent state */
+static void
+test_hash_rw_lf_wait_readers(void)
+{
+	uint64_t nb_passes[RTE_MAX_LCORE];
+	unsigned int lcore_id;
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id)
+		nb_passes[lcore_id] =
+			tbl_rw_lf_test_params.readers[lcore_id].nb_passes;
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		while (tbl_rw_lf_test_params.readers[lcore_id].nb_passes ==
+				nb_passes[lcore_id])
+			rte_pause();
+	}
+}
+
+static int
+test_hash_rw_lf(void)
+{
+	struct rte_hash_parameters hash_params = {
+		.name = "test_rw_lf",
+		.entries = RW_LF_ENTRIES,
+		.key_len = sizeof(uint32_t),
+		.hash_func = rte_hash_crc,
+		.hash_func_init_val = 0,
+		.socket_id = rte_socket_id(),
+		.extra_flag = RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF,
+	};
+	struct rte_hash *handle;
+	uint32_t *keys = NULL;
+	int32_t *positions = NULL;
+	uint32_t i, round, nb_added;
+	uint64_t begin, writer_cycles = 0, writer_ops = 0;
+	uint64_t nb_failed_adds = 0, nb_failed_dels = 0;
+
+	handle = rte_hash_create(&hash_params);
+	RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+
+	keys = rte_malloc(NULL,
+		sizeof(uint32_t) * (RW_LF_NB_STATIC + RW_LF_NB_DYNAMIC), 0);
+	positions = rte_malloc(NULL, sizeof(int32_t) * RW_LF_NB_DYNAMIC, 0);
+	if (keys == NULL || positions == NULL) {
+		printf("RTE_MALLOC failed\n");
+		goto err;
+	}
+
+	for (i = 0; i < RW_LF_NB_STATIC + RW_LF_NB_DYNAMIC; i++)
+		keys[i] = i;
+
+	for (i = 0; i < RW_LF_NB_STATIC; i++) {
+		if (rte_hash_add_key(handle, &keys[i]) < 0) {
+			printf("failed to add key %u\n", i);
+			goto err;
+		}
+	}
+
+	tbl_rw_lf_test_params.h = handle;
+	tbl_rw_lf_test_params.keys = keys;
+	tbl_rw_lf_test_params.done = 0;
+
+	rte_atomic64_init(&gcycles);
+	rte_atomic64_clear(&gcycles);
+	rte_atomic64_init(&glookups);
+	rte_atomic64_clear(&glookups);
+	rte_atomic64_init(&gmisses);
+	rte_atomic64_clear(&gmisses);
+
+	/* Fire the readers, the master lcore is the writer */
+	rte_eal_mp_remote_launch(test_hash_rw_lf_reader, NULL, SKIP_MASTER);
+
+	for (round = 0; round < RW_LF_ROUNDS; round++) {
+		begin = rte_rdtsc_precise();
+		nb_added = 0;
+		for (i = 0; i < RW_LF_NB_DYNAMIC; i++) {
+			positions[i] = rte_hash_add_key(handle,
+					&keys[RW_LF_NB_STATIC + i]);
+			if (positions[i] >= 0)
+				nb_added++;
+		}
+		for (i = 0; i < RW_LF_NB_DYNAMIC; i++) {
+			if (positions[i] >= 0 && rte_hash_del_key(handle,
+					&keys[RW_LF_NB_STATIC + i]) !=
+					positions[i])
+				nb_failed_dels++;
+		}
+		writer_cycles += rte_rdtsc_precise() - begin;
+		writer_ops += RW_LF_NB_DYNAMIC + nb_added;
+		nb_failed_adds += RW_LF_NB_DYNAMIC - nb_added;
+
+		/* the deleted keys may still be read until readers quiesce */
+		test_hash_rw_lf_wait_readers();
+		for (i = 0; i < RW_LF_NB_DYNAMIC; i++) {
+			if (positions[i] >= 0)
+				rte_hash_free_key_with_position(handle,
+						positions[i]);
+		}
+	}
+
+	tbl_rw_lf_test_params.done = 1;
+	rte_eal_mp_wait_lcore();
+
+	if (rte_atomic64_read(&gmisses) != 0) {
+		printf("%"PRIu64" lookups of present keys missed\n",
+			rte_atomic64_read(&gmisses));
+		goto err;
+	}
+
+	if (nb_failed_dels != 0) {
+		printf("%"PRIu64" added keys not deleted\n", nb_failed_dels);
+		goto err;
+	}
+
+	printf("No lookup missed during single writer updates.\n");
+	printf(" %"PRIu64" adds failed for lack of space\n", nb_failed_adds);
+	printf(" writer cycles per add/delete: %"PRIu64"\n",
+		writer_cycles / writer_ops);
+	printf(" reader cycles per lookup: %"PRIu64"\n",
+		rte_atomic64_read(&gcycles) / rte_atomic64_read(&glookups));
+
+	rte_free(positions);
+	rte_free(keys);
+	rte_hash_free(handle);
+	return 0;
+
+err:
+	rte_free(positions);
+	rte_free(keys);
+	rte_hash_free(handle);
+	return -1;
+}
+
 static int
 test_hash_multiwriter_main(void)
 {
@@ -275,6 +467,10 @@ test_hash_multiwriter_main(void)
 	if (test_hash_multiwriter() < 0)
 		return -1;
 
+	printf("Test lock-free readers with a single writer\n");
+	if (test_hash_rw_lf() < 0)
+		return -1;
+
 	return 0;
 }
 
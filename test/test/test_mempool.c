@@ -39,6 +39,7 @@
 #include <stdarg.h>
 #include <errno.h>
 #include <sys/queue.h>
+#include <pthread.h>
 
 #include <rte_common.h>
 #include <rte_log.h>
@@ -145,7 +146,7 @@ test_mempool_basic(struct rte_mempool *mp, int use_external_cache)
 			MEMPOOL_HEADER_SIZE(mp, mp->cache_size))
 		GOTO_ERR(ret, out);
 
-#ifndef RTE_EXEC_ENV_BSDAPP /* rte_mem_virt2phy() not supported on bsd */
+#if 0
 	printf("get physical address of an object\n");
 	if (rte_mempool_virt2phy(mp, obj) != rte_mem_virt2phy(obj))
 		GOTO_ERR(ret, out);
@@ -443,6 +444,331 @@ test_mempool_basic_ex(struct rte_mempool *mp)
 	return ret;
 }
 
+/*
+ * get contiguous blocks of objects, check that the objects of a block are
+ * laid out one after the other, and put them back in the pool
+ */
+static int
+test_mempool_contig_blocks(struct rte_mempool *mp)
+{
+	struct rte_mempool_info info;
+	void **first_objs;
+	unsigned int avail, max_blocks, n_blocks, i, j;
+	size_t total_elt_sz;
+	char *obj;
+	int ret = 0;
+
+	if (rte_mempool_ops_get_info(mp, &info) < 0)
+		RET_ERR();
+	if (info.contig_block_size == 0 ||
+	    info.contig_block_size != mp->contig_block_size)
+		RET_ERR();
+
+	total_elt_sz = mp->header_size + mp->elt_size + mp->trailer_size;
+	avail = rte_mempool_avail_count(mp);
+	n_blocks = RTE_MIN((unsigned int)MAX_KEEP,
+			   avail / info.contig_block_size / 2);
+	if (n_blocks == 0)
+		RET_ERR();
+
+	/* a failed request may fill the table before it gives up */
+	max_blocks = avail / info.contig_block_size + 1;
+	first_objs = rte_calloc("test_mempool", max_blocks,
+				sizeof(first_objs[0]), 0);
+	if (first_objs == NULL)
+		RET_ERR();
+
+	if (rte_mempool_get_contig_blocks(mp, first_objs, n_blocks) < 0)
+		GOTO_ERR(ret, out);
+	if (rte_mempool_avail_count(mp) !=
+	    avail - n_blocks * info.contig_block_size)
+		ret = -1;
+
+	for (i = 0; i < n_blocks; i++) {
+		for (j = 0; j < info.contig_block_size; j++) {
+			obj = (char *)first_objs[i] + j * total_elt_sz;
+			if (rte_mempool_from_obj(obj) != mp)
+				ret = -1;
+#ifndef RTE_EXEC_ENV_BSDAPP /* rte_mem_virt2phy() not supported on bsd */
+			if (rte_mempool_virt2phy(mp, obj) !=
+			    rte_mempool_virt2phy(mp, first_objs[i]) +
+			    j * total_elt_sz)
+				ret = -1;
+#endif
+			rte_mempool_put(mp, obj);
+		}
+	}
+	if (ret < 0)
+		GOTO_ERR(ret, out);
+
+	if (rte_mempool_avail_count(mp) != avail)
+		GOTO_ERR(ret, out);
+
+	/* the pool does not hold that many blocks */
+	if (rte_mempool_get_contig_blocks(mp, first_objs, max_blocks) !=
+			-ENOBUFS)
+		GOTO_ERR(ret, out);
+	if (rte_mempool_avail_count(mp) != avail)
+		GOTO_ERR(ret, out);
+
+out:
+	rte_free(first_objs);
+	return ret;
+}
+
+/*
+ * check that an adaptive user-owned cache shrinks when all accesses hit
+ * and grows when they miss, and that its statistics count every access
+ */
+static int
+test_mempool_adaptive_cache(struct rte_mempool *mp)
+{
+	struct rte_mempool_cache *cache;
+	struct rte_mempool_cache_stats stats;
+	void *objs[MAX_KEEP];
+	unsigned int i, n_gets = 0, n_puts = 0;
+	int ret = -1;
+
+	cache = rte_mempool_cache_create(32, SOCKET_ID_ANY);
+	if (cache == NULL)
+		RET_ERR();
+
+	/* invalid bounds */
+	if (rte_mempool_cache_set_adaptive(cache, 0, 64) != -EINVAL ||
+	    rte_mempool_cache_set_adaptive(cache, 64, 8) != -EINVAL ||
+	    rte_mempool_cache_set_adaptive(cache, 8,
+			RTE_MEMPOOL_CACHE_MAX_SIZE + 1) != -EINVAL)
+		GOTO_ERR(ret, out);
+
+	if (rte_mempool_cache_set_adaptive(cache, 4, MAX_KEEP * 4) < 0)
+		GOTO_ERR(ret, out);
+
+	/* single objects are served by the cache: it shrinks to its minimum */
+	for (i = 0; i < RTE_MEMPOOL_CACHE_ADAPT_PERIOD * 4; i++) {
+		if (rte_mempool_generic_get(mp, objs, 1, cache, 0) < 0)
+			GOTO_ERR(ret, out);
+		rte_mempool_generic_put(mp, objs, 1, cache, 0);
+		n_gets++;
+		n_puts++;
+	}
+	if (cache->size != 4 || cache->flushthresh != 6)
+		GOTO_ERR(ret, out);
+
+	/* bulks larger than the cache miss: it grows to hold them */
+	for (i = 0; i < RTE_MEMPOOL_CACHE_ADAPT_PERIOD * 4; i++) {
+		if (rte_mempool_generic_get(mp, objs, MAX_KEEP, cache, 0) < 0)
+			GOTO_ERR(ret, out);
+		rte_mempool_generic_put(mp, objs, MAX_KEEP, cache, 0);
+		n_gets++;
+		n_puts++;
+	}
+	if (cache->size <= MAX_KEEP || cache->size > MAX_KEEP * 4)
+		GOTO_ERR(ret, out);
+
+	stats = cache->stats;
+	if (stats.get_misses == 0 || stats.refills > stats.get_misses ||
+	    stats.flushes > stats.put_misses)
+		GOTO_ERR(ret, out);
+#ifdef RTE_LIBRTE_MEMPOOL_CACHE_STATS
+	if (stats.get_hits + stats.get_misses != n_gets ||
+	    stats.put_hits + stats.put_misses != n_puts)
+		GOTO_ERR(ret, out);
+#else
+	/* hits are not counted */
+	RTE_SET_USED(n_gets);
+	RTE_SET_USED(n_puts);
+#endif
+
+	ret = 0;
+out:
+	rte_mempool_cache_flush(cache, mp);
+	rte_mempool_cache_free(cache);
+	return ret;
+}
+
+/*
+ * check the statistics and the adaptive bounds of the default caches of
+ * a mempool
+ */
+static int
+test_mempool_cache_stats(struct rte_mempool *mp_cache,
+	struct rte_mempool *mp_nocache)
+{
+	struct rte_mempool_cache_stats stats;
+
+	rte_mempool_cache_stats_get(mp_nocache, &stats);
+	if (stats.get_hits != 0 || stats.get_misses != 0 ||
+	    stats.put_hits != 0 || stats.put_misses != 0)
+		RET_ERR();
+
+	if (rte_mempool_set_adaptive_cache(mp_nocache, 1, 32) != -EINVAL)
+		RET_ERR();
+
+#ifdef RTE_LIBRTE_MEMPOOL_CACHE_STATS
+	/* test_mempool_basic() went through the cache of this lcore */
+	rte_mempool_cache_stats_get(mp_cache, &stats);
+	if (stats.get_hits + stats.get_misses == 0 ||
+	    stats.put_hits + stats.put_misses == 0)
+		RET_ERR();
+#endif
+
+	if (rte_mempool_set_adaptive_cache(mp_cache, 1,
+			RTE_MEMPOOL_CACHE_MAX_SIZE + 1) != -EINVAL)
+		RET_ERR();
+	if (rte_mempool_set_adaptive_cache(mp_cache, 1,
+			mp_cache->cache_size) < 0)
+		RET_ERR();
+
+	return 0;
+}
+
+/*
+ * from a non-EAL thread, register a per-thread cache, check that it is
+ * used by the default get/put functions, and unregister it
+ */
+static void *
+test_mempool_thread_cache_main(void *arg)
+{
+	struct rte_mempool *mp = arg;
+	struct rte_mempool_cache *cache;
+	void *objs[MAX_KEEP];
+	unsigned int avail;
+	intptr_t ret = -1;
+
+	/* not registered yet: no cache */
+	if (rte_mempool_default_cache(mp, rte_lcore_id()) != NULL)
+		GOTO_ERR(ret, out);
+
+	if (rte_mempool_thread_cache_register(mp, 0) < 0)
+		GOTO_ERR(ret, out);
+	if (rte_mempool_thread_cache_register(mp, 0) != -EEXIST)
+		GOTO_ERR(ret, out);
+
+	cache = rte_mempool_default_cache(mp, rte_lcore_id());
+	if (cache == NULL || cache->size != mp->cache_size)
+		GOTO_ERR(ret, out);
+
+	/* the objects held in the cache are still available */
+	avail = rte_mempool_avail_count(mp);
+	if (rte_mempool_get_bulk(mp, objs, MAX_KEEP) < 0)
+		GOTO_ERR(ret, out);
+	rte_mempool_put_bulk(mp, objs, MAX_KEEP);
+	if (cache->len == 0 || rte_mempool_avail_count(mp) != avail)
+		GOTO_ERR(ret, out);
+	rte_mempool_dump(stdout, mp);
+#ifdef RTE_LIBRTE_MEMPOOL_CACHE_STATS
+	if (cache->stats.get_hits + cache->stats.get_misses != 1 ||
+	    cache->stats.put_hits + cache->stats.put_misses != 1)
+		GOTO_ERR(ret, out);
+#endif
+
+	/* unregistering flushes the cache */
+	if (rte_mempool_thread_cache_unregister(mp) < 0)
+		GOTO_ERR(ret, out);
+	if (rte_mempool_thread_cache_unregister(mp) != -ENOENT)
+		GOTO_ERR(ret, out);
+	if (rte_mempool_default_cache(mp, rte_lcore_id()) != NULL ||
+	    rte_mempool_avail_count(mp) != avail)
+		GOTO_ERR(ret, out);
+
+	/* register a smaller cache, flushed and released at thread exit */
+	if (rte_mempool_thread_cache_register(mp, MAX_KEEP * 2) < 0)
+		GOTO_ERR(ret, out);
+	if (rte_mempool_get_bulk(mp, objs, MAX_KEEP) < 0)
+		GOTO_ERR(ret, out);
+	rte_mempool_put_bulk(mp, objs, MAX_KEEP);
+	cache = rte_mempool_default_cache(mp, rte_lcore_id());
+	if (cache == NULL || cache->len == 0)
+		GOTO_ERR(ret, out);
+
+	return NULL;
+out:
+	rte_mempool_thread_cache_unregister_all();
+	return (void *)ret;
+}
+
+/*
+ * from a non-EAL thread, register caches of mempools which are then freed,
+ * and check that their entries are reclaimed
+ */
+static void *
+test_mempool_thread_cache_reclaim_main(void *arg)
+{
+	struct rte_mempool *mp = arg;
+	struct rte_mempool *mp_tmp;
+	unsigned int i;
+	intptr_t ret = -1;
+
+	/* more registrations than the table has entries */
+	for (i = 0; i <= RTE_MEMPOOL_THREAD_CACHE_MAX; i++) {
+		mp_tmp = rte_mempool_create("test_thread_cache_tmp",
+			MAX_KEEP * 4, MEMPOOL_ELT_SIZE, 0, 0,
+			NULL, NULL, NULL, NULL, SOCKET_ID_ANY, 0);
+		if (mp_tmp == NULL)
+			GOTO_ERR(ret, out);
+		if (rte_mempool_thread_cache_register(mp_tmp, MAX_KEEP) < 0) {
+			rte_mempool_free(mp_tmp);
+			GOTO_ERR(ret, out);
+		}
+		rte_mempool_free(mp_tmp);
+	}
+
+	/* unregistering also reclaims the entries of freed mempools */
+	mp_tmp = rte_mempool_create("test_thread_cache_tmp",
+		MAX_KEEP * 4, MEMPOOL_ELT_SIZE, 0, 0,
+		NULL, NULL, NULL, NULL, SOCKET_ID_ANY, 0);
+	if (mp_tmp == NULL)
+		GOTO_ERR(ret, out);
+	if (rte_mempool_thread_cache_register(mp, 0) < 0 ||
+	    rte_mempool_thread_cache_register(mp_tmp, MAX_KEEP) < 0) {
+		rte_mempool_free(mp_tmp);
+		GOTO_ERR(ret, out);
+	}
+	rte_mempool_free(mp_tmp);
+	if (rte_mempool_thread_cache_unregister(mp) < 0 ||
+	    RTE_PER_LCORE(_mempool_thread_caches).count != 0)
+		GOTO_ERR(ret, out);
+
+	ret = 0;
+out:
+	rte_mempool_thread_cache_unregister_all();
+	return (void *)ret;
+}
+
+static int
+test_mempool_thread_cache(struct rte_mempool *mp)
+{
+	unsigned int avail = rte_mempool_avail_count(mp);
+	pthread_t thread;
+	void *ret;
+
+	/* EAL lcores use the per-lcore caches */
+	if (rte_mempool_thread_cache_register(mp, 0) != -EINVAL)
+		RET_ERR();
+
+	if (pthread_create(&thread, NULL, test_mempool_thread_cache_main,
+			mp) != 0)
+		RET_ERR();
+	if (pthread_join(thread, &ret) != 0 || ret != NULL)
+		RET_ERR();
+
+	/* the cache left registered was released when the thread exited */
+	if (!TAILQ_EMPTY(&mp->thread_caches) ||
+	    rte_mempool_avail_count(mp) != avail)
+		RET_ERR();
+
+	if (pthread_create(&thread, NULL,
+			test_mempool_thread_cache_reclaim_main, mp) != 0)
+		RET_ERR();
+	if (pthread_join(thread, &ret) != 0 || ret != NULL)
+		RET_ERR();
+	if (!TAILQ_EMPTY(&mp->thread_caches) ||
+	    rte_mempool_avail_count(mp) != avail)
+		RET_ERR();
+
+	return 0;
+}
+
 static int
 test_mempool_same_name_twice_creation(void)
 {
@@ -513,7 +839,10 @@ test_mempool(void)
 	struct rte_mempool *mp_cache = NULL;
 	struct rte_mempool *mp_nocache = NULL;
 	struct rte_mempool *mp_stack = NULL;
+	struct rte_mempool *mp_lf_stack = NULL;
+	struct rte_mempool *mp_bucket = NULL;
 	struct rte_mempool *default_pool = NULL;
+	void *obj;
 
 	rte_atomic32_init(&synchro);
 
@@ -563,6 +892,52 @@ test_mempool(void)
 	}
 	rte_mempool_obj_iter(mp_stack, my_obj_init, NULL);
 
+#if defined(RTE_ARCH_X86_64) || defined(RTE_ARCH_ARM64)
+	/* create a mempool with the lock-free stack handler */
+	mp_lf_stack = rte_mempool_create_empty("test_lf_stack",
+		MEMPOOL_SIZE,
+		MEMPOOL_ELT_SIZE,
+		RTE_MEMPOOL_CACHE_MAX_SIZE, 0,
+		SOCKET_ID_ANY, 0);
+
+	if (mp_lf_stack == NULL) {
+		printf("cannot allocate mp_lf_stack mempool\n");
+		goto err;
+	}
+	if (rte_mempool_set_ops_byname(mp_lf_stack, "lf_stack", NULL) < 0) {
+		printf("cannot set lf_stack handler\n");
+		goto err;
+	}
+	if (rte_mempool_populate_default(mp_lf_stack) < 0) {
+		printf("cannot populate mp_lf_stack mempool\n");
+		goto err;
+	}
+	rte_mempool_obj_iter(mp_lf_stack, my_obj_init, NULL);
+#endif
+
+#ifdef RTE_DRIVER_MEMPOOL_BUCKET
+	/* create a mempool with the bucket handler */
+	mp_bucket = rte_mempool_create_empty("test_bucket",
+		MEMPOOL_SIZE,
+		MEMPOOL_ELT_SIZE,
+		RTE_MEMPOOL_CACHE_MAX_SIZE, 0,
+		SOCKET_ID_ANY, 0);
+
+	if (mp_bucket == NULL) {
+		printf("cannot allocate mp_bucket mempool\n");
+		goto err;
+	}
+	if (rte_mempool_set_ops_byname(mp_bucket, "bucket", NULL) < 0) {
+		printf("cannot set bucket handler\n");
+		goto err;
+	}
+	if (rte_mempool_populate_default(mp_bucket) < 0) {
+		printf("cannot populate mp_bucket mempool\n");
+		goto err;
+	}
+	rte_mempool_obj_iter(mp_bucket, my_obj_init, NULL);
+#endif
+
 	/* Create a mempool based on Default handler */
 	printf("Testing %s mempool handler\n",
 	       RTE_MBUF_DEFAULT_MEMPOOL_OPS);
@@ -612,6 +987,17 @@ test_mempool(void)
 	if (test_mempool_basic(mp_nocache, 1) < 0)
 		goto err;
 
+	/* adaptive caches and their statistics */
+	if (test_mempool_adaptive_cache(mp_nocache) < 0)
+		goto err;
+
+	if (test_mempool_cache_stats(mp_cache, mp_nocache) < 0)
+		goto err;
+
+	/* per-thread caches of non-EAL threads */
+	if (test_mempool_thread_cache(mp_cache) < 0)
+		goto err;
+
 	/* more basic tests without cache */
 	if (test_mempool_basic_ex(mp_nocache) < 0)
 		goto err;
@@ -633,6 +1019,19 @@ test_mempool(void)
 	if (test_mempool_basic(mp_stack, 1) < 0)
 		goto err;
 
+	/* test the lock-free stack handler */
+	if (mp_lf_stack != NULL && test_mempool_basic(mp_lf_stack, 1) < 0)
+		goto err;
+
+	/* contiguous blocks are only supported by the bucket handler */
+	if (rte_mempool_get_contig_blocks(mp_stack, &obj, 1) != -ENOTSUP)
+		goto err;
+
+	/* test the bucket handler */
+	if (mp_bucket != NULL && (test_mempool_basic(mp_bucket, 1) < 0 ||
+			test_mempool_contig_blocks(mp_bucket) < 0))
+		goto err;
+
 	if (test_mempool_basic(default_pool, 1) < 0)
 		goto err;
 
@@ -641,10 +1040,19 @@ test_mempool(void)
 	ret = 0;
 
 err:
+	printf("free mp_nocache\n");
 	rte_mempool_free(mp_nocache);
+	printf("free mp_cache\n");
 	rte_mempool_free(mp_cache);
+	printf("free mp_stack\n");
 	rte_mempool_free(mp_stack);
+	printf("free mp_lf_stack\n");
+	rte_mempool_free(mp_lf_stack);
+	printf("free mp_bucket\n");
+	rte_mempool_free(mp_bucket);
+	printf("free default_pool\n");
 	rte_mempool_free(default_pool);
+	printf("freed all %d\n", ret);
 
 	return ret;
 }
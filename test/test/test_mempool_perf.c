@@ -80,6 +80,8 @@
  *      - One core with user-owned cache
  *      - Two cores with user-owned cache
  *      - Max. cores with user-owned cache
+ *      - 1, 2, 4, 8 and 16 cores without cache, for the ring_mp_mc,
+ *        stack and lf_stack handlers
  *
  *    - Bulk size (*n_get_bulk*, *n_put_bulk*)
  *
@@ -308,6 +310,48 @@ do_one_mempool_test(struct rte_mempool *mp, unsigned int cores)
 	return 0;
 }
 
+/*
+ * compare the handlers without cache, where all the gets and puts hit the
+ * common pool, with an increasing number of cores
+ */
+static int
+test_mempool_perf_ops(const char *ops_name)
+{
+	static const unsigned int cores_tab[] = { 1, 2, 4, 8, 16 };
+	struct rte_mempool *mp;
+	unsigned int i;
+	int ret = -1;
+
+	mp = rte_mempool_create_empty(ops_name, MEMPOOL_SIZE,
+			MEMPOOL_ELT_SIZE, 0, 0, SOCKET_ID_ANY, 0);
+	if (mp == NULL) {
+		printf("cannot allocate %s mempool\n", ops_name);
+		return -1;
+	}
+	if (rte_mempool_set_ops_byname(mp, ops_name, NULL) < 0) {
+		printf("cannot set %s handler\n", ops_name);
+		goto err;
+	}
+	if (rte_mempool_populate_default(mp) < 0) {
+		printf("cannot populate %s mempool\n", ops_name);
+		goto err;
+	}
+	rte_mempool_obj_iter(mp, my_obj_init, NULL);
+
+	printf("start performance test for %s (without cache)\n", ops_name);
+	for (i = 0; i < RTE_DIM(cores_tab); i++) {
+		if (cores_tab[i] > rte_lcore_count())
+			break;
+		if (do_one_mempool_test(mp, cores_tab[i]) < 0)
+			goto err;
+	}
+
+	ret = 0;
+err:
+	rte_mempool_free(mp);
+	return ret;
+}
+
 static int
 test_mempool_perf(void)
 {
@@ -415,6 +459,20 @@ test_mempool_perf(void)
 	if (do_one_mempool_test(mp_nocache, rte_lcore_count()) < 0)
 		goto err;
 
+	use_external_cache = 0;
+
+	/* handlers scalability, with 1 to 16 cores */
+	if (test_mempool_perf_ops("ring_mp_mc") < 0)
+		goto err;
+
+	if (test_mempool_perf_ops("stack") < 0)
+		goto err;
+
+#if defined(RTE_ARCH_X86_64) || defined(RTE_ARCH_ARM64)
+	if (test_mempool_perf_ops("lf_stack") < 0)
+		goto err;
+#endif
+
 	rte_mempool_list_dump(stdout);
 
 	ret = 0;
@@ -0,0 +1,275 @@
+/*
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Semihalf. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Semihalf nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_common.h>
+
+#include "mrvl_bpool.h"
+
+#include "test.h"
+
+/*
+ * Drive the per-lcore BPool refill logic of the mrvl PMD against a software
+ * emulated pp2 BPool. Simulated lcores run in turns on the calling lcore:
+ * each one receives a burst, hands the buffers over to another lcore which
+ * releases them back to the BPool and then refills or trims its own slice,
+ * the same way mrvl_rx_pkt_burst() and mrvl_free_sent_buffers() do.
+ */
+
+#define BPOOL_NB_LCORES 4
+#define BPOOL_BURST 64
+#define BPOOL_BUDGET (BPOOL_BURST * 4)
+#define BPOOL_REBALANCE_BURSTS 1024
+#define BPOOL_MIN_SIZE 512
+#define BPOOL_INIT_SIZE 1024
+#define BPOOL_MAX_SIZE 2048
+#define BPOOL_NB_MBUFS 8192
+#define BPOOL_ROUNDS (BPOOL_REBALANCE_BURSTS * BPOOL_NB_LCORES * 16)
+
+/* Emulated hardware BPool and the mempool which backs it. */
+struct emu_bpool {
+	int bufs;		/* buffers in the BPool */
+	int mbufs;		/* buffers left in the mempool */
+	unsigned int empty;	/* bursts which found the BPool empty */
+	struct mrvl_bpool_lcore lcs[BPOOL_NB_LCORES];
+};
+
+static struct emu_bpool emu;
+
+static void
+emu_bpool_init(void)
+{
+	memset(&emu, 0, sizeof(emu));
+	emu.mbufs = BPOOL_NB_MBUFS;
+}
+
+static void
+emu_bpool_rebalance(void *arg __rte_unused)
+{
+	mrvl_bpool_lcores_rebalance(emu.lcs, 0, BPOOL_NB_LCORES - 1,
+				    BPOOL_MIN_SIZE, BPOOL_INIT_SIZE,
+				    BPOOL_MAX_SIZE);
+}
+
+static int
+emu_bpool_check(void)
+{
+	int i, size = 0;
+
+	for (i = 0; i < BPOOL_NB_LCORES; i++)
+		size += emu.lcs[i].size;
+
+	if (size != emu.bufs) {
+		printf("lcores account for %d buffers, BPool has %d\n",
+		       size, emu.bufs);
+		return -1;
+	}
+
+	if (emu.bufs + emu.mbufs > BPOOL_NB_MBUFS) {
+		printf("%d buffers out of %d\n", emu.bufs + emu.mbufs,
+		       BPOOL_NB_MBUFS);
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Receive a burst on rx_lcore and release the buffers on tx_lcore. */
+static int
+emu_bpool_burst(unsigned int rx_lcore, unsigned int tx_lcore)
+{
+	struct mrvl_bpool_lcore *lc = &emu.lcs[rx_lcore];
+	int rx_done, num;
+
+	rx_done = RTE_MIN(BPOOL_BURST, emu.bufs);
+	if (!rx_done)
+		emu.empty++;
+	emu.bufs -= rx_done;
+	lc->size -= rx_done;
+
+	num = mrvl_bpool_lcore_burst(lc, rx_done, BPOOL_BURST, BPOOL_BUDGET,
+				     BPOOL_REBALANCE_BURSTS,
+				     emu_bpool_rebalance, NULL);
+	if (num > 0) {
+		num = RTE_MIN(num, emu.mbufs);
+		emu.mbufs -= num;
+		emu.bufs += num;
+		lc->size += num;
+		lc->refills++;
+	} else if (num < 0) {
+		num = RTE_MIN(-num, emu.bufs);
+		emu.mbufs += num;
+		emu.bufs -= num;
+		lc->size -= num;
+		lc->trims++;
+	}
+
+	emu.bufs += rx_done;
+	emu.lcs[tx_lcore].size += rx_done;
+
+	return emu_bpool_check();
+}
+
+static int
+test_mrvl_bpool_refill(unsigned int tx_shift, unsigned int nb_rx_lcores)
+{
+	unsigned int i, rx_lcore;
+	int max_bufs;
+
+	emu_bpool_init();
+
+	for (i = 0; i < BPOOL_ROUNDS; i++) {
+		rx_lcore = i % nb_rx_lcores;
+		if (emu_bpool_burst(rx_lcore,
+				    (rx_lcore + tx_shift) % BPOOL_NB_LCORES))
+			return -1;
+		/* Give every lcore a chance to get its slice first. */
+		if (i == BPOOL_REBALANCE_BURSTS * nb_rx_lcores)
+			emu.empty = 0;
+	}
+
+	if (emu.empty) {
+		printf("BPool found empty %u times\n", emu.empty);
+		return -1;
+	}
+
+	/*
+	 * Buffers released on lcores which do not receive are only handed
+	 * back on the next rebalancing, receiving lcores refill from the
+	 * mempool in the meantime.
+	 */
+	max_bufs = BPOOL_MAX_SIZE + BPOOL_BUDGET * BPOOL_NB_LCORES;
+	if (nb_rx_lcores < BPOOL_NB_LCORES)
+		max_bufs = BPOOL_NB_MBUFS;
+
+	if (emu.bufs < BPOOL_MIN_SIZE || emu.bufs > max_bufs) {
+		printf("BPool size %d out of bounds\n", emu.bufs);
+		return -1;
+	}
+
+	for (i = nb_rx_lcores; i < BPOOL_NB_LCORES; i++) {
+		if (emu.lcs[i].refills || emu.lcs[i].trims) {
+			printf("lcore %u does not receive but touched BPool\n",
+			       i);
+			return -1;
+		}
+		if (emu.lcs[i].size + emu.lcs[i].credit >
+		    BPOOL_BURST * BPOOL_REBALANCE_BURSTS) {
+			printf("lcore %u holds %d buffers\n", i,
+			       emu.lcs[i].size + emu.lcs[i].credit);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int
+test_mrvl_bpool_deactivate(void)
+{
+	struct mrvl_bpool_lcore *lc = &emu.lcs[0];
+	int i;
+
+	emu_bpool_init();
+
+	for (i = 0; i < BPOOL_NB_LCORES * 2; i++)
+		if (emu_bpool_burst(i % BPOOL_NB_LCORES, 0))
+			return -1;
+
+	if (lc->max_size != BPOOL_MAX_SIZE / BPOOL_NB_LCORES) {
+		printf("lcore 0 max size %d with all lcores active\n",
+		       lc->max_size);
+		return -1;
+	}
+
+	mrvl_bpool_lcores_deactivate(emu.lcs, 0, BPOOL_NB_LCORES - 1);
+	for (i = 0; i < BPOOL_NB_LCORES; i++) {
+		if (rte_atomic32_read(&emu.lcs[i].rx_active)) {
+			printf("lcore %d still active\n", i);
+			return -1;
+		}
+	}
+
+	/* Nobody receives, rebalancing must leave slices alone. */
+	emu_bpool_rebalance(NULL);
+	if (lc->max_size != BPOOL_MAX_SIZE / BPOOL_NB_LCORES)
+		return -1;
+
+	/* Only lcore 0 receives after restart, it gets the whole BPool. */
+	lc->bursts = 0;
+	if (emu_bpool_burst(0, 0))
+		return -1;
+
+	if (lc->min_size != BPOOL_MIN_SIZE ||
+	    lc->init_size != BPOOL_INIT_SIZE ||
+	    lc->max_size != BPOOL_MAX_SIZE) {
+		printf("lcore 0 slice %d/%d/%d after restart\n",
+		       lc->min_size, lc->init_size, lc->max_size);
+		return -1;
+	}
+
+	for (i = 1; i < BPOOL_NB_LCORES; i++) {
+		if (emu.lcs[i].size + emu.lcs[i].credit) {
+			printf("idle lcore %d keeps %d buffers\n", i,
+			       emu.lcs[i].size + emu.lcs[i].credit);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int
+test_mrvl_bpool(void)
+{
+	/* Buffers are released on the receiving lcore. */
+	if (test_mrvl_bpool_refill(0, BPOOL_NB_LCORES))
+		return -1;
+
+	/* Buffers are released on another receiving lcore. */
+	if (test_mrvl_bpool_refill(1, BPOOL_NB_LCORES))
+		return -1;
+
+	/* Buffers are released on lcores which do not receive. */
+	if (test_mrvl_bpool_refill(BPOOL_NB_LCORES / 2, BPOOL_NB_LCORES / 2))
+		return -1;
+
+	if (test_mrvl_bpool_deactivate())
+		return -1;
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(mrvl_bpool_autotest, test_mrvl_bpool);
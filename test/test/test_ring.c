@@ -53,6 +53,8 @@
 #include <rte_branch_prediction.h>
 #include <rte_malloc.h>
 #include <rte_ring.h>
+#include <rte_ring_elem.h>
+#include <rte_ring_peek.h>
 #include <rte_random.h>
 #include <rte_common.h>
 #include <rte_errno.h>
@@ -78,6 +80,19 @@
  *      - Dequeue one object, two objects, MAX_BULK objects
  *      - Check that dequeued pointers are correct
  *
+ * #. Element ring tests: done on one core, for several element sizes:
+ *
+ *    - Enqueue/dequeue elements by value across the ring wrap point
+ *    - Check that dequeued elements are correct
+ *    - Fill and drain the ring with burst functions
+ *
+ * #. Zero-copy tests: done on one core:
+ *
+ *    - Reserve slots across the ring wrap point, fill them in place and
+ *      publish part of them
+ *    - Peek at the ring head, dequeue part of it and check the content
+ *    - Check that rings with multi producers/consumers are refused
+ *
  * #. Performance tests.
  *
  * Tests done in test_ring_perf.c
@@ -683,6 +698,376 @@ test_create_count_odd(void)
 	return 0;
 }
 
+/*
+ * Enqueue and dequeue elements of esize bytes by value, across the ring
+ * wrap point, and check their content.
+ */
+static int
+test_ring_elem_esize(unsigned int esize)
+{
+	const unsigned int words = esize / sizeof(uint32_t);
+	uint32_t src[MAX_BULK * 8], dst[MAX_BULK * 8];
+	char name[RTE_RING_NAMESIZE];
+	struct rte_ring *re;
+	unsigned int i, n, ret;
+
+	snprintf(name, sizeof(name), "test_elem_%u", esize);
+	re = rte_ring_create_elem(name, esize, RING_SIZE, SOCKET_ID_ANY, 0);
+	if (re == NULL) {
+		printf("Cannot create ring with %u bytes elements\n", esize);
+		return -1;
+	}
+
+	for (i = 0; i < MAX_BULK * words; i++)
+		src[i] = (uint32_t)rte_rand();
+
+	/* move the ring indexes close to the wrap point */
+	for (n = 0; n < RING_SIZE - MAX_BULK / 2; n += MAX_BULK / 2) {
+		if (rte_ring_sp_enqueue_bulk_elem(re, src, esize,
+				MAX_BULK / 2, NULL) != MAX_BULK / 2)
+			goto fail;
+		if (rte_ring_sc_dequeue_bulk_elem(re, dst, esize,
+				MAX_BULK / 2, NULL) != MAX_BULK / 2)
+			goto fail;
+	}
+
+	/* bulk enqueue/dequeue crossing the wrap point */
+	memset(dst, 0, sizeof(dst));
+	if (rte_ring_mp_enqueue_bulk_elem(re, src, esize, MAX_BULK,
+			NULL) != MAX_BULK)
+		goto fail;
+	if (rte_ring_mc_dequeue_bulk_elem(re, dst, esize, MAX_BULK,
+			NULL) != MAX_BULK)
+		goto fail;
+	if (memcmp(src, dst, MAX_BULK * esize) != 0)
+		goto fail;
+
+	/* single element */
+	if (rte_ring_enqueue_elem(re, &src[words], esize) != 0)
+		goto fail;
+	if (rte_ring_dequeue_elem(re, dst, esize) != 0)
+		goto fail;
+	if (memcmp(&src[words], dst, esize) != 0)
+		goto fail;
+	if (rte_ring_dequeue_elem(re, dst, esize) != -ENOENT)
+		goto fail;
+
+	/* fill the ring with bursts, only what fits must be enqueued */
+	n = 0;
+	while ((ret = rte_ring_enqueue_burst_elem(re, src, esize, MAX_BULK,
+			NULL)) != 0)
+		n += ret;
+	if (n != RING_SIZE - 1 || !rte_ring_full(re))
+		goto fail;
+
+	/* and drain it */
+	n = 0;
+	while ((i = rte_ring_dequeue_burst_elem(re, dst, esize, MAX_BULK,
+			NULL)) != 0) {
+		n += i;
+		ret = i;
+	}
+	if (n != RING_SIZE - 1 || !rte_ring_empty(re))
+		goto fail;
+	if (ret != (RING_SIZE - 1) % MAX_BULK ||
+			memcmp(src, dst, ret * esize) != 0)
+		goto fail;
+
+	rte_ring_free(re);
+	return 0;
+
+fail:
+	printf("Element ring test failed for %u bytes elements\n", esize);
+	rte_ring_dump(stdout, re);
+	rte_ring_free(re);
+	return -1;
+}
+
+static int
+test_ring_elem(void)
+{
+	static const unsigned int esizes[] = { 4, 8, 12, 16, 32 };
+	unsigned int i;
+
+	/* element size must be a multiple of 4 */
+	if (rte_ring_create_elem("test_elem_bad", 6, RING_SIZE,
+			SOCKET_ID_ANY, 0) != NULL) {
+		printf("Created ring with invalid element size\n");
+		return -1;
+	}
+
+	for (i = 0; i < RTE_DIM(esizes); i++)
+		if (test_ring_elem_esize(esizes[i]) < 0)
+			return -1;
+
+	return 0;
+}
+
+/* Copy n objects from/to the ring slots described by zcd */
+static void
+test_ring_zc_copy(const struct rte_ring_zc_data *zcd, void **objs,
+		unsigned int n, int to_ring)
+{
+	void **ring1 = zcd->ptr1, **ring2 = zcd->ptr2;
+	unsigned int i;
+
+	for (i = 0; i < n; i++) {
+		void **slot = i < zcd->n1 ? &ring1[i] : &ring2[i - zcd->n1];
+
+		if (to_ring)
+			*slot = objs[i];
+		else
+			objs[i] = *slot;
+	}
+}
+
+/*
+ * zero-copy enqueue and dequeue on a ring supporting them, i.e. a single
+ * thread or HTS ring, across the wrap point and with partial commits
+ */
+static int
+test_ring_zc_ring(struct rte_ring *rz)
+{
+	struct rte_ring_zc_data zcd;
+	void *src[MAX_BULK], *dst[MAX_BULK];
+	unsigned int i, n, avail;
+
+	for (i = 0; i < MAX_BULK; i++)
+		src[i] = (void *)(uintptr_t)(i + 1);
+
+	/* move the ring indexes close to the wrap point */
+	for (n = 0; n < RING_SIZE - MAX_BULK / 2; n += MAX_BULK / 2) {
+		if (rte_ring_enqueue_bulk(rz, src, MAX_BULK / 2, NULL) == 0 ||
+				rte_ring_dequeue_bulk(rz, dst, MAX_BULK / 2,
+					NULL) == 0)
+			return -1;
+	}
+
+	/* reserve across the wrap point, publish only half of the slots */
+	if (rte_ring_enqueue_zc_bulk_start(rz, MAX_BULK, &zcd, NULL) !=
+			MAX_BULK || zcd.ptr2 == NULL ||
+			zcd.n1 != MAX_BULK / 2) {
+		printf("Zero-copy enqueue start failed\n");
+		return -1;
+	}
+	test_ring_zc_copy(&zcd, src, MAX_BULK, 1);
+	rte_ring_enqueue_zc_finish(rz, MAX_BULK / 2);
+	if (rte_ring_count(rz) != MAX_BULK / 2)
+		return -1;
+
+	/* enqueue the rest through a second reservation */
+	if (rte_ring_enqueue_zc_burst_start(rz, MAX_BULK / 2, &zcd,
+			NULL) != MAX_BULK / 2 || zcd.ptr2 != NULL)
+		return -1;
+	test_ring_zc_copy(&zcd, &src[MAX_BULK / 2], MAX_BULK / 2, 1);
+	rte_ring_enqueue_zc_finish(rz, MAX_BULK / 2);
+
+	/* peek at the whole ring content, but dequeue only one object */
+	if (rte_ring_dequeue_zc_burst_start(rz, RING_SIZE, &zcd,
+			&avail) != MAX_BULK || avail != 0)
+		return -1;
+	test_ring_zc_copy(&zcd, dst, MAX_BULK, 0);
+	if (memcmp(src, dst, sizeof(src)) != 0) {
+		printf("Zero-copy peek returned wrong objects\n");
+		return -1;
+	}
+	rte_ring_dequeue_zc_finish(rz, 1);
+	if (rte_ring_count(rz) != MAX_BULK - 1)
+		return -1;
+
+	/* the other objects are still at the head of the ring */
+	memset(dst, 0, sizeof(dst));
+	if (rte_ring_dequeue_bulk(rz, dst, MAX_BULK - 1, NULL) !=
+			MAX_BULK - 1 ||
+			memcmp(&src[1], dst, (MAX_BULK - 1) * sizeof(void *))) {
+		printf("Zero-copy partial dequeue lost objects\n");
+		return -1;
+	}
+	if (rte_ring_dequeue_zc_bulk_start(rz, 1, &zcd, NULL) != 0)
+		return -1;
+
+	return 0;
+}
+
+static int
+test_ring_zc(void)
+{
+	struct rte_ring_zc_data zcd;
+	struct rte_ring *rz, *rh, *rm, *rr;
+
+	rz = rte_ring_create("test_zc", RING_SIZE, SOCKET_ID_ANY,
+			RING_F_SP_ENQ | RING_F_SC_DEQ);
+	rh = rte_ring_create("test_zc_hts", RING_SIZE, SOCKET_ID_ANY,
+			RING_F_MP_HTS_ENQ | RING_F_MC_HTS_DEQ);
+	rm = rte_ring_create("test_zc_mpmc", RING_SIZE, SOCKET_ID_ANY, 0);
+	rr = rte_ring_create("test_zc_rts", RING_SIZE, SOCKET_ID_ANY,
+			RING_F_MP_RTS_ENQ | RING_F_MC_RTS_DEQ);
+	if (rz == NULL || rh == NULL || rm == NULL || rr == NULL) {
+		printf("Cannot create zero-copy test rings\n");
+		goto fail;
+	}
+
+	/* multi producers/consumers and RTS rings are not supported */
+	if (rte_ring_enqueue_zc_burst_start(rm, MAX_BULK, &zcd, NULL) != 0 ||
+			rte_ring_dequeue_zc_burst_start(rm, MAX_BULK, &zcd,
+					NULL) != 0 ||
+			rte_ring_enqueue_zc_burst_start(rr, MAX_BULK, &zcd,
+					NULL) != 0 ||
+			rte_ring_dequeue_zc_burst_start(rr, MAX_BULK, &zcd,
+					NULL) != 0) {
+		printf("Zero-copy start accepted a MP/MC or RTS ring\n");
+		goto fail;
+	}
+
+	if (test_ring_zc_ring(rz) < 0 || test_ring_zc_ring(rh) < 0)
+		goto fail;
+
+	rte_ring_free(rz);
+	rte_ring_free(rh);
+	rte_ring_free(rm);
+	rte_ring_free(rr);
+	return 0;
+
+fail:
+	printf("Zero-copy test failed\n");
+	if (rz != NULL)
+		rte_ring_dump(stdout, rz);
+	if (rh != NULL)
+		rte_ring_dump(stdout, rh);
+	rte_ring_free(rz);
+	rte_ring_free(rh);
+	rte_ring_free(rm);
+	rte_ring_free(rr);
+	return -1;
+}
+
+/*
+ * fill and drain a ring through the default enqueue/dequeue functions,
+ * checking the order of the objects
+ */
+static int
+test_ring_sync_fill_drain(struct rte_ring *rs)
+{
+	void *src[MAX_BULK], *dst[MAX_BULK];
+	unsigned int i, k, n, free_space, avail;
+
+	for (n = 0; n < RING_SIZE - 1; n += i) {
+		for (i = 0; i < MAX_BULK; i++)
+			src[i] = (void *)(uintptr_t)(n + i + 1);
+		i = rte_ring_enqueue_burst(rs, src, MAX_BULK, &free_space);
+		if (i == 0 || free_space != RING_SIZE - 1 - n - i)
+			return -1;
+	}
+	if (!rte_ring_full(rs) || rte_ring_enqueue(rs, src[0]) != -ENOBUFS ||
+			rte_ring_enqueue_bulk(rs, src, 1, NULL) != 0)
+		return -1;
+
+	for (n = 0; n < RING_SIZE - 1; n += i) {
+		i = rte_ring_dequeue_burst(rs, dst, MAX_BULK, &avail);
+		if (i == 0 || avail != RING_SIZE - 1 - n - i)
+			return -1;
+		for (k = 0; k < i; k++)
+			if (dst[k] != (void *)(uintptr_t)(n + k + 1))
+				return -1;
+	}
+	if (!rte_ring_empty(rs) || rte_ring_dequeue(rs, &dst[0]) != -ENOENT ||
+			rte_ring_dequeue_bulk(rs, dst, 1, NULL) != 0)
+		return -1;
+
+	return 0;
+}
+
+/*
+ * rings created with the RTS and HTS sync modes, alone or mixed with the
+ * other modes, behave as the default ones
+ */
+static int
+test_ring_sync_modes(void)
+{
+	static const unsigned int flags[] = {
+		RING_F_MP_RTS_ENQ | RING_F_MC_RTS_DEQ,
+		RING_F_MP_HTS_ENQ | RING_F_MC_HTS_DEQ,
+		RING_F_MP_RTS_ENQ | RING_F_MC_HTS_DEQ,
+		RING_F_SP_ENQ | RING_F_MC_RTS_DEQ,
+		RING_F_MP_HTS_ENQ | RING_F_SC_DEQ,
+	};
+	uint64_t esrc[MAX_BULK][2], edst[MAX_BULK][2];
+	struct rte_ring *rs, *re;
+	unsigned int i, j;
+
+	/* at most one sync mode per side */
+	if (rte_ring_create("test_sync_inval", RING_SIZE, SOCKET_ID_ANY,
+			RING_F_SP_ENQ | RING_F_MP_RTS_ENQ) != NULL ||
+			rte_errno != EINVAL ||
+			rte_ring_create("test_sync_inval", RING_SIZE,
+				SOCKET_ID_ANY,
+				RING_F_MC_RTS_DEQ | RING_F_MC_HTS_DEQ) != NULL ||
+			rte_errno != EINVAL) {
+		printf("Ring created with conflicting sync flags\n");
+		return -1;
+	}
+
+	for (i = 0; i < RTE_DIM(esrc); i++) {
+		esrc[i][0] = i;
+		esrc[i][1] = ~(uint64_t)i;
+	}
+
+	for (i = 0; i < RTE_DIM(flags); i++) {
+		rs = rte_ring_create("test_sync", RING_SIZE, SOCKET_ID_ANY,
+				flags[i]);
+		re = rte_ring_create_elem("test_sync_elem", sizeof(esrc[0]),
+				RING_SIZE, SOCKET_ID_ANY, flags[i]);
+		if (rs == NULL || re == NULL) {
+			printf("Cannot create ring with flags 0x%x\n",
+					flags[i]);
+			goto fail;
+		}
+
+		/* htd_max is only defined for RTS */
+		if ((flags[i] & RING_F_MP_RTS_ENQ) != 0) {
+			if (rte_ring_get_prod_htd_max(rs) != RING_SIZE / 8 ||
+					rte_ring_set_prod_htd_max(rs, 1) != 0 ||
+					rte_ring_get_prod_htd_max(rs) != 1)
+				goto fail;
+		} else if (rte_ring_get_prod_htd_max(rs) != UINT32_MAX ||
+				rte_ring_set_prod_htd_max(rs, 1) != -ENOTSUP)
+			goto fail;
+
+		if (test_ring_sync_fill_drain(rs) < 0) {
+			printf("Fill/drain failed with flags 0x%x\n",
+					flags[i]);
+			goto fail;
+		}
+
+		for (j = 0; j < RING_SIZE; j += MAX_BULK) {
+			memset(edst, 0, sizeof(edst));
+			if (rte_ring_enqueue_bulk_elem(re, esrc,
+					sizeof(esrc[0]), MAX_BULK, NULL) !=
+					MAX_BULK ||
+					rte_ring_dequeue_burst_elem(re, edst,
+					sizeof(edst[0]), MAX_BULK, NULL) !=
+					MAX_BULK ||
+					memcmp(esrc, edst, sizeof(esrc)) != 0) {
+				printf("Element ring failed with flags 0x%x\n",
+						flags[i]);
+				goto fail;
+			}
+		}
+
+		rte_ring_free(rs);
+		rte_ring_free(re);
+	}
+
+	return 0;
+
+fail:
+	if (rs != NULL)
+		rte_ring_dump(stdout, rs);
+	rte_ring_free(rs);
+	rte_ring_free(re);
+	return -1;
+}
+
 static int
 test_lookup_null(void)
 {
@@ -812,6 +1197,18 @@ test_ring(void)
 			else
 				printf ( "Test detected NULL ring lookup \n");
 
+	/* element rings */
+	if (test_ring_elem() < 0)
+		return -1;
+
+	/* zero-copy operations */
+	if (test_ring_zc() < 0)
+		return -1;
+
+	/* RTS and HTS sync modes */
+	if (test_ring_sync_modes() < 0)
+		return -1;
+
 	/* test of creating ring with wrong size */
 	if (test_ring_creation_with_wrong_size() < 0)
 		return -1;
@@ -33,8 +33,10 @@
 
 
 #include <stdio.h>
+#include <string.h>
 #include <inttypes.h>
 #include <rte_ring.h>
+#include <rte_ring_elem.h>
 #include <rte_cycles.h>
 #include <rte_launch.h>
 
@@ -48,11 +50,25 @@
  *  * Empty ring dequeue
  *  * Enqueue/dequeue of bursts in 1 threads
  *  * Enqueue/dequeue of bursts in 2 threads
+ *  * The same for rings of 8, 16 and 32 bytes elements, for comparison
+ *    with the pointer ring
+ *  * Dequeue/enqueue of bursts by all the lcores on one ring, for the
+ *    MP/MC, RTS and HTS sync modes. Run with more lcores than cores, e.g.
+ *    --lcores='(0-7)@0,(8-15)@1', to measure the modes when the ring
+ *    users are preempted.
  */
 
 #define RING_NAME "RING_PERF"
+#define RING_ELEM_NAME "RING_PERF_ELEM"
 #define RING_SIZE 4096
 #define MAX_BURST 32
+#define MAX_ESIZE 32
+
+/* Element size used by the two lcores element ring tests */
+#define PAIR_ESIZE 16
+
+/* Duration of each all lcores stress test */
+#define STRESS_DURATION_MS 1000
 
 /*
  * the sizes to enqueue and dequeue in testing
@@ -63,6 +79,9 @@ static const volatile unsigned bulk_sizes[] = { 8, 32 };
 /* The ring structure used for tests */
 static struct rte_ring *r;
 
+/* The element rings used for tests, indexed by element size / 8 */
+static struct rte_ring *r_elem[MAX_ESIZE / 8 + 1];
+
 struct lcore_pair {
 	unsigned c1, c2;
 };
@@ -245,6 +264,78 @@ dequeue_bulk(void *p)
 	return 0;
 }
 
+/*
+ * Element ring counterparts of enqueue_bulk() and dequeue_bulk(), moving
+ * PAIR_ESIZE bytes elements by value.
+ */
+static int
+enqueue_bulk_elem(void *p)
+{
+	const unsigned iter_shift = 23;
+	const unsigned iterations = 1<<iter_shift;
+	struct thread_params *params = p;
+	const unsigned size = params->size;
+	struct rte_ring *re = r_elem[PAIR_ESIZE / 8];
+	unsigned i;
+	uint64_t burst[MAX_BURST * PAIR_ESIZE / 8] = {0};
+
+	if ( __sync_add_and_fetch(&lcore_count, 1) != 2 )
+		while(lcore_count != 2)
+			rte_pause();
+
+	const uint64_t sp_start = rte_rdtsc();
+	for (i = 0; i < iterations; i++)
+		while (rte_ring_sp_enqueue_bulk_elem(re, burst, PAIR_ESIZE,
+				size, NULL) == 0)
+			rte_pause();
+	const uint64_t sp_end = rte_rdtsc();
+
+	const uint64_t mp_start = rte_rdtsc();
+	for (i = 0; i < iterations; i++)
+		while (rte_ring_mp_enqueue_bulk_elem(re, burst, PAIR_ESIZE,
+				size, NULL) == 0)
+			rte_pause();
+	const uint64_t mp_end = rte_rdtsc();
+
+	params->spsc = ((double)(sp_end - sp_start))/(iterations*size);
+	params->mpmc = ((double)(mp_end - mp_start))/(iterations*size);
+	return 0;
+}
+
+static int
+dequeue_bulk_elem(void *p)
+{
+	const unsigned iter_shift = 23;
+	const unsigned iterations = 1<<iter_shift;
+	struct thread_params *params = p;
+	const unsigned size = params->size;
+	struct rte_ring *re = r_elem[PAIR_ESIZE / 8];
+	unsigned i;
+	uint64_t burst[MAX_BURST * PAIR_ESIZE / 8] = {0};
+
+	if ( __sync_add_and_fetch(&lcore_count, 1) != 2 )
+		while(lcore_count != 2)
+			rte_pause();
+
+	const uint64_t sc_start = rte_rdtsc();
+	for (i = 0; i < iterations; i++)
+		while (rte_ring_sc_dequeue_bulk_elem(re, burst, PAIR_ESIZE,
+				size, NULL) == 0)
+			rte_pause();
+	const uint64_t sc_end = rte_rdtsc();
+
+	const uint64_t mc_start = rte_rdtsc();
+	for (i = 0; i < iterations; i++)
+		while (rte_ring_mc_dequeue_bulk_elem(re, burst, PAIR_ESIZE,
+				size, NULL) == 0)
+			rte_pause();
+	const uint64_t mc_end = rte_rdtsc();
+
+	params->spsc = ((double)(sc_end - sc_start))/(iterations*size);
+	params->mpmc = ((double)(mc_end - mc_start))/(iterations*size);
+	return 0;
+}
+
 /*
  * Function that calls the enqueue and dequeue bulk functions on pairs of cores.
  * used to measure ring perf between hyperthreads, cores and sockets.
@@ -389,6 +480,166 @@ test_bulk_enqueue_dequeue(void)
 	}
 }
 
+/*
+ * Times bulk and burst enqueue and dequeue of esize bytes elements on a
+ * single lcore. Always inlined so that esize is a compile time constant,
+ * as it is in real users of the element ring API.
+ */
+static inline __attribute__((always_inline)) void
+test_elem_enqueue_dequeue(unsigned int esize)
+{
+	const unsigned iter_shift = 23;
+	const unsigned iterations = 1<<iter_shift;
+	struct rte_ring *re = r_elem[esize / 8];
+	unsigned sz, i = 0;
+	uint64_t burst[MAX_BURST * MAX_ESIZE / 8] = {0};
+
+	for (sz = 0; sz < sizeof(bulk_sizes)/sizeof(bulk_sizes[0]); sz++) {
+		const uint64_t sc_start = rte_rdtsc();
+		for (i = 0; i < iterations; i++) {
+			rte_ring_sp_enqueue_bulk_elem(re, burst, esize,
+					bulk_sizes[sz], NULL);
+			rte_ring_sc_dequeue_bulk_elem(re, burst, esize,
+					bulk_sizes[sz], NULL);
+		}
+		const uint64_t sc_end = rte_rdtsc();
+
+		const uint64_t mc_start = rte_rdtsc();
+		for (i = 0; i < iterations; i++) {
+			rte_ring_mp_enqueue_bulk_elem(re, burst, esize,
+					bulk_sizes[sz], NULL);
+			rte_ring_mc_dequeue_bulk_elem(re, burst, esize,
+					bulk_sizes[sz], NULL);
+		}
+		const uint64_t mc_end = rte_rdtsc();
+
+		const uint64_t burst_start = rte_rdtsc();
+		for (i = 0; i < iterations; i++) {
+			rte_ring_sp_enqueue_burst_elem(re, burst, esize,
+					bulk_sizes[sz], NULL);
+			rte_ring_sc_dequeue_burst_elem(re, burst, esize,
+					bulk_sizes[sz], NULL);
+		}
+		const uint64_t burst_end = rte_rdtsc();
+
+		double sc_avg = ((double)(sc_end-sc_start) /
+				(iterations * bulk_sizes[sz]));
+		double mc_avg = ((double)(mc_end-mc_start) /
+				(iterations * bulk_sizes[sz]));
+		double burst_avg = ((double)(burst_end-burst_start) /
+				(iterations * bulk_sizes[sz]));
+
+		printf("SP/SC bulk enq/dequeue (size: %u, esize: %u): %.2F\n",
+				bulk_sizes[sz], esize, sc_avg);
+		printf("MP/MC bulk enq/dequeue (size: %u, esize: %u): %.2F\n",
+				bulk_sizes[sz], esize, mc_avg);
+		printf("SP/SC burst enq/dequeue (size: %u, esize: %u): %.2F\n",
+				bulk_sizes[sz], esize, burst_avg);
+	}
+}
+
+/* Create, or look up, the element ring of esize bytes elements */
+static int
+test_elem_ring_create(unsigned int esize)
+{
+	char name[RTE_RING_NAMESIZE];
+
+	snprintf(name, sizeof(name), "%s_%u", RING_ELEM_NAME, esize);
+	r_elem[esize / 8] = rte_ring_create_elem(name, esize, RING_SIZE,
+			rte_socket_id(), 0);
+	if (r_elem[esize / 8] == NULL &&
+			(r_elem[esize / 8] = rte_ring_lookup(name)) == NULL)
+		return -1;
+	return 0;
+}
+
+/* State shared by the lcores of a stress test */
+struct stress_params {
+	struct rte_ring *ring;
+	uint64_t end;                     /**< TSC at which to stop */
+	uint64_t objs[RTE_MAX_LCORE];     /**< objects moved by each lcore */
+};
+
+/*
+ * Dequeue a burst and enqueue it back, until the end of the test. The
+ * objects stay on the ring or in the hands of an lcore, so the enqueue
+ * always finds room once the other lcores make progress.
+ */
+static int
+stress_worker(void *p)
+{
+	struct stress_params *params = p;
+	struct rte_ring *ring = params->ring;
+	const uint64_t end = params->end;
+	void *burst[MAX_BURST];
+	uint64_t objs = 0;
+	unsigned int n;
+
+	while (rte_rdtsc() < end) {
+		n = rte_ring_dequeue_burst(ring, burst, MAX_BURST, NULL);
+		if (n == 0) {
+			rte_pause();
+			continue;
+		}
+		while (rte_ring_enqueue_bulk(ring, burst, n, NULL) == 0)
+			rte_pause();
+		objs += n;
+	}
+
+	params->objs[rte_lcore_id()] = objs;
+	return 0;
+}
+
+/*
+ * Run stress_worker() on all lcores over a ring half filled, created with
+ * the given sync mode flags
+ */
+static int
+test_stress_sync_mode(const char *mode, unsigned int flags)
+{
+	static struct stress_params params;
+	void *burst[MAX_BURST] = {0};
+	uint64_t objs, hz;
+	unsigned int i, lcore_id, nb_lcores;
+	struct rte_ring *ring;
+	char name[RTE_RING_NAMESIZE];
+
+	snprintf(name, sizeof(name), "%s_%x", RING_NAME, flags);
+	ring = rte_ring_create(name, RING_SIZE, rte_socket_id(), flags);
+	if (ring == NULL && (ring = rte_ring_lookup(name)) == NULL)
+		return -1;
+
+	while (rte_ring_dequeue_burst(ring, burst, MAX_BURST, NULL) != 0)
+		;
+	for (i = 0; i < RING_SIZE / 2; i += MAX_BURST)
+		rte_ring_enqueue_bulk(ring, burst, MAX_BURST, NULL);
+
+	memset(&params, 0, sizeof(params));
+	params.ring = ring;
+	hz = rte_get_timer_hz();
+	params.end = rte_rdtsc() + hz * STRESS_DURATION_MS / 1000;
+	rte_eal_mp_remote_launch(stress_worker, &params, CALL_MASTER);
+	rte_eal_mp_wait_lcore();
+
+	if (rte_ring_count(ring) != RING_SIZE / 2) {
+		printf("%s ring lost objects: %u instead of %u\n", mode,
+				rte_ring_count(ring), RING_SIZE / 2);
+		return -1;
+	}
+
+	objs = 0;
+	nb_lcores = 0;
+	RTE_LCORE_FOREACH(lcore_id) {
+		objs += params.objs[lcore_id];
+		nb_lcores++;
+	}
+	printf("%s deq/enq bursts on %u lcores: %"PRIu64" objs/s, %.2F cycles per obj\n",
+			mode, nb_lcores, objs * 1000 / STRESS_DURATION_MS,
+			objs == 0 ? 0 : (double)(hz * STRESS_DURATION_MS /
+				1000) * nb_lcores / objs);
+	return 0;
+}
+
 static int
 test_ring_perf(void)
 {
@@ -419,6 +670,29 @@ test_ring_perf(void)
 		printf("\n### Testing using two NUMA nodes ###\n");
 		run_on_core_pair(&cores, enqueue_bulk, dequeue_bulk);
 	}
+
+	if (test_elem_ring_create(8) < 0 || test_elem_ring_create(16) < 0 ||
+			test_elem_ring_create(32) < 0)
+		return -1;
+
+	printf("\n### Testing element rings using a single lcore ###\n");
+	test_elem_enqueue_dequeue(8);
+	test_elem_enqueue_dequeue(16);
+	test_elem_enqueue_dequeue(32);
+
+	if (get_two_cores(&cores) == 0) {
+		printf("\n### Testing %u bytes element ring using two physical cores ###\n",
+				PAIR_ESIZE);
+		run_on_core_pair(&cores, enqueue_bulk_elem, dequeue_bulk_elem);
+	}
+
+	printf("\n### Testing sync modes using all lcores ###\n");
+	if (test_stress_sync_mode("MP/MC", 0) < 0 ||
+			test_stress_sync_mode("RTS", RING_F_MP_RTS_ENQ |
+				RING_F_MC_RTS_DEQ) < 0 ||
+			test_stress_sync_mode("HTS", RING_F_MP_HTS_ENQ |
+				RING_F_MC_HTS_DEQ) < 0)
+		return -1;
 	return 0;
 }
 